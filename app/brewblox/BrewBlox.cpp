@@ -20,6 +20,7 @@
 #include "./reset.h"
 #include "AppTicks.h"
 #include "Board.h"
+#include "IoArray.h"
 #include "Logger.h"
 #include "OneWireScanningFactory.h"
 #include "blox/ActuatorAnalogMockBlock.h"
@@ -36,6 +37,7 @@
 #include "blox/MutexBlock.h"
 #include "blox/OneWireBusBlock.h"
 #include "blox/PidBlock.h"
+#include "blox/PidCascadeBlock.h"
 #include "blox/SetpointProfileBlock.h"
 #include "blox/SetpointSensorPairBlock.h"
 #include "blox/SysInfoBlock.h"
@@ -83,10 +85,14 @@ void updateFirmwareFromStream(cbox::StreamType)
 #include "DS2408Mock.h"
 #include "DS2413Mock.h"
 #include "OneWireMockDriver.h"
+#include "OneWireMockPopulation.h"
+#include <cstdlib>
+#include <fstream>
 #else
 #include "DS248x.h"
 #endif
 #include "OneWireScanningFactory.h"
+#include "OneWireScheduler.h"
 
 // Include serial connection for platform
 #if defined(SPARK)
@@ -167,15 +173,24 @@ makeBrewBloxBox()
         {ActuatorLogicBlock::staticTypeId(), []() { return std::make_shared<ActuatorLogicBlock>(objects); }},
         {MockPinsBlock::staticTypeId(), []() { return std::make_shared<MockPinsBlock>(); }},
         {TempSensorCombiBlock::staticTypeId(), []() { return std::make_shared<TempSensorCombiBlock>(objects); }},
+        {PidCascadeBlock::staticTypeId(), []() { return std::make_shared<PidCascadeBlock>(objects); }},
     };
 
     static EepromAccessImpl eeprom;
     static cbox::EepromObjectStorage objectStore(eeprom);
     static cbox::ConnectionPool& connections = theConnectionPool();
 
+    // Each additional OneWire bus gets its own system block, added before the box reserves the system ids.
+    // Each bus is scanned for new devices by its own factory.
+    auto& buses = oneWireBuses();
     std::vector<std::unique_ptr<cbox::ScanningFactory>> scanningFactories;
-    scanningFactories.reserve(1);
-    scanningFactories.push_back(std::make_unique<OneWireScanningFactory>(objects, theOneWire()));
+    scanningFactories.reserve(buses.size());
+    for (uint8_t i = 0; i < buses.size(); i++) {
+        if (i > 0) {
+            objects.add(std::make_shared<OneWireBusBlock>(*buses.bus(i)), 0x80, oneWireBusBlockId(i));
+        }
+        scanningFactories.push_back(std::make_unique<OneWireScanningFactory>(objects, *buses.bus(i), i));
+    }
 
     static cbox::Box box(objectFactory, objects, objectStore, connections, std::move(scanningFactories));
 
@@ -189,29 +204,137 @@ brewbloxBox()
     return box;
 }
 
+// microsecond clock to measure the latency of OneWire transactions
+ticks_micros_t
+oneWireMicros()
+{
+    return ticks.micros();
+}
+
 #if !defined(PLATFORM_ID) || PLATFORM_ID == 3
-OneWire&
-theOneWire()
+// load the mock devices of a bus from the file in an environment variable, returns false if none are loaded
+bool
+loadMockBus(OneWireMockDriver& owDriver, const char* variable)
 {
-    static auto owDriver = OneWireMockDriver();
-    static auto ow = OneWire(owDriver);
+    // The bus then also takes as long as the hardware would for each operation.
+    if (auto path = std::getenv(variable)) {
+        std::ifstream population(path);
+        if (loadMockPopulation(owDriver, population)) {
+            owDriver.setClock(oneWireMicros);
+            return true;
+        }
+    }
+    return false;
+}
+
+void
+populateMockBus(OneWireMockDriver& owDriver)
+{
+    // For load tests, a device population can be loaded from a file (see OneWireMockPopulation.h).
+    if (loadMockBus(owDriver, "BREWBLOX_ONEWIRE_POPULATION")) {
+        return;
+    }
     owDriver.attach(std::make_shared<DS18B20Mock>(OneWireAddress(0x7E11'1111'1111'1128))); // DS18B20
     owDriver.attach(std::make_shared<DS18B20Mock>(OneWireAddress(0xDE22'2222'2222'2228))); // DS18B20
     owDriver.attach(std::make_shared<DS18B20Mock>(OneWireAddress(0xBE33'3333'3333'3328))); // DS18B20
     owDriver.attach(std::make_shared<DS2413Mock>(OneWireAddress(0x0644'4444'4444'443A)));  // DS2413
     owDriver.attach(std::make_shared<DS2408Mock>(OneWireAddress(0xDA55'5555'5555'5529)));  // DS2408
+}
+
+OneWire&
+theOneWire()
+{
+    static auto owDriver = OneWireMockDriver();
+    static auto ow = OneWire(owDriver, oneWireMicros);
+    static bool populated = false;
+    if (!populated) {
+        populated = true; // attach the mock devices only once
+        populateMockBus(owDriver);
+    }
     return ow;
 }
+
+void
+addOneWireBridges(OneWireScheduler& buses)
+{
+    // A second mock bus is added when a population is loaded for it, to simulate a system with multiple bridges
+    static auto owDriver = OneWireMockDriver();
+    if (loadMockBus(owDriver, "BREWBLOX_ONEWIRE_POPULATION_1")) {
+        static auto ow = OneWire(owDriver, oneWireMicros);
+        buses.add(ow);
+    }
+}
 #else
 OneWire&
 theOneWire()
 {
     static auto owDriver = DS248x(0x00);
-    static auto ow = OneWire(owDriver);
+    static auto ow = OneWire(owDriver, oneWireMicros);
     return ow;
 }
+
+void
+addOneWireBridges(OneWireScheduler& buses)
+{
+    // Additional DS2482 bridges can be connected with their address pins set to 1-3.
+    // Only the bridges that respond at startup are added, after the bridge of the first bus.
+    static DS248x drivers[] = {DS248x(0x01), DS248x(0x02), DS248x(0x03)};
+    static std::unique_ptr<OneWire> bridges[3];
+    for (uint8_t i = 0; i < 3; i++) {
+        if (drivers[i].init()) {
+            bridges[i] = std::make_unique<OneWire>(drivers[i], oneWireMicros);
+            buses.add(*bridges[i]);
+        }
+    }
+}
 #endif
 
+OneWireScheduler&
+oneWireBuses()
+{
+    static OneWireScheduler buses;
+    static bool initialized = false;
+    if (!initialized) {
+        initialized = true;
+        buses.add(theOneWire());
+        addOneWireBridges(buses);
+    }
+    return buses;
+}
+
+OneWire&
+theOneWire(uint8_t index)
+{
+    auto bus = oneWireBuses().bus(index);
+    return bus ? *bus : theOneWire();
+}
+
+void
+processOneWireTransactions()
+{
+    // Blocks submit transactions during the update, they are started right after it.
+    // The buses are processed every loop while transactions are pending, so their blocks don't need to poll.
+    oneWireBuses().process();
+}
+
+// The block of the first bus keeps id 4, the blocks of the additional buses follow the pins block
+cbox::obj_id_t
+oneWireBusBlockId(uint8_t bus)
+{
+    return bus == 0 ? 4 : 19 + bus;
+}
+
+uint8_t
+oneWireBusIndex(cbox::obj_id_t id)
+{
+    for (uint8_t i = 1; i < oneWireBuses().size(); i++) {
+        if (oneWireBusBlockId(i) == id) {
+            return i;
+        }
+    }
+    return 0;
+}
+
 Logger&
 logger()
 {
@@ -261,7 +384,12 @@ logEvent(const std::string& event)
 void
 updateBrewbloxBox()
 {
-    brewbloxBox().update(ticks.millis());
+    {
+        // channel changes of all blocks in this update are written to each OneWire IO device at once when the batch closes
+        IoArray::Batch batch;
+        brewbloxBox().update(ticks.millis());
+    }
+    processOneWireTransactions();
 #if PLATFORM_ID == 3
     ticks.delayMillis(10); // prevent 100% cpu usage
 #endif
@@ -395,11 +523,89 @@ connectionStarted(DataOut& out)
     out.write('>');
 }
 
+// the constrained digital actuator of a block, nullptr when the block doesn't have one
+ActuatorDigitalConstrained*
+findDigitalActuator(const obj_id_t& id)
+{
+    if (auto obj = brewbloxBox().getObject(id).lock()) {
+        return reinterpret_cast<ActuatorDigitalConstrained*>(obj->implements(interfaceId<ActuatorDigitalConstrained>()));
+    }
+    return nullptr;
+}
+
+// Set the size in bytes of the state history of a digital actuator, 0 disables it.
+// Request: object id, size (uint16). Response: status.
+// Sizes above ActuatorDigitalChangeLogged::maxStateHistorySize are rejected. The size is persisted with the block,
+// the history itself is kept in RAM and starts empty after a reboot.
+void
+configureStateHistory(cbox::DataIn& in, cbox::EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    obj_id_t id = 0;
+    uint16_t bytes = 0;
+    ActuatorDigitalConstrained* act = nullptr;
+    if (!in.get(id) || !in.get(bytes)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR;
+    } else if (!(act = findDigitalActuator(id))) {
+        status = CboxError::INVALID_OBJECT_ID;
+    }
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
+    if (status == CboxError::OK && act->stateHistorySize() != bytes) {
+        if (act->stateHistorySize(bytes)) {
+            status = brewbloxBox().storeUpdatedObject(id);
+        } else {
+            status = CboxError::OBJECT_DATA_NOT_ACCEPTED;
+        }
+    }
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+}
+
+// Read the state history of a digital actuator in one response.
+// Request: object id. Response: status, total activations (uint32), total active ms (uint64), followed by the
+// history as written by StateHistory::streamTo, which is empty when the history is disabled.
+void
+readStateHistory(cbox::DataIn& in, cbox::EncodedDataOut& out)
+{
+    CboxError status = CboxError::OK;
+    obj_id_t id = 0;
+    ActuatorDigitalConstrained* act = nullptr;
+    if (!in.get(id)) {
+        status = CboxError::INPUT_STREAM_READ_ERROR;
+    } else if (!(act = findDigitalActuator(id))) {
+        status = CboxError::INVALID_OBJECT_ID;
+    }
+    in.spool();
+    if (out.crc()) {
+        status = CboxError::CRC_ERROR_IN_COMMAND;
+    }
+    out.writeResponseSeparator();
+    out.write(asUint8(status));
+    if (status == CboxError::OK) {
+        if (auto history = act->stateHistory()) {
+            auto now = ticks.millis();
+            auto totals = history->totals(now);
+            out.put(totals.activations);
+            out.put(totals.activeMillis);
+            history->streamTo([&out](uint8_t b) { return out.write(b); }, now);
+        }
+    }
+}
+
 // handler for custom commands outside of controlbox
 bool
 applicationCommand(uint8_t cmdId, cbox::DataIn& in, cbox::EncodedDataOut& out)
 {
     switch (cmdId) {
+    case 101: // configure state history of a digital actuator
+        configureStateHistory(in, out);
+        return true;
+    case 102: // read state history of a digital actuator, empty after a reboot
+        readStateHistory(in, out);
+        return true;
     case 100: // firmware update
     {
         CboxError status = CboxError::OK;
@@ -26,6 +26,7 @@ namespace cbox {
 class StringStreamConnectionSource;
 }
 class OneWire;
+class OneWireScheduler;
 
 #if !defined(SPARK)
 cbox::StringStreamConnectionSource&
@@ -40,6 +41,26 @@ brewbloxBox();
 OneWire&
 theOneWire();
 
+// all OneWire buses of the system, the bus of theOneWire() is the first
+OneWireScheduler&
+oneWireBuses();
+
+// the OneWire bus with the given index, the first bus if it doesn't exist
+OneWire&
+theOneWire(uint8_t bus);
+
+// advance the queued transactions of all OneWire buses without waiting, called after each update of the box
+void
+processOneWireTransactions();
+
+// the id of the system OneWireBus block of the bus with the given index
+cbox::obj_id_t
+oneWireBusBlockId(uint8_t bus);
+
+// the index of the bus of a OneWireBus block id, the first bus for any other id
+uint8_t
+oneWireBusIndex(cbox::obj_id_t id);
+
 void
 updateBrewbloxBox();
 
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "BrewBlox.h"
 #include "OneWire.h"
 #include "OneWireAddress.h"
 #include "OneWireDevice.h"
@@ -28,30 +29,88 @@
 #include "cbox/Object.h"
 #include "cbox/ObjectContainer.h"
 #include "cbox/ScanningFactory.h"
+#include <iterator>
 #include <memory>
+#include <unordered_map>
 
 /**
- * Simple mock factory that emulates object discovery
- * Normally, a scanning factory will scan some type of communication bus
- * This factory just has a list of candidates. If a LongIntObject with that value doesn't exist, it creates it.
+ * Discovers OneWire devices on the bus and creates a block for each supported device that doesn't exist yet.
+ * Existing devices are looked up in an index of address to object id, which is built when a new scan starts.
+ * Objects can be created, changed or deleted by commands while a scan runs in the background.
+ * The box reports these changes to objectChanged(), which updates the index for that object only.
  */
 class OneWireScanningFactory : public cbox::ScanningFactory {
 private:
     OneWire& bus;
+    uint8_t busIndex; // assigned to the blocks of the devices found on this bus
+    std::unordered_map<uint64_t, cbox::obj_id_t> knownAddresses;
+
+    // A block is moved to the bus its device is found on, for example when a device is connected to another bridge.
+    // The new bus is stored, so the block is loaded with it after a reboot.
+    void assignBus(const cbox::obj_id_t& id)
+    {
+        if (auto obj = objectsRef.fetch(id).lock()) {
+            bool changed = false;
+            if (auto sensor = reinterpret_cast<TempSensorOneWireBlock*>(obj->implements(TempSensorOneWireBlock::staticTypeId()))) {
+                changed = sensor->bus(busIndex);
+            } else if (auto ds2413 = reinterpret_cast<DS2413Block*>(obj->implements(DS2413Block::staticTypeId()))) {
+                changed = ds2413->bus(busIndex);
+            } else if (auto ds2408 = reinterpret_cast<DS2408Block*>(obj->implements(DS2408Block::staticTypeId()))) {
+                changed = ds2408->bus(busIndex);
+            }
+            if (changed) {
+                objectsRef.linksChanged(); // a sensor is linked to the block of its bus
+                brewbloxBox().storeUpdatedObject(id);
+            }
+        }
+    }
+
+    void rebuildIndex()
+    {
+        knownAddresses.clear();
+        for (auto existing = objectsRef.cbegin(); existing != objectsRef.cend(); ++existing) {
+            OneWireDevice* ptrIfCorrectType = reinterpret_cast<OneWireDevice*>(existing->object()->implements(cbox::interfaceId<OneWireDevice>()));
+            if (ptrIfCorrectType != nullptr) {
+                knownAddresses[uint64_t(ptrIfCorrectType->address())] = existing->id();
+            }
+        }
+    }
+
+protected:
+    // restart the bus search
+    virtual void resetSearch()
+    {
+        bus.reset_search();
+    }
 
 public:
-    OneWireScanningFactory(cbox::ObjectContainer& objects, OneWire& ow)
+    OneWireScanningFactory(cbox::ObjectContainer& objects, OneWire& ow, uint8_t busIndex_ = 0)
         : cbox::ScanningFactory(objects)
         , bus(ow)
+        , busIndex(busIndex_)
     {
-        reset();
+        bus.reset_search();
     }
 
     virtual ~OneWireScanningFactory() = default;
 
-    virtual void reset() override
+    virtual void reset() override final
     {
-        bus.reset_search();
+        resetSearch();
+        rebuildIndex();
+    }
+
+    virtual void objectChanged(const cbox::obj_id_t& id, cbox::Object* obj) override final
+    {
+        // the address of the object could have changed, so its previous entry is removed first
+        for (auto it = knownAddresses.begin(); it != knownAddresses.end();) {
+            it = it->second == id ? knownAddresses.erase(it) : std::next(it);
+        }
+        if (obj != nullptr) {
+            if (auto device = reinterpret_cast<OneWireDevice*>(obj->implements(cbox::interfaceId<OneWireDevice>()))) {
+                knownAddresses[uint64_t(device->address())] = id;
+            }
+        }
     }
 
     virtual OneWireAddress next()
@@ -63,48 +122,53 @@ public:
         return 0;
     }
 
-    virtual std::shared_ptr<cbox::Object> scan() override final
+    // the id of the object for a device address, 0 if it doesn't exist
+    cbox::obj_id_t find(OneWireAddress address) const
     {
-        while (true) {
-            if (auto newAddr = next()) {
-                bool found = false;
-                for (auto existing = objectsRef.cbegin(); existing != objectsRef.cend(); ++existing) {
-                    OneWireDevice* ptrIfCorrectType = reinterpret_cast<OneWireDevice*>(existing->object()->implements(cbox::interfaceId<OneWireDevice>()));
-                    if (ptrIfCorrectType == nullptr) {
-                        continue; // not the right type, no match
-                    }
-                    if (ptrIfCorrectType->address() == newAddr) {
-                        found = true; // object with value already exists
-                        break;
-                    }
-                }
-                if (!found) {
-                    // create new object
-                    uint8_t familyCode = newAddr[0];
-                    switch (familyCode) {
-                    case DS18B20::familyCode: {
-                        auto newSensor = std::make_shared<TempSensorOneWireBlock>();
-                        newSensor->get().address(newAddr);
-                        return newSensor;
-                    }
-                    case DS2413::familyCode: {
-                        auto newDevice = std::make_shared<DS2413Block>();
-                        newDevice->get().address(newAddr);
-                        return newDevice;
-                    }
-                    case DS2408::familyCode: {
-                        auto newDevice = std::make_shared<DS2408Block>();
-                        newDevice->get().address(newAddr);
-                        return newDevice;
-                    }
-                    default:
-                        break;
-                    }
-                }
-            } else {
-                break;
-            }
-        };
+        auto it = knownAddresses.find(uint64_t(address));
+        return it != knownAddresses.end() ? it->second : cbox::obj_id_t(0);
+    }
+
+    virtual std::shared_ptr<cbox::Object> scanNext(bool& done) override final
+    {
+        auto newAddr = next();
+        done = !newAddr;
+        if (done) {
+            return nullptr; // scan complete
+        }
+
+        uint8_t familyCode = newAddr[0];
+        if (familyCode != DS18B20::familyCode && familyCode != DS2413::familyCode && familyCode != DS2408::familyCode) {
+            return nullptr; // unsupported device
+        }
+        if (auto existing = find(newAddr)) {
+            assignBus(existing);
+            return nullptr; // object already exists
+        }
+
+        // create new object
+        switch (familyCode) {
+        case DS18B20::familyCode: {
+            auto newSensor = std::make_shared<TempSensorOneWireBlock>();
+            newSensor->bus(busIndex);
+            newSensor->get().address(newAddr);
+            return newSensor;
+        }
+        case DS2413::familyCode: {
+            auto newDevice = std::make_shared<DS2413Block>();
+            newDevice->bus(busIndex);
+            newDevice->get().address(newAddr);
+            return newDevice;
+        }
+        case DS2408::familyCode: {
+            auto newDevice = std::make_shared<DS2408Block>();
+            newDevice->bus(busIndex);
+            newDevice->get().address(newAddr);
+            return newDevice;
+        }
+        default:
+            break;
+        }
         return nullptr;
     }
 };
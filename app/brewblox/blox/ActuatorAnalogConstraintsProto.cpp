@@ -19,9 +19,9 @@ private:
     Balanced_t m_balanced;
 
 public:
-    CboxBalanced(cbox::ObjectContainer& objects, const cbox::obj_id_t& objId)
+    CboxBalanced(cbox::ObjectContainer& objects, const cbox::obj_id_t& objId, uint8_t weight, uint8_t priority, std::function<void()>&& apply)
         : lookup(cbox::CboxPtr<Balancer_t>(objects, objId))
-        , m_balanced(lookup.lockFunctor())
+        , m_balanced(lookup.lockFunctor(), weight, priority, std::move(apply))
     {
     }
 
@@ -50,6 +50,16 @@ public:
         return m_balanced.granted();
     }
 
+    uint8_t weight() const
+    {
+        return m_balanced.weight();
+    }
+
+    uint8_t priority() const
+    {
+        return m_balanced.priority();
+    }
+
     virtual uint8_t order() const override final
     {
         return m_balanced.order();
@@ -72,9 +82,13 @@ setAnalogConstraints(const blox_AnalogConstraints& msg, ActuatorAnalogConstraine
             act.addConstraint(std::make_unique<Maximum>(
                 cnl::wrap<ActuatorAnalog::value_t>(constraintDfn.constraint.max)));
             break;
-        case blox_AnalogConstraint_balanced_tag:
-            act.addConstraint(std::make_unique<CboxBalanced>(objects, constraintDfn.constraint.balanced.balancerId));
-            break;
+        case blox_AnalogConstraint_balanced_tag: {
+            auto& balanced = constraintDfn.constraint.balanced;
+            // the weight is 0 when it is not set, a request without weight would never be granted
+            uint8_t weight = balanced.weight ? balanced.weight : 1;
+            // the balancer sets the actuator again when it has calculated the grants, the constraint is owned by the actuator
+            act.addConstraint(std::make_unique<CboxBalanced>(objects, balanced.balancerId, weight, balanced.priority, [&act]() { act.update(); }));
+        } break;
         }
     }
 }
@@ -106,6 +120,8 @@ getAnalogConstraints(blox_AnalogConstraints& msg, const ActuatorAnalogConstraine
             msg.constraints[i].constraint.balanced.id = obj->requesterId();
             msg.constraints[i].constraint.balanced.balancerId = obj->balancerId();
             msg.constraints[i].constraint.balanced.granted = cnl::unwrap(obj->granted());
+            msg.constraints[i].constraint.balanced.weight = obj->weight();
+            msg.constraints[i].constraint.balanced.priority = obj->priority();
         } break;
         }
         msg.constraints[i].limiting = act.limiting() & (uint8_t(1) << i);
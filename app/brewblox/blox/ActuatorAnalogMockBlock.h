@@ -30,6 +30,7 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
+        notifyChanged(); // only updated after its setting is written
         return update_never(now);
     }
 
@@ -26,7 +26,8 @@ DigitalCompare::write(blox_DigitalCompare& dest, bool includeNotPersisted) const
     dest.op = m_op;
     dest.rhs = blox_DigitalState(m_rhs);
     if (includeNotPersisted) {
-        dest.result = m_result;
+        // the expression only evaluates the comparisons it needs, so all results are evaluated for display
+        dest.result = eval();
     }
 }
 
@@ -68,7 +69,8 @@ AnalogCompare::write(blox_AnalogCompare& dest, bool includeNotPersisted) const
     dest.op = m_op;
     dest.rhs = cnl::unwrap(m_rhs);
     if (includeNotPersisted) {
-        dest.result = m_result;
+        // the expression only evaluates the comparisons it needs, so all results are evaluated for display
+        dest.result = eval();
     }
 }
 
@@ -89,8 +91,11 @@ ActuatorLogicBlock::streamFrom(cbox::DataIn& dataIn)
         for (pb_size_t i = 0; i < newData.analog_count; i++) {
             analogs.emplace_back(newData.analog[i], objectsRef);
         }
+        objectsRef.linksChanged();
 
         expression = std::string(newData.expression);
+        compile();
+        m_applyPending = true;
     }
     return result;
 }
@@ -141,7 +146,24 @@ ActuatorLogicBlock::streamPersistedTo(cbox::DataOut& out) const
 cbox::update_t
 ActuatorLogicBlock::update(const cbox::update_t& now)
 {
+    // The safety update applies the result when the target was changed by something else,
+    // and catches input changes that were not notified, like a digital actuator toggled by another block.
+    const cbox::update_t safetyInterval = 1000;
+
+    bool safetyUpdate = now - m_lastApplied >= safetyInterval;
+    if (!m_inputsChanged && !m_applyPending && !safetyUpdate) {
+        return m_lastApplied + safetyInterval;
+    }
+    m_inputsChanged = false;
+
+    auto previousResult = m_result;
     m_result = evaluate();
+    if (m_result == previousResult && !m_applyPending && !safetyUpdate) {
+        return m_lastApplied + safetyInterval; // no edge, leave the constraints of the target alone
+    }
+    m_applyPending = false;
+    m_lastApplied = now;
+
     if (enabled) {
         if (auto targetPtr = target.lock()) {
             if (m_result == blox_Compare_Result_RESULT_TRUE) {
@@ -149,9 +171,10 @@ ActuatorLogicBlock::update(const cbox::update_t& now)
             } else {
                 targetPtr->desiredState(ActuatorDigitalBase::State::Inactive);
             }
+            notifyChanged(); // update the target right away
         }
     }
-    return now + 100; // update every 100ms
+    return now + safetyInterval;
 }
 
 void*
@@ -166,108 +189,154 @@ ActuatorLogicBlock::implements(const cbox::obj_type_t& iface)
 blox_Compare_Result
 ActuatorLogicBlock::evaluate()
 {
-    for (auto& d : digitals) {
-        d.update();
+    m_errorPos = 0;
+    if (m_compileResult != blox_Compare_Result_RESULT_TRUE) {
+        m_errorPos = m_compileErrorPos;
+        return m_compileResult; // empty or invalid expression
     }
 
-    for (auto& a : analogs) {
-        a.update();
+    // Results are kept on a bit stack, with the top in the lowest bit.
+    // The expression has at most 64 characters, so there are never more than 32 values on the stack.
+    uint64_t stack = 0;
+    uint8_t pc = 0;
+    while (pc < code.size()) {
+        const auto& instruction = code[pc];
+        switch (instruction.op) {
+        case Instruction::Op::DIGITAL:
+        case Instruction::Op::ANALOG: {
+            auto result = instruction.op == Instruction::Op::DIGITAL
+                              ? digitals[instruction.arg].eval()
+                              : analogs[instruction.arg].eval();
+            if (result > blox_Compare_Result_RESULT_TRUE) {
+                m_errorPos = instruction.pos;
+                return result;
+            }
+            stack = (stack << 1) | (result == blox_Compare_Result_RESULT_TRUE);
+        } break;
+        case Instruction::Op::NOT:
+            stack ^= 1;
+            break;
+        case Instruction::Op::XOR:
+            stack = (stack >> 1) ^ (stack & 1);
+            break;
+        case Instruction::Op::JUMP_IF_TRUE:
+            if (stack & 1) {
+                pc += instruction.arg;
+                continue;
+            }
+            stack >>= 1;
+            break;
+        case Instruction::Op::JUMP_IF_FALSE:
+            if (!(stack & 1)) {
+                pc += instruction.arg;
+                continue;
+            }
+            stack >>= 1;
+            break;
+        }
+        ++pc;
     }
-    m_errorPos = 0;
+    return (stack & 1) ? blox_Compare_Result_RESULT_TRUE : blox_Compare_Result_RESULT_FALSE;
+}
+
+void
+ActuatorLogicBlock::compile()
+{
+    code.clear();
+    m_compileErrorPos = 0;
     if (expression.empty()) {
-        return blox_Compare_Result_RESULT_EMPTY;
+        m_compileResult = blox_Compare_Result_RESULT_EMPTY;
+        return;
     }
     auto it = expression.cbegin();
-    auto result = eval(it, 0);
-
-    if (result > blox_Compare_Result_RESULT_TRUE) {
-        m_errorPos = it - expression.cbegin() - 1;
+    auto result = compile(it, 0);
+    if (result == blox_Compare_Result_RESULT_TRUE) {
+        m_compileResult = result;
+        return;
     }
-    return result;
+    code.clear();
+    m_compileResult = result; // empty substring or a syntax error
+    m_compileErrorPos = it - expression.cbegin() - 1;
 }
 
+/**
+ * Compiles the expression from it up to the closing bracket of the level or the end.
+ * Operators have equal precedence and are right associative: the right hand side is the rest of the level.
+ * Returns RESULT_TRUE when code for a value was added, RESULT_EMPTY_SUBSTRING when the part is empty, or the error.
+ */
 blox_Compare_Result
-ActuatorLogicBlock::eval(std::string::const_iterator& it, uint8_t level) const
+ActuatorLogicBlock::compile(std::string::const_iterator& it, uint8_t level)
 {
+    const auto start = code.size();
     blox_Compare_Result res = blox_Compare_Result_RESULT_EMPTY_SUBSTRING;
     while (it < expression.cend()) {
         if (res > blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-            return res;
+            return res; // error in a group, a missing close bracket at the end takes precedence
         }
         auto c = *it;
+        auto pos = uint8_t(it - expression.cbegin());
         ++it;
         if ('a' <= c && c <= 'z') {
             if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
             }
-            auto compare = digitals.cbegin() + (c - 'a');
-            if (compare >= digitals.cend()) {
+            if (size_t(c - 'a') >= digitals.size()) {
                 return blox_Compare_Result_RESULT_UNDEFINED_DIGITAL_COMPARE;
             }
-            res = compare->result();
+            code.push_back({Instruction::Op::DIGITAL, uint8_t(c - 'a'), pos});
+            res = blox_Compare_Result_RESULT_TRUE;
         } else if ('A' <= c && c <= 'Z') {
             if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_COMPARISON;
             }
-            auto compare = analogs.cbegin() + (c - 'A');
-            if (compare >= analogs.cend()) {
+            if (size_t(c - 'A') >= analogs.size()) {
                 return blox_Compare_Result_RESULT_UNDEFINED_ANALOG_COMPARE;
             }
-            res = compare->result();
+            code.push_back({Instruction::Op::ANALOG, uint8_t(c - 'A'), pos});
+            res = blox_Compare_Result_RESULT_TRUE;
         } else if (c == '!') {
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
+            // the inverted rest of the level is the result, a value before it is not used
+            code.erase(code.begin() + start, code.end());
+            auto rhs = compile(it, level);
+            if (rhs != blox_Compare_Result_RESULT_TRUE) {
                 return rhs; // error
             }
-            if (rhs == blox_Compare_Result_RESULT_TRUE) {
-                return blox_Compare_Result_RESULT_FALSE;
-            }
-            return blox_Compare_Result_RESULT_TRUE;
-        } else if (c == '|') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
-            }
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
-                return rhs; // error
-            }
-            if (res == blox_Compare_Result_RESULT_TRUE) {
-                return res;
-            }
+            code.push_back({Instruction::Op::NOT, 0, pos});
             return rhs;
-        } else if (c == '&') {
+        } else if (c == '|' || c == '&') {
             if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
             }
-            auto rhs = eval(it, level);
-            if (rhs > blox_Compare_Result_RESULT_TRUE) {
+            auto jump = code.size();
+            code.push_back({c == '|' ? Instruction::Op::JUMP_IF_TRUE : Instruction::Op::JUMP_IF_FALSE, 0, pos});
+            auto rhs = compile(it, level);
+            if (rhs != blox_Compare_Result_RESULT_TRUE) {
                 return rhs; // error
             }
-            if (res == blox_Compare_Result_RESULT_TRUE) {
-                return rhs;
-            }
-            return res;
+            code[jump].arg = uint8_t(code.size() - jump);
+            return rhs;
         } else if (c == '^') {
             if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_OPERATOR;
             }
-            auto rhs = eval(it, level);
-            if (rhs != blox_Compare_Result_RESULT_TRUE && rhs != blox_Compare_Result_RESULT_FALSE) {
+            auto rhs = compile(it, level);
+            if (rhs != blox_Compare_Result_RESULT_TRUE) {
                 return rhs; // error
             }
-            if (rhs != res) {
-                return blox_Compare_Result_RESULT_TRUE;
-            }
-            return blox_Compare_Result_RESULT_FALSE;
+            code.push_back({Instruction::Op::XOR, 0, pos});
+            return rhs;
         } else if (c == '(') {
-            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
-                res = eval(it, level + 1);
-            } else {
+            if (res != blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
                 return blox_Compare_Result_RESULT_UNEXPECTED_OPEN_BRACKET;
             }
+            auto group = code.size();
+            res = compile(it, level + 1);
+            if (res == blox_Compare_Result_RESULT_EMPTY_SUBSTRING) {
+                // an empty part within the brackets makes the group empty, its code is not used
+                code.erase(code.begin() + group, code.end());
+            }
         } else if (c == ')') {
             if (level == 0) {
-                // first check is to not overwrite earlier error
                 return blox_Compare_Result_RESULT_UNEXPECTED_CLOSE_BRACKET;
             }
             return res;
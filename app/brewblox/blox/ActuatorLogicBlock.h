@@ -18,7 +18,6 @@ public:
     DigitalCompare(const blox_DigitalCompare& data, cbox::ObjectContainer& objects)
         : m_lookup(objects, cbox::obj_id_t(data.id))
         , m_op(data.op)
-        , m_result(blox_Compare_Result_RESULT_FALSE)
         , m_rhs(ActuatorDigitalBase::State(data.rhs))
     {
     }
@@ -28,20 +27,14 @@ public:
     blox_Compare_Result eval() const;
     void write(blox_DigitalCompare& dest, bool includeNotPersisted) const;
 
-    void update()
+    cbox::obj_id_t id() const
     {
-        m_result = eval();
-    }
-
-    auto result() const
-    {
-        return m_result;
+        return m_lookup.getId();
     }
 
 private:
     cbox::CboxPtr<ActuatorDigitalConstrained> m_lookup;
     blox_Compare_DigitalOperator m_op;
-    blox_Compare_Result m_result;
     ActuatorDigitalBase::State m_rhs;
 };
 
@@ -50,7 +43,6 @@ public:
     AnalogCompare(const blox_AnalogCompare& data, cbox::ObjectContainer& objects)
         : m_lookup(objects, cbox::obj_id_t(data.id))
         , m_op(data.op)
-        , m_result(blox_Compare_Result_RESULT_FALSE)
         , m_rhs(cnl::wrap<fp12_t>(data.rhs))
     {
     }
@@ -60,20 +52,14 @@ public:
     blox_Compare_Result eval() const;
     void write(blox_AnalogCompare& dest, bool includeNotPersisted) const;
 
-    void update()
+    cbox::obj_id_t id() const
     {
-        m_result = eval();
-    }
-
-    auto result() const
-    {
-        return m_result;
+        return m_lookup.getId();
     }
 
 private:
     cbox::CboxPtr<ProcessValue<fp12_t>> m_lookup;
     blox_Compare_AnalogOperator m_op;
-    blox_Compare_Result m_result;
     fp12_t m_rhs;
 };
 
@@ -88,6 +74,32 @@ private:
     blox_Compare_Result m_result = blox_Compare_Result_RESULT_FALSE;
     uint8_t m_errorPos = 0;
 
+    // The expression is compiled to postfix code when it is written.
+    // Binary operators jump over their right hand side when the left hand side decides the result,
+    // so only the comparisons that are needed are evaluated.
+    struct Instruction {
+        enum class Op : uint8_t {
+            DIGITAL,      // push the result of digital comparison arg
+            ANALOG,       // push the result of analog comparison arg
+            NOT,          // invert the top of the stack
+            XOR,          // replace the top 2 values with their exclusive or
+            JUMP_IF_TRUE, // jump forward by arg if the top is true, otherwise pop it
+            JUMP_IF_FALSE // jump forward by arg if the top is false, otherwise pop it
+        };
+        Op op;
+        uint8_t arg;
+        uint8_t pos; // position in the expression, for errors of comparisons
+    };
+    std::vector<Instruction> code;
+    blox_Compare_Result m_compileResult = blox_Compare_Result_RESULT_EMPTY;
+    uint8_t m_compileErrorPos = 0;
+
+    // The expression is evaluated when one of the compared blocks notifies a change.
+    // The target is only driven when the result changes, or on a slow safety update.
+    bool m_inputsChanged = false;
+    bool m_applyPending = true; // apply the result on the next update, after a change of the settings
+    cbox::update_t m_lastApplied = 0;
+
 public:
     ActuatorLogicBlock(cbox::ObjectContainer& objects)
         : objectsRef(objects)
@@ -106,9 +118,26 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        for (auto& d : digitals) {
+            visit(d.id(), cbox::LinkType::INPUT);
+        }
+        for (auto& a : analogs) {
+            visit(a.id(), cbox::LinkType::INPUT);
+        }
+        visit(target.getId(), cbox::LinkType::OUTPUT);
+    }
+
+    virtual void inputChanged() override final
+    {
+        m_inputsChanged = true;
+    }
+
     blox_Compare_Result evaluate();
 
 private:
-    blox_Compare_Result eval(std::string::const_iterator& it, uint8_t level) const;
+    void compile();
+    blox_Compare_Result compile(std::string::const_iterator& it, uint8_t level);
     void writeMessage(blox_ActuatorLogic& message, bool includeNotPersisted) const;
 };
@@ -74,6 +74,7 @@ ActuatorOffsetBlock::update(const cbox::update_t& now)
 {
     offset.update();
     constrained.update();
+    notifyChanged();
     return now + 1000;
 }
 
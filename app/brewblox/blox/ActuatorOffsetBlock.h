@@ -33,6 +33,12 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(reference.getId(), cbox::LinkType::INPUT);
+        visit(target.getId(), cbox::LinkType::OUTPUT);
+    }
+
     ActuatorOffset& get()
     {
         return offset;
@@ -68,6 +68,19 @@ ActuatorPwmBlock::update(const cbox::update_t& now)
 {
     constrained.update();
     auto nextUpdate = pwm.update(now);
+
+    // Notify when the setting changes or the output toggles, not on every small change of the achieved value.
+    // This also updates the target right away, which passes its new state on to blocks that compare it.
+    auto targetState = ActuatorDigitalBase::State::Unknown;
+    if (auto ptr = actuator.const_lock()) {
+        targetState = ptr->state();
+    }
+    if (pwm.setting() != m_notifiedSetting || targetState != m_notifiedTargetState) {
+        m_notifiedSetting = pwm.setting();
+        m_notifiedTargetState = targetState;
+        notifyChanged();
+    }
+
     auto settingValid = pwm.settingValid();
     if (previousSettingValid != settingValid) {
         // When the pwm changes whether it has a valid setting
@@ -79,6 +92,7 @@ ActuatorPwmBlock::update(const cbox::update_t& now)
             brewbloxBox().storeUpdatedObject(actuator.getId());
         }
         previousSettingValid = settingValid;
+        notifyChanged();
 
         return now;
     }
@@ -16,6 +16,8 @@ private:
     ActuatorAnalogConstrained constrained;
 
     bool previousSettingValid = false;
+    ActuatorPwm::value_t m_notifiedSetting = 0;
+    ActuatorDigitalBase::State m_notifiedTargetState = ActuatorDigitalBase::State::Unknown;
 
 public:
     ActuatorPwmBlock(cbox::ObjectContainer& objects)
@@ -37,6 +39,11 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(actuator.getId(), cbox::LinkType::OUTPUT);
+    }
+
     const cbox::CboxPtr<ActuatorDigitalConstrained>& targetLookup() const
     {
         return actuator;
@@ -13,6 +13,8 @@ streamBalancedActuators(pb_ostream_t* stream, const pb_field_t* field, void* con
         act.id = requester.id;
         act.requested = cnl::unwrap(requester.requested);
         act.granted = cnl::unwrap(requester.granted);
+        act.weight = requester.weight;
+        act.priority = requester.priority;
         if (!pb_encode_tag_for_field(stream, field)) {
             return false;
         }
@@ -23,16 +25,49 @@ streamBalancedActuators(pb_ostream_t* stream, const pb_field_t* field, void* con
     return true;
 }
 
+cbox::CboxError
+BalancerBlock::streamFrom(cbox::DataIn& in)
+{
+    blox_Balancer message = blox_Balancer_init_zero;
+    cbox::CboxError res = streamProtoFrom(in, &message, blox_Balancer_fields, std::numeric_limits<size_t>::max());
+    if (res == cbox::CboxError::OK) {
+        switch (message.policy) {
+        case blox_BalancerPolicy_BALANCER_PROPORTIONAL:
+            balancer.policy(Balancer_t::Policy::PROPORTIONAL);
+            break;
+        case blox_BalancerPolicy_BALANCER_WEIGHTED:
+            balancer.policy(Balancer_t::Policy::WEIGHTED);
+            break;
+        case blox_BalancerPolicy_BALANCER_PRIORITY:
+            balancer.policy(Balancer_t::Policy::PRIORITY);
+            break;
+        default:
+            return cbox::CboxError::OBJECT_DATA_NOT_ACCEPTED;
+        }
+    }
+    return res;
+}
+
 cbox::CboxError
 BalancerBlock::streamTo(cbox::DataOut& out) const
 {
     blox_Balancer message = blox_Balancer_init_zero;
+    message.policy = blox_BalancerPolicy(balancer.policy());
     message.clients.funcs.encode = streamBalancedActuators;
     message.clients.arg = const_cast<Balancer_t*>(&balancer); // arg is not const in message, but it is in callback
 
     return streamProtoTo(out, &message, blox_Balancer_fields, std::numeric_limits<size_t>::max());
 }
 
+cbox::CboxError
+BalancerBlock::streamPersistedTo(cbox::DataOut& out) const
+{
+    blox_Balancer message = blox_Balancer_init_zero;
+    message.policy = blox_BalancerPolicy(balancer.policy());
+
+    return streamProtoTo(out, &message, blox_Balancer_fields, std::numeric_limits<size_t>::max());
+}
+
 void*
 BalancerBlock::implements(const cbox::obj_type_t& iface)
 {
@@ -16,25 +16,20 @@ public:
     BalancerBlock() = default;
     virtual ~BalancerBlock() = default;
 
+    // the policy is the only setting, actuators register themselves with their weight and priority
     virtual cbox::CboxError
-    streamFrom(cbox::DataIn&) override final
-    {
-        return cbox::CboxError::OK; // no settings to write (actuators register themselves)
-    }
+    streamFrom(cbox::DataIn& in) override final;
 
     virtual cbox::CboxError
     streamTo(cbox::DataOut& out) const override final;
 
     virtual cbox::CboxError
-    streamPersistedTo(cbox::DataOut&) const override final
-    {
-        return cbox::CboxError::OK; // no settings to persist
-    }
+    streamPersistedTo(cbox::DataOut& out) const override final;
 
     virtual cbox::update_t
     update(const cbox::update_t& now) override final
     {
-        balancer.update();
+        balancer.update(); // also sets the balanced actuators to their new grants
         return now + 1000;
     }
 
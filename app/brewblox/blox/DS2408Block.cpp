@@ -28,6 +28,7 @@ DS2408Block::streamFrom(cbox::DataIn& in)
     /* if no errors occur, write new settings to wrapped object */
     if (res == cbox::CboxError::OK) {
         device.address(OneWireAddress(newData.address));
+        bus(oneWireBusIndex(newData.oneWireBusId));
         connectMode = newData.connectMode;
     }
     return res;
@@ -39,6 +40,7 @@ DS2408Block::streamTo(cbox::DataOut& out) const
     blox_DS2408 message = blox_DS2408_init_zero;
 
     message.address = device.address();
+    message.oneWireBusId = oneWireBusBlockId(busIndex);
     message.connected = device.connected();
     message.connectMode = connectMode;
 
@@ -69,6 +71,7 @@ DS2408Block::streamPersistedTo(cbox::DataOut& out) const
     blox_DS2408 message = blox_DS2408_init_zero;
 
     message.address = device.address();
+    message.oneWireBusId = oneWireBusBlockId(busIndex);
     message.connectMode = connectMode;
     return streamProtoTo(out, &message, blox_DS2408_fields, blox_DS2408_size);
 }
@@ -76,7 +79,7 @@ DS2408Block::streamPersistedTo(cbox::DataOut& out) const
 cbox::update_t
 DS2408Block::update(const cbox::update_t& now)
 {
-    device.update();
+    device.poll(now);
     return update_1s(now);
 }
 
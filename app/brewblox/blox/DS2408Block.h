@@ -26,10 +26,20 @@
 OneWire&
 theOneWire();
 
+OneWire&
+theOneWire(uint8_t bus);
+
+cbox::obj_id_t
+oneWireBusBlockId(uint8_t bus);
+
+uint8_t
+oneWireBusIndex(cbox::obj_id_t id);
+
 class DS2408Block : public Block<BrewBloxTypes_BlockType_DS2408> {
 private:
     DS2408 device;
     blox_DS2408_PinConnectMode connectMode = blox_DS2408_PinConnectMode_CONNECT_VALVE;
+    uint8_t busIndex = 0;
 
 public:
     DS2408Block()
@@ -47,4 +57,14 @@ public:
     {
         return device;
     }
+
+    // Select the bus of the device by index. The index is kept when the bus does not exist, the first bus is used then.
+    // The bus is persisted as the id of its OneWireBus block. Returns true if the bus changed.
+    bool bus(uint8_t index)
+    {
+        bool changed = index != busIndex;
+        busIndex = index;
+        device.bus(theOneWire(index));
+        return changed;
+    }
 };
@@ -29,6 +29,7 @@ DS2413Block::streamFrom(cbox::DataIn& in)
     /* if no errors occur, write new settings to wrapped object */
     if (res == cbox::CboxError::OK) {
         device.address(OneWireAddress(newData.address));
+        bus(oneWireBusIndex(newData.oneWireBusId));
     }
     return res;
 }
@@ -39,6 +40,7 @@ DS2413Block::streamTo(cbox::DataOut& out) const
     blox_DS2413 message = blox_DS2413_init_zero;
 
     message.address = device.address();
+    message.oneWireBusId = oneWireBusBlockId(busIndex);
     message.connected = device.connected();
 
     message.pins_count = 2;
@@ -56,6 +58,7 @@ DS2413Block::streamPersistedTo(cbox::DataOut& out) const
     blox_DS2413 message = blox_DS2413_init_zero;
 
     message.address = device.address();
+    message.oneWireBusId = oneWireBusBlockId(busIndex);
     return streamProtoTo(out, &message, blox_DS2413_fields, blox_DS2413_size);
 }
 
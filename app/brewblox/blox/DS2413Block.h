@@ -25,9 +25,19 @@
 OneWire&
 theOneWire();
 
+OneWire&
+theOneWire(uint8_t bus);
+
+cbox::obj_id_t
+oneWireBusBlockId(uint8_t bus);
+
+uint8_t
+oneWireBusIndex(cbox::obj_id_t id);
+
 class DS2413Block : public Block<BrewBloxTypes_BlockType_DS2413> {
 private:
     DS2413 device;
+    uint8_t busIndex = 0;
 
 public:
     DS2413Block()
@@ -45,4 +55,14 @@ public:
     {
         return device;
     }
+
+    // Select the bus of the device by index. The index is kept when the bus does not exist, the first bus is used then.
+    // The bus is persisted as the id of its OneWireBus block. Returns true if the bus changed.
+    bool bus(uint8_t index)
+    {
+        bool changed = index != busIndex;
+        busIndex = index;
+        device.bus(theOneWire(index));
+        return changed;
+    }
 };
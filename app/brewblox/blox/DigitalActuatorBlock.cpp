@@ -18,6 +18,9 @@ DigitalActuatorBlock::streamFrom(cbox::DataIn& dataIn)
     cbox::CboxError result = streamProtoFrom(dataIn, &message, blox_DigitalActuator_fields, blox_DigitalActuator_size);
 
     if (result == cbox::CboxError::OK) {
+        if (message.stateHistorySize > ActuatorDigitalConstrained::maxStateHistorySize) {
+            return cbox::CboxError::OBJECT_DATA_NOT_ACCEPTED;
+        }
         if (hwDevice.getId() != message.hwDevice) {
             actuator.channel(0); // unregister at old hwDevice
             hwDevice.setId(message.hwDevice);
@@ -25,6 +28,7 @@ DigitalActuatorBlock::streamFrom(cbox::DataIn& dataIn)
         actuator.channel(message.channel);
         actuator.invert(message.invert);
         setDigitalConstraints(message.constrainedBy, constrained, objectsRef);
+        constrained.stateHistorySize(message.stateHistorySize);
         constrained.desiredState(ActuatorDigitalBase::State(message.desiredState));
     }
 
@@ -38,6 +42,7 @@ DigitalActuatorBlock::writePersistedStateToMessage(blox_DigitalActuator& message
     message.channel = actuator.channel();
     message.invert = actuator.invert();
     message.desiredState = blox_DigitalState(constrained.desiredState());
+    message.stateHistorySize = constrained.stateHistorySize();
 
     getDigitalConstraints(message.constrainedBy, constrained);
 }
@@ -72,7 +77,14 @@ cbox::update_t
 DigitalActuatorBlock::update(const cbox::update_t& now)
 {
     actuator.update();
-    return constrained.update(now);
+    auto nextUpdate = constrained.update(now);
+    if (constrained.state() != m_notifiedState || constrained.desiredState() != m_notifiedDesired) {
+        // let blocks that compare the state re-evaluate right away
+        m_notifiedState = constrained.state();
+        m_notifiedDesired = constrained.desiredState();
+        notifyChanged();
+    }
+    return nextUpdate;
 }
 
 void*
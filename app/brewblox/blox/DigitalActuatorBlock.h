@@ -14,6 +14,8 @@ private:
     cbox::CboxPtr<IoArray> hwDevice;
     ActuatorDigital actuator;
     ActuatorDigitalConstrained constrained;
+    ActuatorDigitalBase::State m_notifiedState = ActuatorDigitalBase::State::Unknown;
+    ActuatorDigitalBase::State m_notifiedDesired = ActuatorDigitalBase::State::Unknown;
 
 public:
     DigitalActuatorBlock(cbox::ObjectContainer& objects);
@@ -29,6 +31,11 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(hwDevice.getId(), cbox::LinkType::OUTPUT);
+    }
+
     ActuatorDigitalConstrained& getConstrained()
     {
         return constrained;
@@ -28,13 +28,24 @@ MotorValveBlock::streamFrom(cbox::DataIn& dataIn)
     cbox::CboxError result = streamProtoFrom(dataIn, &message, blox_MotorValve_fields, blox_MotorValve_size);
 
     if (result == cbox::CboxError::OK) {
+        if (message.stateHistorySize > ActuatorDigitalConstrained::maxStateHistorySize) {
+            return cbox::CboxError::OBJECT_DATA_NOT_ACCEPTED;
+        }
         if (hwDevice.getId() != message.hwDevice) {
             valve.startChannel(0); // unregister at old hwDevice
             hwDevice.setId(message.hwDevice);
         }
         valve.startChannel(message.startChannel);
+        valve.travelTime(message.travelTime);
         setDigitalConstraints(message.constrainedBy, constrained, objectsRef);
-        constrained.desiredState(ActuatorDigitalBase::State(message.desiredState));
+        constrained.stateHistorySize(message.stateHistorySize);
+        if (message.targetPosition > 0 && message.targetPosition < 100) {
+            m_targetPosition = message.targetPosition;
+            valve.position(m_targetPosition);
+        } else {
+            m_targetPosition = 0;
+            constrained.desiredState(ActuatorDigitalBase::State(message.desiredState));
+        }
     }
 
     return result;
@@ -45,6 +56,9 @@ MotorValveBlock::writePersistedStateToMessage(blox_MotorValve& message) const
     message.desiredState = blox_DigitalState(constrained.desiredState());
     message.hwDevice = hwDevice.getId();
     message.startChannel = valve.startChannel();
+    message.travelTime = valve.travelTimeSetting();
+    message.targetPosition = m_targetPosition;
+    message.stateHistorySize = constrained.stateHistorySize();
     getDigitalConstraints(message.constrainedBy, constrained);
 }
 
@@ -68,6 +82,8 @@ MotorValveBlock::streamTo(cbox::DataOut& out) const
     } else {
         message.valveState = blox_MotorValve_ValveState(valve.valveState());
     }
+    message.position = valve.position();
+    message.measuredTravelTime = valve.measuredTravelTime();
 
     stripped.copyToMessage(message.strippedFields, message.strippedFields_count, 1);
     return streamProtoTo(out, &message, blox_MotorValve_fields, blox_MotorValve_size);
@@ -85,8 +101,18 @@ MotorValveBlock::streamPersistedTo(cbox::DataOut& out) const
 cbox::update_t
 MotorValveBlock::update(const cbox::update_t& now)
 {
-    valve.update();
-    return constrained.update(now);
+    auto nextValveUpdate = valve.update(now);
+    if (m_targetPosition) {
+        return nextValveUpdate; // the constrained actuator would drive the valve to an end position
+    }
+    auto nextUpdate = std::min(constrained.update(now), nextValveUpdate);
+    if (constrained.state() != m_notifiedState || constrained.desiredState() != m_notifiedDesired) {
+        // let blocks that compare the state re-evaluate right away
+        m_notifiedState = constrained.state();
+        m_notifiedDesired = constrained.desiredState();
+        notifyChanged();
+    }
+    return nextUpdate;
 }
 
 void*
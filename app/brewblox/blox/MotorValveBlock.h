@@ -32,6 +32,11 @@ private:
     cbox::CboxPtr<DS2408> hwDevice;
     MotorValve valve;
     ActuatorDigitalConstrained constrained;
+    ActuatorDigitalBase::State m_notifiedState = ActuatorDigitalBase::State::Unknown;
+    ActuatorDigitalBase::State m_notifiedDesired = ActuatorDigitalBase::State::Unknown;
+    // An intermediate position from 1 to 99 percent open, 0 when the valve follows the desired state.
+    // The digital constraints don't apply to an intermediate position.
+    uint8_t m_targetPosition = 0;
 
 public:
     MotorValveBlock(cbox::ObjectContainer& objects)
@@ -53,6 +58,11 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(hwDevice.getId(), cbox::LinkType::OUTPUT);
+    }
+
     ActuatorDigitalConstrained& getConstrained()
     {
         return constrained;
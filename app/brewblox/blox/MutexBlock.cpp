@@ -38,6 +38,17 @@ MutexBlock::streamTo(cbox::DataOut& out) const
     blox_Mutex message = blox_Mutex_init_zero;
     message.differentActuatorWait = m_mutex.holdAfterTurnOff();
     message.waitRemaining = m_mutex.timeRemaining();
+    message.waitingCount = m_mutex.waitingCount();
+    message.longestWait = m_mutex.longestWait();
+
+    return streamProtoTo(out, &message, blox_Mutex_fields, blox_Mutex_size);
+}
+
+cbox::CboxError
+MutexBlock::streamPersistedTo(cbox::DataOut& out) const
+{
+    blox_Mutex message = blox_Mutex_init_zero;
+    message.differentActuatorWait = m_mutex.holdAfterTurnOff();
 
     return streamProtoTo(out, &message, blox_Mutex_fields, blox_Mutex_size);
 }
@@ -19,8 +19,8 @@
 
 #pragma once
 
-#include "ActuatorDigitalConstrained.h"
 #include "Block.h"
+#include "MutexTarget.h"
 
 class MutexBlock : public Block<BrewBloxTypes_BlockType_Mutex> {
 private:
@@ -32,15 +32,13 @@ public:
 
     virtual cbox::CboxError streamFrom(cbox::DataIn& dataIn) override final;
     virtual cbox::CboxError streamTo(cbox::DataOut& out) const override final;
-
-    virtual cbox::CboxError streamPersistedTo(cbox::DataOut& out) const override final
-    {
-        return streamTo(out);
-    }
+    virtual cbox::CboxError streamPersistedTo(cbox::DataOut& out) const override final;
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
-        return update_never(now);
+        // refresh the reported wait times and drop actuators that stopped asking
+        m_mutex.update(now);
+        return now + 1000;
     }
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
@@ -44,23 +44,23 @@ streamAdresses(pb_ostream_t* stream, const pb_field_t* field, void* const* arg)
     return true;
 }
 
-OneWireBusBlock::OneWireBusBlock(OneWire& ow)
-    : bus(ow)
+OneWireBusBlock::OneWireBusBlock(OneWire& bus_)
+    : bus(bus_)
     , command({NO_OP, 0})
 {
     bus.init();
 }
 
 /**
-     * Read value
-     * - an ID encoded as a variable length ID chain (values > 0x80 mean there is more data)
-     * - previous command data count - N
-     * - previous command data - N bytes
-     * - command rsult (variable length)
-     * - cmd 00: no-op always 00 (success)
-     * - cmd 01: reset bus (00 on success, FF on failure)
-     * - cmd 02: search bus: a sequence of 0 or more 8-byte addresses, MSB first that were found on the bus
-     */
+ * Read value
+ * - an ID encoded as a variable length ID chain (values > 0x80 mean there is more data)
+ * - previous command data count - N
+ * - previous command data - N bytes
+ * - command rsult (variable length)
+ * - cmd 00: no-op always 00 (success)
+ * - cmd 01: reset bus (00 on success, FF on failure)
+ * - cmd 02: search bus: a sequence of 0 or more 8-byte addresses, MSB first that were found on the bus
+ */
 cbox::CboxError
 OneWireBusBlock::streamTo(cbox::DataOut& out) const
 {
@@ -68,6 +68,7 @@ OneWireBusBlock::streamTo(cbox::DataOut& out) const
     message.command = command;
     message.address.funcs.encode = nullptr;
     message.address.arg = &bus;
+    getOneWireStats(message.stats, bus.stats(), errors.lastError());
     switch (command.opcode) {
     case NO_OP:
         break;
@@ -89,15 +90,15 @@ OneWireBusBlock::streamTo(cbox::DataOut& out) const
 }
 
 /**
-     * Set the command to be executed next form the input stream
-     * - byte 0: command
-     *   00: no-op
-     *   01: reset bus
-     *   02: search bus:
-     *   03: search the bus, limiting to the given family code byte passed as data
-     *   (later: search bus alarm state?)
-     *   (later: set bus power? (off if next byte is 00, on if it's 01) )
-     */
+ * Set the command to be executed next form the input stream
+ * - byte 0: command
+ *   00: no-op
+ *   01: reset bus
+ *   02: search bus:
+ *   03: search the bus, limiting to the given family code byte passed as data
+ *   (later: search bus alarm state?)
+ *   (later: set bus power? (off if next byte is 00, on if it's 01) )
+ */
 cbox::CboxError
 OneWireBusBlock::streamFrom(cbox::DataIn& dataIn)
 {
@@ -110,3 +111,48 @@ OneWireBusBlock::streamFrom(cbox::DataIn& dataIn)
     }
     return res;
 }
+
+/**
+ * Drives the temperature conversion cycle of the bus.
+ * Sensors request a conversion when they read their value. The requests are combined into one skip ROM broadcast.
+ * When the conversion time has passed, the bus block notifies the sensors linked to it, so they read their new value.
+ * If sensors in alarm mode requested an alarm search, it is queued first and the sensors are notified when it completes.
+ * The queued transactions are processed by the main loop after each update of the box, see updateBrewbloxBox().
+ */
+cbox::update_t
+OneWireBusBlock::update(const cbox::update_t& now)
+{
+    errors.update(bus.stats(), now);
+
+    const cbox::update_t overflowGuard = std::numeric_limits<cbox::update_t>::max() / 2;
+    if (overflowGuard - now + nextStep <= overflowGuard) {
+        if (searching) {
+            if (bus.alarmSearchPending()) {
+                return now; // check every loop, the main loop processes the search transactions
+            }
+            searching = false;
+            notifyChanged();
+            nextStep = nextConversion;
+        } else if (converting) {
+            converting = false;
+            // sensors in alarm mode only read their value when the alarm search found them
+            searching = bus.startRequestedAlarmSearch();
+            if (searching) {
+                nextStep = now;
+            } else {
+                notifyChanged();
+                nextStep = nextConversion;
+            }
+        } else {
+            nextConversion = now + conversionInterval;
+            if (bus.startRequestedConversions()) {
+                converting = true;
+                nextStep = now + conversionTime;
+            } else {
+                nextStep = nextConversion;
+            }
+        }
+    }
+
+    return nextStep;
+}
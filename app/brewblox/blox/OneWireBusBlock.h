@@ -19,11 +19,15 @@
 
 #pragma once
 
+#include "OneWire.h"
+#include "OneWireStatsProto.h"
 #include "blox/Block.h"
 #include "proto/cpp/OneWireBus.pb.h"
 
-class OneWire;
-
+/**
+ * System block for a OneWire bus. Each bus has its own block, see oneWireBusBlockId().
+ * It drives the temperature conversions of its bus and commands apply to its bus.
+ */
 class OneWireBusBlock : public Block<BrewBloxTypes_BlockType_OneWireBus> {
 private:
     OneWire& bus;
@@ -34,11 +38,23 @@ private:
     static const uint8_t RESET = 1;
     static const uint8_t SEARCH = 2; // pass family as data, 00 for all
 
+    // temperature conversion of all sensors on the bus, started with a single broadcast
+    static const cbox::update_t conversionTime = 750;
+    static const cbox::update_t conversionInterval = 1000;
+    bool converting = false;
+    bool searching = false; // the alarm search is queued after the conversion
+    cbox::update_t nextStep = 0;
+    cbox::update_t nextConversion = 0;
+    OneWireErrorTracker errors;
+
 public:
-    OneWireBusBlock(OneWire& ow);
+    OneWireBusBlock(OneWire& bus_);
     virtual ~OneWireBusBlock() = default;
 
-    OneWire& oneWire() { return bus; }
+    OneWire& oneWire() const
+    {
+        return bus;
+    }
 
     virtual cbox::CboxError streamTo(cbox::DataOut& out) const override final;
     virtual cbox::CboxError streamFrom(cbox::DataIn& dataIn) override final;
@@ -48,9 +64,5 @@ public:
         return cbox::CboxError::PERSISTING_NOT_NEEDED;
     }
 
-    virtual cbox::update_t update(const cbox::update_t& now) override final
-    {
-        // No updates for now. Alternatively, a periodic bus scan for new devices?
-        return update_never(now);
-    }
+    virtual cbox::update_t update(const cbox::update_t& now) override final;
 };
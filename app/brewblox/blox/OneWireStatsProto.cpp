@@ -0,0 +1,34 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireStatsProto.h"
+
+void
+getOneWireStats(blox_OneWireStats& msg, const OneWireStats& stats, const ticks_millis_t& lastErrorTime)
+{
+    msg.resets = stats.resets;
+    msg.presenceErrors = stats.presenceErrors;
+    msg.crcErrors = stats.crcErrors;
+    msg.retries = stats.retries;
+    msg.resetDetections = stats.resetDetections;
+    msg.latencyP50 = stats.latency.percentile(50);
+    msg.latencyP90 = stats.latency.percentile(90);
+    msg.latencyMax = stats.latency.max();
+    msg.lastErrorTime = lastErrorTime;
+}
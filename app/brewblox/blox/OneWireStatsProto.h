@@ -0,0 +1,51 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireStats.h"
+#include "TicksTypes.h"
+#include "proto/cpp/OneWireStats.pb.h"
+
+void
+getOneWireStats(blox_OneWireStats& msg, const OneWireStats& stats, const ticks_millis_t& lastErrorTime);
+
+/*
+ * Remembers when the error count of a bus or device last increased
+ */
+class OneWireErrorTracker {
+private:
+    uint32_t lastErrors = 0;
+    ticks_millis_t lastErrorTime = 0;
+
+public:
+    void update(const OneWireStats& stats, const ticks_millis_t& now)
+    {
+        auto errors = stats.errors();
+        if (errors != lastErrors) {
+            lastErrors = errors;
+            lastErrorTime = now;
+        }
+    }
+
+    ticks_millis_t lastError() const
+    {
+        return lastErrorTime;
+    }
+};
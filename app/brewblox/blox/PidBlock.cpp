@@ -51,7 +51,7 @@ PidBlock::streamFrom(cbox::DataIn& in)
         }
         pid.boilPointAdjust(cnl::wrap<Pid::in_t>(newData.boilPointAdjust));
         pid.boilMinOutput(cnl::wrap<Pid::out_t>(newData.boilMinOutput));
-        pid.update(); // force an update that bypasses the update interval
+        pid.update(0); // force an update that bypasses the update interval, without integrating
     }
     return res;
 }
@@ -141,10 +141,11 @@ cbox::update_t
 PidBlock::update(const cbox::update_t& now)
 {
     bool doUpdate = false;
-    auto nextUpdate = m_intervalHelper.update(now, doUpdate);
+    auto nextUpdate = m_interval.update(now, doUpdate);
 
     if (doUpdate) {
-        pid.update();
+        pid.update(m_interval.elapsed());
+        notifyChanged(); // let the output process the new setting right away
         auto pidActive = pid.active();
         if (previousActive != pidActive) {
             // When the pid changes whether it is active
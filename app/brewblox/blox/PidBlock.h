@@ -20,8 +20,8 @@
 #pragma once
 
 #include "ActuatorAnalogConstrained.h"
-#include "IntervalHelper.h"
 #include "Pid.h"
+#include "TriggeredInterval.h"
 #include "blox/Block.h"
 #include "cbox/CboxPtr.h"
 
@@ -31,7 +31,7 @@ private:
     cbox::CboxPtr<ActuatorAnalogConstrained> output;
 
     Pid pid;
-    IntervalHelper<1000> m_intervalHelper;
+    TriggeredInterval<900, 1500> m_interval; // updates when the input has a new value, or after 1.5s without input
     bool previousActive = false;
 
 public:
@@ -49,6 +49,19 @@ public:
     virtual void*
     implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void
+    forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(input.getId(), cbox::LinkType::INPUT);
+        visit(output.getId(), cbox::LinkType::OUTPUT);
+    }
+
+    virtual void
+    inputChanged() override final
+    {
+        m_interval.trigger();
+    }
+
     Pid&
     get()
     {
@@ -0,0 +1,233 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PidCascadeBlock.h"
+#include "BrewBlox.h"
+#include "ProcessValue.h"
+#include "blox/FieldTags.h"
+#include "proto/cpp/PidCascade.pb.h"
+
+namespace {
+
+void
+setLoopSettings(Pid& pid, const blox_PidCascade_Loop& loop)
+{
+    pid.kp(cnl::wrap<Pid::in_t>(loop.kp));
+    pid.ti(loop.ti);
+    pid.td(loop.td);
+    if (loop.integralReset != 0) {
+        pid.setIntegral(cnl::wrap<Pid::out_t>(loop.integralReset));
+    }
+}
+
+void
+getLoopSettings(blox_PidCascade_Loop& loop, const Pid& pid)
+{
+    loop.kp = cnl::unwrap(pid.kp());
+    loop.ti = pid.ti();
+    loop.td = pid.td();
+}
+
+void
+getLoopState(blox_PidCascade_Loop& loop, const Pid& pid)
+{
+    getLoopSettings(loop, pid);
+    loop.active = pid.active();
+    loop.p = cnl::unwrap(pid.p());
+    loop.i = cnl::unwrap(pid.i());
+    loop.d = cnl::unwrap(pid.d());
+    loop.error = cnl::unwrap(pid.error());
+    loop.integral = cnl::unwrap(pid.integral());
+    loop.derivative = cnl::unwrap(pid.derivative());
+}
+
+} // end namespace
+
+PidCascadeBlock::PidCascadeBlock(cbox::ObjectContainer& objects)
+    : outerInput(objects)
+    , innerInput(objects)
+    , output(objects)
+    , feedForwardInput(objects)
+    , cascade(
+          outerInput.lockFunctor(),
+          innerInput.lockFunctor(),
+          [this]() {
+              // convert ActuatorConstrained to base ProcessValue
+              return std::shared_ptr<ProcessValue<PidCascade::out_t>>(this->output.lock());
+          },
+          [this]() {
+              return std::shared_ptr<ProcessValue<temp_t>>(this->feedForwardInput.lock());
+          })
+{
+}
+
+cbox::CboxError
+PidCascadeBlock::streamFrom(cbox::DataIn& in)
+{
+    blox_PidCascade newData = blox_PidCascade_init_zero;
+    cbox::CboxError res = streamProtoFrom(in, &newData, blox_PidCascade_fields, blox_PidCascade_size);
+    /* if no errors occur, write new settings to wrapped object */
+    if (res == cbox::CboxError::OK) {
+        outerInput.setId(newData.outerInputId);
+        innerInput.setId(newData.innerInputId);
+        output.setId(newData.outputId);
+        feedForwardInput.setId(newData.feedForwardInputId);
+        cascade.enabled(newData.enabled);
+        cascade.feedForwardGain(cnl::wrap<PidCascade::in_t>(newData.feedForwardGain));
+        if (newData.has_outer) {
+            setLoopSettings(cascade.outer(), newData.outer);
+        }
+        if (newData.has_inner) {
+            setLoopSettings(cascade.inner(), newData.inner);
+        }
+        cascade.update(0); // force an update that bypasses the update interval, without integrating
+    }
+    return res;
+}
+
+cbox::CboxError
+PidCascadeBlock::streamTo(cbox::DataOut& out) const
+{
+    FieldTags stripped;
+    blox_PidCascade message = blox_PidCascade_init_zero;
+    message.outerInputId = outerInput.getId();
+    message.innerInputId = innerInput.getId();
+    message.outputId = output.getId();
+    message.feedForwardInputId = feedForwardInput.getId();
+
+    if (auto ptr = outerInput.const_lock()) {
+        if (ptr->valueValid()) {
+            message.outerInputValue = cnl::unwrap(ptr->value());
+        } else {
+            stripped.add(blox_PidCascade_outerInputValue_tag);
+        }
+        if (ptr->settingValid()) {
+            message.outerInputSetting = cnl::unwrap(ptr->setting());
+        } else {
+            stripped.add(blox_PidCascade_outerInputSetting_tag);
+        }
+    } else {
+        stripped.add(blox_PidCascade_outerInputSetting_tag);
+        stripped.add(blox_PidCascade_outerInputValue_tag);
+    }
+
+    if (auto ptr = innerInput.const_lock()) {
+        if (ptr->valueValid()) {
+            message.innerInputValue = cnl::unwrap(ptr->value());
+        } else {
+            stripped.add(blox_PidCascade_innerInputValue_tag);
+        }
+        if (ptr->settingValid()) {
+            message.innerInputSetting = cnl::unwrap(ptr->setting());
+        } else {
+            stripped.add(blox_PidCascade_innerInputSetting_tag);
+        }
+    } else {
+        stripped.add(blox_PidCascade_innerInputSetting_tag);
+        stripped.add(blox_PidCascade_innerInputValue_tag);
+    }
+
+    if (auto ptr = output.const_lock()) {
+        if (ptr->valueValid()) {
+            message.outputValue = cnl::unwrap(ptr->value());
+        } else {
+            stripped.add(blox_PidCascade_outputValue_tag);
+        }
+        if (ptr->settingValid()) {
+            message.outputSetting = cnl::unwrap(ptr->setting());
+        } else {
+            stripped.add(blox_PidCascade_outputSetting_tag);
+        }
+    } else {
+        stripped.add(blox_PidCascade_outputSetting_tag);
+        stripped.add(blox_PidCascade_outputValue_tag);
+    }
+
+    if (cascade.outer().active()) {
+        message.drivenInnerInputId = message.innerInputId;
+    }
+    if (cascade.inner().active()) {
+        message.drivenOutputId = message.outputId;
+    }
+
+    message.enabled = cascade.enabled();
+    message.active = cascade.active();
+    message.feedForwardGain = cnl::unwrap(cascade.feedForwardGain());
+    message.feedForward = cnl::unwrap(cascade.feedForward());
+    message.innerOffset = cnl::unwrap(cascade.innerOffset());
+    message.has_outer = true;
+    getLoopState(message.outer, cascade.outer());
+    message.has_inner = true;
+    getLoopState(message.inner, cascade.inner());
+
+    stripped.copyToMessage(message.strippedFields, message.strippedFields_count, 6);
+
+    return streamProtoTo(out, &message, blox_PidCascade_fields, blox_PidCascade_size);
+}
+
+cbox::CboxError
+PidCascadeBlock::streamPersistedTo(cbox::DataOut& out) const
+{
+    blox_PidCascade message = blox_PidCascade_init_zero;
+    message.outerInputId = outerInput.getId();
+    message.innerInputId = innerInput.getId();
+    message.outputId = output.getId();
+    message.feedForwardInputId = feedForwardInput.getId();
+    message.enabled = cascade.enabled();
+    message.feedForwardGain = cnl::unwrap(cascade.feedForwardGain());
+    message.has_outer = true;
+    getLoopSettings(message.outer, cascade.outer());
+    message.has_inner = true;
+    getLoopSettings(message.inner, cascade.inner());
+
+    return streamProtoTo(out, &message, blox_PidCascade_fields, blox_PidCascade_size);
+}
+
+cbox::update_t
+PidCascadeBlock::update(const cbox::update_t& now)
+{
+    bool doUpdate = false;
+    auto nextUpdate = m_interval.update(now, doUpdate);
+
+    if (doUpdate) {
+        cascade.update(m_interval.elapsed());
+        notifyChanged(); // let the output process the new setting right away
+        auto cascadeActive = cascade.active();
+        if (previousActive != cascadeActive) {
+            // Like the Pid block, ensure that the output setting in EEPROM is zero when the cascade changes
+            // whether it is active, to prevent loading an active output setting on reboot
+            if (auto ptr = output.lock()) {
+                ptr->setting(0);
+                brewbloxBox().storeUpdatedObject(output.getId());
+                previousActive = cascadeActive;
+            }
+            return now;
+        }
+    }
+    return nextUpdate;
+}
+
+void*
+PidCascadeBlock::implements(const cbox::obj_type_t& iface)
+{
+    if (iface == BrewBloxTypes_BlockType_PidCascade) {
+        return this; // me!
+    }
+    return nullptr;
+}
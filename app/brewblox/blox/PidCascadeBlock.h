@@ -0,0 +1,81 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewBlox is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewBlox is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ActuatorAnalogConstrained.h"
+#include "PidCascade.h"
+#include "TriggeredInterval.h"
+#include "blox/Block.h"
+#include "cbox/CboxPtr.h"
+
+// Replaces a chain of PID -> ActuatorOffset -> SetpointSensorPair -> PID with a single block that updates both loops
+class PidCascadeBlock : public Block<BrewBloxTypes_BlockType_PidCascade> {
+private:
+    cbox::CboxPtr<SetpointSensorPair> outerInput;
+    cbox::CboxPtr<SetpointSensorPair> innerInput;
+    cbox::CboxPtr<ActuatorAnalogConstrained> output;
+    cbox::CboxPtr<SetpointSensorPair> feedForwardInput;
+
+    PidCascade cascade;
+    TriggeredInterval<900, 1500> m_interval; // updates when an input has a new value, or after 1.5s without input
+    bool previousActive = false;
+
+public:
+    PidCascadeBlock(cbox::ObjectContainer& objects);
+    virtual ~PidCascadeBlock() = default;
+
+    virtual cbox::CboxError streamFrom(cbox::DataIn& in) override final;
+    virtual cbox::CboxError streamTo(cbox::DataOut& out) const override final;
+
+    virtual cbox::CboxError
+    streamPersistedTo(cbox::DataOut& out) const override final;
+
+    virtual cbox::update_t
+    update(const cbox::update_t& now) override final;
+    virtual void*
+    implements(const cbox::obj_type_t& iface) override final;
+
+    virtual void
+    forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(outerInput.getId(), cbox::LinkType::INPUT);
+        visit(feedForwardInput.getId(), cbox::LinkType::INPUT);
+        visit(innerInput.getId(), cbox::LinkType::OUTPUT);
+        visit(output.getId(), cbox::LinkType::OUTPUT);
+    }
+
+    virtual void
+    inputChanged() override final
+    {
+        m_interval.trigger();
+    }
+
+    PidCascade&
+    get()
+    {
+        return cascade;
+    }
+
+    const PidCascade&
+    get() const
+    {
+        return cascade;
+    }
+};
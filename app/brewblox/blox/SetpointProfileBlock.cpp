@@ -26,7 +26,7 @@
 bool
 streamPointsOut(pb_ostream_t* stream, const pb_field_t* field, void* const* arg)
 {
-    const std::vector<SetpointProfileBlock::Point>* points = reinterpret_cast<std::vector<SetpointProfileBlock::Point>*>(*arg);
+    const SetpointProfile::Points* points = reinterpret_cast<SetpointProfile::Points*>(*arg);
     for (const auto& p : *points) {
         auto submsg = blox_Point();
         submsg.time = p.time;
@@ -45,7 +45,7 @@ streamPointsOut(pb_ostream_t* stream, const pb_field_t* field, void* const* arg)
 bool
 streamPointsIn(pb_istream_t* stream, const pb_field_t*, void** arg)
 {
-    std::vector<SetpointProfileBlock::Point>* newPoints = reinterpret_cast<std::vector<SetpointProfileBlock::Point>*>(*arg);
+    SetpointProfile::Points* newPoints = reinterpret_cast<SetpointProfile::Points*>(*arg);
 
     if (stream->bytes_left) {
         blox_Point submsg = blox_Point_init_zero;
@@ -61,12 +61,28 @@ cbox::CboxError
 SetpointProfileBlock::streamFrom(cbox::DataIn& in)
 {
     blox_SetpointProfile newData = blox_SetpointProfile_init_zero;
-    std::vector<Point> newPoints;
+    SetpointProfile::Points newPoints;
     newData.points.funcs.decode = &streamPointsIn;
     newData.points.arg = &newPoints;
     cbox::CboxError result = streamProtoFrom(in, &newData, blox_SetpointProfile_fields, std::numeric_limits<size_t>::max() - 1);
     if (result == cbox::CboxError::OK) {
-        profile.points(std::move(newPoints));
+        // large profiles can be uploaded in chunks, to keep messages small
+        switch (newData.chunkOp) {
+        case blox_ProfileChunkOp_PROFILE_CHUNK_APPEND:
+            profile.appendPoints(newPoints);
+            break;
+        case blox_ProfileChunkOp_PROFILE_CHUNK_REPLACE:
+            if (!profile.replacePoints(newData.chunkStart, newPoints)) {
+                return cbox::CboxError::OBJECT_DATA_NOT_ACCEPTED;
+            }
+            break;
+        case blox_ProfileChunkOp_PROFILE_CHUNK_TRUNCATE:
+            profile.truncatePoints(newData.chunkStart);
+            break;
+        default:
+            profile.points(std::move(newPoints));
+            break;
+        }
         profile.enabled(newData.enabled);
         profile.startTime(newData.start);
         target.setId(newData.targetId);
@@ -80,7 +96,7 @@ SetpointProfileBlock::streamTo(cbox::DataOut& out) const
     blox_SetpointProfile message = blox_SetpointProfile_init_zero;
     FieldTags stripped;
     message.points.funcs.encode = &streamPointsOut;
-    message.points.arg = const_cast<std::vector<Point>*>(&profile.points());
+    message.points.arg = const_cast<SetpointProfile::Points*>(&profile.points());
     message.enabled = profile.enabled();
     message.start = profile.startTime();
     message.targetId = target.getId();
@@ -56,6 +56,11 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(target.getId(), cbox::LinkType::OUTPUT);
+    }
+
     SetpointProfile& get()
     {
         return profile;
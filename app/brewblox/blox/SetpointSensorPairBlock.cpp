@@ -91,10 +91,11 @@ cbox::update_t
 SetpointSensorPairBlock::update(const cbox::update_t& now)
 {
     bool doUpdate = false;
-    auto nextUpdate = m_intervalHelper.update(now, doUpdate);
+    auto nextUpdate = m_interval.update(now, doUpdate);
 
     if (doUpdate) {
         pair.update();
+        notifyChanged();
     }
     return nextUpdate;
 }
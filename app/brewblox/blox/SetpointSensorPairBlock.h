@@ -17,8 +17,8 @@
  * along with BrewBlox.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "IntervalHelper.h"
 #include "SetpointSensorPair.h"
+#include "TriggeredInterval.h"
 #include "blox/Block.h"
 #include "cbox/CboxPtr.h"
 
@@ -26,7 +26,9 @@ class SetpointSensorPairBlock : public Block<BrewBloxTypes_BlockType_SetpointSen
 private:
     cbox::CboxPtr<TempSensor> sensor;
     SetpointSensorPair pair;
-    IntervalHelper<1000> m_intervalHelper;
+    // Updates on new sensor data. The filter expects samples at 1s intervals, so faster sensors are not sampled faster.
+    // Without sensor updates, it still updates every 1.5s to detect a missing sensor
+    TriggeredInterval<900, 1500> m_interval;
 
 public:
     SetpointSensorPairBlock(cbox::ObjectContainer& objects)
@@ -47,6 +49,16 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(sensor.getId(), cbox::LinkType::INPUT);
+    }
+
+    virtual void inputChanged() override final
+    {
+        m_interval.trigger();
+    }
+
     SetpointSensorPair& get()
     {
         return pair;
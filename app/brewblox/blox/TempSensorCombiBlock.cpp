@@ -19,6 +19,7 @@
 
 #include "TempSensorCombiBlock.h"
 #include "FieldTags.h"
+#include <algorithm>
 
 cbox::CboxError
 TempSensorCombiBlock::streamFrom(cbox::DataIn& in)
@@ -27,6 +28,7 @@ TempSensorCombiBlock::streamFrom(cbox::DataIn& in)
     cbox::CboxError result = streamProtoFrom(in, &newData, blox_TempSensorCombi_fields, blox_TempSensorCombi_size);
     if (result == cbox::CboxError::OK) {
         sensor.func = TempSensorCombi::CombineFunc(newData.combineFunc);
+        sensor.outlierThreshold = cnl::wrap<temp_t>(newData.outlierThreshold);
         inputs.clear();
         sensor.inputs.clear();
         inputs.reserve(newData.sensors_count);
@@ -34,9 +36,12 @@ TempSensorCombiBlock::streamFrom(cbox::DataIn& in)
         for (uint8_t i = 0; i < newData.sensors_count && i < 8; i++) {
             inputs.push_back(cbox::CboxPtr<TempSensor>(objectsRef, newData.sensors[i]));
         }
-        for (auto& i : inputs) {
-            sensor.inputs.push_back(i.lockFunctor());
+        for (uint8_t i = 0; i < inputs.size(); i++) {
+            // inputs without a weight have weight 1
+            uint8_t weight = i < newData.weights_count ? newData.weights[i] : 1;
+            sensor.inputs.emplace_back(inputs[i].lockFunctor(), weight);
         }
+        objectsRef.linksChanged();
     }
     return result;
 }
@@ -48,11 +53,26 @@ TempSensorCombiBlock::writeMessage(blox_TempSensorCombi& message, bool includeRe
 
     message.sensors_count = sensor.inputs.size();
     message.combineFunc = _blox_SensorCombiFunc(sensor.func);
+    message.outlierThreshold = cnl::unwrap(sensor.outlierThreshold);
     for (uint8_t i = 0; i < message.sensors_count && i < 8; i++) {
         message.sensors[i] = inputs[i].getId();
     }
 
+    // weights are only sent when they are not all the default value of 1
+    bool weighted = false;
+    for (uint8_t i = 0; i < message.sensors_count && i < 8; i++) {
+        message.weights[i] = sensor.inputs[i].weight;
+        weighted = weighted || sensor.inputs[i].weight != 1;
+    }
+    message.weights_count = weighted ? message.sensors_count : 0;
+
     if (includeReadOnly) {
+        message.inputStaleness_count = message.sensors_count;
+        for (uint8_t i = 0; i < message.sensors_count && i < 8; i++) {
+            // seconds since the input last had a valid value
+            message.inputStaleness[i] = std::min<duration_millis_t>(sensor.inputs[i].stale / 1000, UINT16_MAX);
+        }
+
         if (sensor.valid()) {
             message.value = cnl::unwrap((sensor.value()));
         } else {
@@ -82,7 +102,8 @@ TempSensorCombiBlock::streamPersistedTo(cbox::DataOut& out) const
 cbox::update_t
 TempSensorCombiBlock::update(const cbox::update_t& now)
 {
-    sensor.update();
+    sensor.update(now);
+    notifyChanged();
     return update_1s(now);
 }
 
@@ -50,6 +50,13 @@ public:
 
     virtual void* implements(const cbox::obj_type_t& iface) override final;
 
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        for (const auto& i : inputs) {
+            visit(i.getId(), cbox::LinkType::INPUT);
+        }
+    }
+
     TempSensorCombi& get()
     {
         return sensor;
@@ -101,6 +101,7 @@ public:
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
+        notifyChanged();
         return sensor.update(now);
     }
 
@@ -1,17 +1,45 @@
 #pragma once
 
+#include "AdaptiveInterval.h"
 #include "DS18B20.h"
+#include "OneWireStatsProto.h"
 #include "Temperature.h"
 #include "blox/Block.h"
 #include "blox/FieldTags.h"
 #include "proto/cpp/TempSensorOneWire.pb.h"
+#include <algorithm>
 
 OneWire&
 theOneWire();
 
+OneWire&
+theOneWire(uint8_t bus);
+
+cbox::obj_id_t
+oneWireBusBlockId(uint8_t bus);
+
+uint8_t
+oneWireBusIndex(cbox::obj_id_t id);
+
 class TempSensorOneWireBlock : public Block<BrewBloxTypes_BlockType_TempSensorOneWire> {
 private:
     DS18B20 sensor;
+    // Read when the bus has finished a conversion and the read interval has passed.
+    // The read interval adapts to how fast the temperature changes, between the configured minimum and maximum.
+    AdaptiveInterval m_interval;
+    uint32_t m_minInterval = 0; // as configured, 0 for the default
+    uint32_t m_maxInterval = 0;
+    uint8_t m_busIndex = 0;
+    bool m_reading = false;
+    OneWireErrorTracker m_errors;
+
+    static constexpr const duration_millis_t defaultInterval = 500;
+
+    // The main loop processes the read without blocking, check again when it is expected to have completed
+    cbox::update_t readCheckTime(const cbox::update_t& now) const
+    {
+        return now + std::max<cbox::update_t>(1, (sensor.readExpected() + 999) / 1000);
+    }
 
 public:
     TempSensorOneWireBlock()
@@ -27,6 +55,16 @@ public:
         if (res == cbox::CboxError::OK) {
             sensor.address(OneWireAddress(newData.address));
             sensor.setCalibration(cnl::wrap<temp_t>(newData.offset));
+            bus(oneWireBusIndex(newData.oneWireBusId));
+            sensor.alarmMode(newData.alarmMode);
+            m_minInterval = newData.minInterval;
+            m_maxInterval = newData.maxInterval;
+            // without a maximum, the sensor is read at the minimum interval
+            duration_millis_t minInterval = m_minInterval;
+            if (!minInterval) {
+                minInterval = defaultInterval;
+            }
+            m_interval.limits(minInterval, m_maxInterval);
         }
         return res;
     }
@@ -44,6 +82,11 @@ public:
 
         message.address = sensor.address();
         message.offset = cnl::unwrap(sensor.getCalibration());
+        message.minInterval = m_minInterval;
+        message.maxInterval = m_maxInterval;
+        message.oneWireBusId = oneWireBusBlockId(m_busIndex);
+        message.alarmMode = sensor.alarmMode();
+        getOneWireStats(message.stats, sensor.stats(), m_errors.lastError());
 
         stripped.copyToMessage(message.strippedFields, message.strippedFields_count, 1);
         return streamProtoTo(out, &message, blox_TempSensorOneWire_fields, blox_TempSensorOneWire_size);
@@ -54,13 +97,43 @@ public:
         blox_TempSensorOneWire message = blox_TempSensorOneWire_init_zero;
         message.address = sensor.address();
         message.offset = cnl::unwrap(sensor.getCalibration());
+        message.minInterval = m_minInterval;
+        message.maxInterval = m_maxInterval;
+        message.oneWireBusId = oneWireBusBlockId(m_busIndex);
+        message.alarmMode = sensor.alarmMode();
         return streamProtoTo(out, &message, blox_TempSensorOneWire_fields, blox_TempSensorOneWire_size);
     }
 
     virtual cbox::update_t update(const cbox::update_t& now) override final
     {
-        sensor.update();
-        return update_1s(now);
+        m_errors.update(sensor.stats(), now);
+        if (m_reading) {
+            if (sensor.readPending()) {
+                return readCheckTime(now);
+            }
+            m_reading = false;
+            m_interval.sample(sensor.value(), sensor.valid());
+            notifyChanged();
+        }
+
+        bool doUpdate = false;
+        auto nextUpdate = m_interval.update(now, doUpdate);
+
+        if (doUpdate) {
+            m_reading = sensor.updateAsync();
+        }
+        return m_reading ? readCheckTime(now) : nextUpdate;
+    }
+
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        // the bus block that starts the conversions
+        visit(oneWireBusBlockId(m_busIndex), cbox::LinkType::INPUT);
+    }
+
+    virtual void inputChanged() override final
+    {
+        m_interval.trigger();
     }
 
     virtual void* implements(const cbox::obj_type_t& iface) override final
@@ -87,4 +160,14 @@ public:
     {
         return sensor;
     }
+
+    // Select the bus of the sensor by index. The index is kept when the bus does not exist, the first bus is used then.
+    // The bus is persisted as the id of its OneWireBus block, which is also linked as input. Returns true if the bus changed.
+    bool bus(uint8_t index)
+    {
+        bool changed = index != m_busIndex;
+        m_busIndex = index;
+        sensor.bus(theOneWire(index));
+        return changed;
+    }
 };
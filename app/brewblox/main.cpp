@@ -21,6 +21,7 @@
 #include "Board.h"
 #include "BrewBlox.h"
 #include "Buzzer.h"
+#include "OneWireScheduler.h"
 #include "TimerInterrupts.h"
 #include "blox/stringify.h"
 #include "cbox/Box.h"
@@ -163,6 +164,10 @@ setup()
     StartupScreen::setProgress(70);
     StartupScreen::setStep("Loading blocks");
     brewbloxBox().loadObjectsFromStorage(); // init box and load stored objects
+    if (oneWireBuses().size() > 1) {
+        // stored OneWire devices start on the first bus, discovery moves them to the bus they are found on
+        brewbloxBox().restartDiscovery();
+    }
     HAL_Delay_Milliseconds(1);
 
     StartupScreen::setProgress(80);
@@ -272,6 +272,40 @@ SCENARIO("Test", "[maklogicblock]")
             CHECK(result.errorpos() == 0);
         }
 
+        THEN("The target is driven when the result changes and re-driven by a slow safety update")
+        {
+            auto targetDesiredState = [&testBox]() {
+                testBox.put(uint16_t(0));
+                testBox.put(commands::READ_OBJECT);
+                testBox.put(cbox::obj_id_t{105});
+                auto decoded = blox::DigitalActuator();
+                testBox.processInputToProto(decoded);
+                REQUIRE(testBox.lastReplyHasStatusOk());
+                return decoded.desiredstate();
+            };
+
+            message.set_expression("a");
+            setAct(101, blox::DigitalState::Active);
+            result = setLogic(message);
+            CHECK(result.result() == blox::Compare_Result_RESULT_TRUE);
+            CHECK(targetDesiredState() == blox::DigitalState::Active);
+
+            testBox.update(1000);
+
+            // the target is changed manually, the logic does not overwrite it until the safety update
+            setAct(105, blox::DigitalState::Inactive);
+            testBox.update(1500);
+            CHECK(targetDesiredState() == blox::DigitalState::Inactive);
+
+            testBox.update(2000);
+            CHECK(targetDesiredState() == blox::DigitalState::Active);
+
+            // a change of the input is passed on to the target without waiting for the safety update
+            setAct(101, blox::DigitalState::Inactive);
+            testBox.update(2100);
+            CHECK(targetDesiredState() == blox::DigitalState::Inactive);
+        }
+
         THEN("The target is inactive when the expression has an error and the correct error code and pos is returned")
         {
             message.set_expression("e&c");
@@ -354,6 +388,17 @@ SCENARIO("Test", "[maklogicblock]")
             result = setLogic(message);
             CHECK(result.result() == blox::Compare_Result_RESULT_BLOCK_NOT_FOUND);
             CHECK(result.errorpos() == 0);
+
+            // comparisons that don't affect the result are not evaluated
+            message.set_expression("a&b");
+            result = setLogic(message);
+            CHECK(result.result() == blox::Compare_Result_RESULT_FALSE);
+            CHECK(result.errorpos() == 0);
+
+            message.set_expression("c|(a|b)");
+            result = setLogic(message);
+            CHECK(result.result() == blox::Compare_Result_RESULT_BLOCK_NOT_FOUND);
+            CHECK(result.errorpos() == 5);
         }
 
         AND_WHEN("Analog comparisons are used")
@@ -86,5 +86,84 @@ SCENARIO("Auto discovery of OneWire devices")
                 CHECK(reply == cbox::addCrc("00000C") + "|0000" + "," + cbox::addCrc("69002E01") + "\n");
             }
         }
+
+        AND_WHEN("One of the sensors is removed while discovery is running in the background")
+        {
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::START_DISCOVERY);
+            testBox.processInput();
+            CHECK(testBox.lastReplyHasStatusOk());
+
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::DELETE_OBJECT);
+            testBox.put(cbox::obj_id_t(101));
+            testBox.processInput();
+            CHECK(testBox.lastReplyHasStatusOk());
+
+            for (cbox::update_t now = 1; now <= 6; now++) {
+                testBox.update(now);
+            }
+
+            THEN("It is discovered again in the same scan")
+            {
+                testBox.put(uint16_t(0)); // msg id
+                testBox.put(commands::READ_DISCOVERED_OBJECTS);
+                auto reply = testBox.processInput();
+                CHECK(reply == cbox::addCrc("00000E") + "|" + cbox::addCrc("0000") + "," + cbox::addCrc("69002E01") + "\n");
+            }
+        }
+    }
+
+    WHEN("Discovery is started in the background")
+    {
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::START_DISCOVERY);
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        // each update examines a single address, 5 devices are on the bus
+        for (cbox::update_t now = 1; now <= 6; now++) {
+            testBox.update(now);
+        }
+
+        THEN("The new objects are reported by a read command, after discovery has completed")
+        {
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::READ_DISCOVERED_OBJECTS);
+            auto reply = testBox.processInput();
+            CHECK(reply == cbox::addCrc("00000E") + "|" + cbox::addCrc("0000") + "," + cbox::addCrc("64002E01") + "," + cbox::addCrc("65002E01") + "," + cbox::addCrc("66002E01") + "," + cbox::addCrc("67003B01") + "," + cbox::addCrc("68003D01") + "\n");
+        }
+    }
+    WHEN("A sensor is created by a command while discovery is running in the background")
+    {
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::START_DISCOVERY);
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        testBox.update(1); // the first sensor is discovered as object 100
+
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::CREATE_OBJECT);
+        testBox.put(cbox::obj_id_t(0));
+        testBox.put(uint8_t(0xFF));
+        testBox.put(TempSensorOneWireBlock::staticTypeId());
+        auto message = blox::TempSensorOneWire();
+        message.set_address(0x3333'3333'3333'3328); // the third sensor on the bus
+        testBox.put(message);
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        for (cbox::update_t now = 2; now <= 6; now++) {
+            testBox.update(now);
+        }
+
+        THEN("The index of the scan is updated and the sensor is not created again")
+        {
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::READ_DISCOVERED_OBJECTS);
+            auto reply = testBox.processInput();
+            CHECK(reply == cbox::addCrc("00000E") + "|" + cbox::addCrc("0000") + "," + cbox::addCrc("64002E01") + "," + cbox::addCrc("66002E01") + "," + cbox::addCrc("67003B01") + "," + cbox::addCrc("68003D01") + "\n");
+        }
     }
 }
@@ -93,7 +93,7 @@ SCENARIO("Two pin actuators are constrained by a mutex", "[balancer, mutex]")
             auto decoded = blox::Mutex();
             testBox.processInputToProto(decoded);
             CHECK(testBox.lastReplyHasStatusOk());
-            CHECK(decoded.ShortDebugString() == "differentActuatorWait: 100 waitRemaining: 100");
+            CHECK(decoded.ShortDebugString() == "differentActuatorWait: 100 waitRemaining: 100 waitingCount: 1");
         }
 
         // read pin actuator 1, which is active
@@ -295,8 +295,8 @@ SCENARIO("Two pin actuators are constrained by a mutex", "[balancer, mutex]")
             testBox.processInputToProto(decoded);
             CHECK(testBox.lastReplyHasStatusOk());
             CHECK(decoded.ShortDebugString() ==
-                  "clients { id: 1 requested: 327680 granted: 204800 } "  // 80*4096, 50*4096
-                  "clients { id: 2 requested: 327680 granted: 204800 }"); // 80*4096, 50*4096
+                  "clients { id: 1 requested: 327680 granted: 204800 weight: 1 } "  // 80*4096, 50*4096
+                  "clients { id: 2 requested: 327680 granted: 204800 weight: 1 }"); // 80*4096, 50*4096
         }
 
         // read a pwm actuator 1
@@ -313,7 +313,7 @@ SCENARIO("Two pin actuators are constrained by a mutex", "[balancer, mutex]")
                   "period: 4000 setting: 204800 "
                   "constrainedBy { "
                   "constraints { "
-                  "balanced { balancerId: 200 granted: 204800 id: 1 } "
+                  "balanced { balancerId: 200 granted: 204800 id: 1 weight: 1 } "
                   "limiting: true } } "
                   "drivenActuatorId: 102 "
                   "enabled: true "
@@ -334,7 +334,7 @@ SCENARIO("Two pin actuators are constrained by a mutex", "[balancer, mutex]")
                   "period: 4000 setting: 204800 "
                   "constrainedBy { "
                   "constraints { "
-                  "balanced { balancerId: 200 granted: 204800 id: 2 } "
+                  "balanced { balancerId: 200 granted: 204800 id: 2 weight: 1 } "
                   "limiting: true } } "
                   "drivenActuatorId: 103 "
                   "enabled: true "
@@ -109,4 +109,5 @@ BrewBloxTestBox::update(const cbox::update_t& now)
     ticks.ticksImpl().reset(now);
 
     brewbloxBox().update(now);
+    processOneWireTransactions();
 }
@@ -75,7 +75,7 @@ SCENARIO("A DigitalActuator Block with a DS2413 target")
         THEN("The returned protobuf data is as expected")
         {
             CHECK(testBox.lastReplyHasStatusOk());
-            CHECK(decoded.ShortDebugString() == "address: 451560922637681722 connected: true pins { A { } } pins { B { } }");
+            CHECK(decoded.ShortDebugString() == "address: 451560922637681722 connected: true pins { A { } } pins { B { } } oneWireBusId: 4");
         }
 
         THEN("The writable settings match what was sent")
@@ -124,7 +124,7 @@ SCENARIO("A DigitalActuator Block with a DS2413 target")
                 auto decoded = blox::DS2413();
                 testBox.processInputToProto(decoded);
 
-                CHECK(decoded.ShortDebugString() == "address: 451560922637681722 connected: true pins { A { config: CHANNEL_ACTIVE_HIGH state: STATE_ACTIVE } } pins { B { } }");
+                CHECK(decoded.ShortDebugString() == "address: 451560922637681722 connected: true pins { A { config: CHANNEL_ACTIVE_HIGH state: STATE_ACTIVE } } pins { B { } } oneWireBusId: 4");
             }
         }
 
@@ -240,6 +240,46 @@ SCENARIO("A DigitalActuator Block with Mockpins as target")
 
                 CHECK(decoded.ShortDebugString() == "pins { mock1 { config: CHANNEL_ACTIVE_HIGH state: STATE_ACTIVE } } pins { mock2 { } } pins { mock3 { } } pins { mock4 { } } pins { mock5 { } } pins { mock6 { } } pins { mock7 { } } pins { mock8 { } }");
             }
+
+            AND_WHEN("A state history size is written")
+            {
+                testBox.put(uint16_t(0)); // msg id
+                testBox.put(commands::WRITE_OBJECT);
+                testBox.put(cbox::obj_id_t(actId));
+                testBox.put(uint8_t(0xFF));
+                testBox.put(DigitalActuatorBlock::staticTypeId());
+
+                message.set_statehistorysize(200);
+                testBox.put(message);
+                testBox.processInput();
+                CHECK(testBox.lastReplyHasStatusOk());
+
+                THEN("It is part of the block data")
+                {
+                    testBox.put(uint16_t(0)); // msg id
+                    testBox.put(commands::READ_OBJECT);
+                    testBox.put(cbox::obj_id_t(actId));
+
+                    auto decoded = blox::DigitalActuator();
+                    testBox.processInputToProto(decoded);
+
+                    CHECK(decoded.ShortDebugString() == "hwDevice: 100 channel: 1 state: STATE_ACTIVE desiredState: STATE_ACTIVE stateHistorySize: 200");
+                }
+
+                THEN("A size above the maximum is rejected")
+                {
+                    testBox.put(uint16_t(0)); // msg id
+                    testBox.put(commands::WRITE_OBJECT);
+                    testBox.put(cbox::obj_id_t(actId));
+                    testBox.put(uint8_t(0xFF));
+                    testBox.put(DigitalActuatorBlock::staticTypeId());
+
+                    message.set_statehistorysize(ActuatorDigitalConstrained::maxStateHistorySize + 1);
+                    testBox.put(message);
+                    testBox.processInput();
+                    CHECK(!testBox.lastReplyHasStatusOk());
+                }
+            }
         }
     }
 }
@@ -28,12 +28,12 @@ public:
     MockOneWireScanningFactory(cbox::ObjectContainer& objects, OneWire& ow)
         : OneWireScanningFactory(objects, ow)
     {
-        reset();
+        resetSearch();
     }
 
     virtual ~MockOneWireScanningFactory() = default;
 
-    virtual void reset() override final
+    virtual void resetSearch() override final
     {
         nextAddress = adressesOnBus.cbegin();
     }
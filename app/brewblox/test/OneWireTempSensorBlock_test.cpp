@@ -66,6 +66,8 @@ SCENARIO("A TempSensorOneWireBlock")
             // added to stripped fields to distinguish from value zero
             CHECK(decoded.ShortDebugString() == "offset: 2048 "
                                                 "address: 9084060688381448488 "
+                                                "stats { } "
+                                                "oneWireBusId: 4 "
                                                 "strippedFields: 1");
 
             testBox.put(uint16_t(1)); // msg id
@@ -73,6 +75,7 @@ SCENARIO("A TempSensorOneWireBlock")
             testBox.put(cbox::obj_id_t(100));
 
             testBox.update(1000);
+            testBox.update(1001); // the read started by the sensor completes after the update, its value is used in the next loop
 
             auto decoded = blox::TempSensorOneWire();
             testBox.processInputToProto(decoded);
@@ -80,7 +83,9 @@ SCENARIO("A TempSensorOneWireBlock")
             // After an update, the sensor returns a valid temperature
             CHECK(decoded.ShortDebugString() == "value: 83968 " // 20*4096 + 2048
                                                 "offset: 2048 "
-                                                "address: 9084060688381448488");
+                                                "address: 9084060688381448488 "
+                                                "stats { } " // no errors, the mock bus takes no time
+                                                "oneWireBusId: 4");
 
             AND_THEN("The writable settings match what was sent")
             {
@@ -98,4 +103,77 @@ SCENARIO("A TempSensorOneWireBlock")
             }
         }
     }
+    WHEN("a TempSensorOneWire object is created with read interval limits")
+    {
+        BrewBloxTestBox testBox;
+        using commands = cbox::Box::CommandID;
+
+        testBox.reset();
+
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::CREATE_OBJECT);
+        testBox.put(cbox::obj_id_t(100));
+        testBox.put(uint8_t(0xFF));
+        testBox.put(TempSensorOneWireBlock::staticTypeId());
+
+        auto message = blox::TempSensorOneWire();
+        message.set_address(0x7E11'1111'1111'1128);
+        message.set_mininterval(1000);
+        message.set_maxinterval(5000);
+        testBox.put(message);
+
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        THEN("The limits are returned as they were set")
+        {
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::READ_OBJECT);
+            testBox.put(cbox::obj_id_t(100));
+
+            auto decoded = blox::TempSensorOneWire();
+            testBox.processInputToProto(decoded);
+
+            CHECK(testBox.lastReplyHasStatusOk());
+            CHECK(decoded.mininterval() == 1000);
+            CHECK(decoded.maxinterval() == 5000);
+        }
+    }
+    WHEN("a TempSensorOneWire object is created in alarm mode")
+    {
+        BrewBloxTestBox testBox;
+        using commands = cbox::Box::CommandID;
+
+        testBox.reset();
+
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::CREATE_OBJECT);
+        testBox.put(cbox::obj_id_t(100));
+        testBox.put(uint8_t(0xFF));
+        testBox.put(TempSensorOneWireBlock::staticTypeId());
+
+        auto message = blox::TempSensorOneWire();
+        message.set_address(0x7E11'1111'1111'1128);
+        message.set_alarmmode(true);
+        testBox.put(message);
+
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        THEN("The sensor is in alarm mode")
+        {
+            auto lookup = brewbloxBox().makeCboxPtr<TempSensorOneWireBlock>(100);
+            auto sensorPtr = lookup.lock();
+            REQUIRE(sensorPtr);
+            CHECK(sensorPtr->get().alarmMode() == true);
+
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::READ_OBJECT);
+            testBox.put(cbox::obj_id_t(100));
+
+            auto decoded = blox::TempSensorOneWire();
+            testBox.processInputToProto(decoded);
+            CHECK(decoded.alarmmode() == true);
+        }
+    }
 }
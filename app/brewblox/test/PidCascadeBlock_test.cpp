@@ -0,0 +1,167 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "BrewBloxTestBox.h"
+#include "Temperature.h"
+#include "blox/ActuatorAnalogMockBlock.h"
+#include "blox/PidCascadeBlock.h"
+#include "blox/SetpointSensorPairBlock.h"
+#include "blox/TempSensorMockBlock.h"
+#include "proto/test/cpp/ActuatorAnalogMock_test.pb.h"
+#include "proto/test/cpp/PidCascade_test.pb.h"
+#include "proto/test/cpp/SetpointSensorPair_test.pb.h"
+#include "proto/test/cpp/TempSensorMock_test.pb.h"
+
+SCENARIO("A PidCascade block controlling beer temperature with a fridge setpoint")
+{
+    BrewBloxTestBox testBox;
+    using commands = cbox::Box::CommandID;
+
+    testBox.reset();
+    auto beerSensorId = cbox::obj_id_t(100);
+    auto beerPairId = cbox::obj_id_t(101);
+    auto fridgeSensorId = cbox::obj_id_t(102);
+    auto fridgePairId = cbox::obj_id_t(103);
+    auto actuatorId = cbox::obj_id_t(104);
+    auto cascadeId = cbox::obj_id_t(105);
+
+    auto createPair = [&testBox](cbox::obj_id_t sensorId, cbox::obj_id_t pairId, temp_t setting) {
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::CREATE_OBJECT);
+        testBox.put(sensorId);
+        testBox.put(uint8_t(0xFF));
+        testBox.put(TempSensorMockBlock::staticTypeId());
+
+        auto newSensor = blox::TempSensorMock();
+        newSensor.set_setting(cnl::unwrap(temp_t(20.0)));
+        newSensor.set_connected(true);
+        testBox.put(newSensor);
+
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::CREATE_OBJECT);
+        testBox.put(pairId);
+        testBox.put(uint8_t(0xFF));
+        testBox.put(SetpointSensorPairBlock::staticTypeId());
+
+        blox::SetpointSensorPair newPair;
+        newPair.set_sensorid(sensorId);
+        newPair.set_storedsetting(cnl::unwrap(setting));
+        newPair.set_settingenabled(true);
+        newPair.set_filter(blox::FilterChoice::FILTER_NONE);
+        testBox.put(newPair);
+
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+    };
+
+    createPair(beerSensorId, beerPairId, temp_t(21));
+    createPair(fridgeSensorId, fridgePairId, temp_t(20));
+
+    // create actuator
+    testBox.put(uint16_t(0)); // msg id
+    testBox.put(commands::CREATE_OBJECT);
+    testBox.put(actuatorId);
+    testBox.put(uint8_t(0xFF));
+    testBox.put(ActuatorAnalogMockBlock::staticTypeId());
+
+    blox::ActuatorAnalogMock newActuator;
+    newActuator.set_setting(cnl::unwrap(ActuatorAnalog::value_t(0)));
+    newActuator.set_minsetting(cnl::unwrap(ActuatorAnalog::value_t(0)));
+    newActuator.set_maxsetting(cnl::unwrap(ActuatorAnalog::value_t(100)));
+    newActuator.set_minvalue(cnl::unwrap(ActuatorAnalog::value_t(0)));
+    newActuator.set_maxvalue(cnl::unwrap(ActuatorAnalog::value_t(100)));
+    testBox.put(newActuator);
+
+    testBox.processInput();
+    CHECK(testBox.lastReplyHasStatusOk());
+
+    // create cascade
+    testBox.put(uint16_t(0)); // msg id
+    testBox.put(commands::CREATE_OBJECT);
+    testBox.put(cascadeId);
+    testBox.put(uint8_t(0xFF));
+    testBox.put(PidCascadeBlock::staticTypeId());
+
+    blox::PidCascade newCascade;
+    newCascade.set_outerinputid(beerPairId);
+    newCascade.set_innerinputid(fridgePairId);
+    newCascade.set_outputid(actuatorId);
+    newCascade.set_enabled(true);
+    newCascade.mutable_outer()->set_kp(cnl::unwrap(Pid::in_t(2)));
+    newCascade.mutable_inner()->set_kp(cnl::unwrap(Pid::in_t(10)));
+    testBox.put(newCascade);
+
+    testBox.processInput();
+    CHECK(testBox.lastReplyHasStatusOk());
+
+    uint32_t now = 0;
+    for (; now < 10'000; now += 100) {
+        testBox.update(now);
+    }
+
+    THEN("Both loops are reported in one message and the inner setpoint and output follow the outer loop")
+    {
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::READ_OBJECT);
+        testBox.put(cascadeId);
+
+        auto decoded = blox::PidCascade();
+        testBox.processInputToProto(decoded);
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        CHECK(decoded.active());
+        CHECK(decoded.outer().active());
+        CHECK(decoded.inner().active());
+        CHECK(cnl::wrap<Pid::out_t>(decoded.outer().p()) == Approx(2.0).margin(0.01));
+        CHECK(cnl::wrap<temp_t>(decoded.innerinputsetting()) == Approx(23.0).margin(0.01));
+        CHECK(cnl::wrap<Pid::out_t>(decoded.inner().p()) == Approx(30.0).margin(0.01));
+        CHECK(cnl::wrap<Pid::out_t>(decoded.outputsetting()) == Approx(30.0).margin(0.01));
+        CHECK(decoded.driveninnerinputid() == fridgePairId);
+        CHECK(decoded.drivenoutputid() == actuatorId);
+    }
+
+    AND_WHEN("The cascade is disabled")
+    {
+        testBox.put(uint16_t(0)); // msg id
+        testBox.put(commands::WRITE_OBJECT);
+        testBox.put(cascadeId);
+        testBox.put(uint8_t(0xFF));
+        testBox.put(PidCascadeBlock::staticTypeId());
+
+        newCascade.set_enabled(false);
+        testBox.put(newCascade);
+
+        testBox.processInput();
+        CHECK(testBox.lastReplyHasStatusOk());
+
+        brewbloxBox().update(now + 2000);
+        auto actuatorLookup = brewbloxBox().makeCboxPtr<ActuatorAnalogMockBlock>(actuatorId);
+
+        THEN("The actuator is set to zero")
+        {
+            auto act = actuatorLookup.lock();
+            CHECK(act->get().setting() == 0);
+        }
+    }
+}
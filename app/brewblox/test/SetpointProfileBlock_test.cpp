@@ -217,5 +217,68 @@ SCENARIO("A SetpointProfile block")
                                                 "drivenTargetId: 101 "
                                                 "start: 20000");
         }
+
+        WHEN("A large profile is uploaded in chunks")
+        {
+            auto writeChunk = [&testBox](blox::ProfileChunkOp op, uint16_t start, uint16_t first, uint16_t count) {
+                testBox.put(uint16_t(0));
+                testBox.put(commands::WRITE_OBJECT);
+                testBox.put(cbox::obj_id_t(102));
+                testBox.put(uint8_t(0xFF));
+                testBox.put(SetpointProfileBlock::staticTypeId());
+
+                auto message = blox::SetpointProfile();
+                message.set_targetid(101);
+                message.set_enabled(true);
+                message.set_start(20'000);
+                message.set_chunkop(op);
+                message.set_chunkstart(start);
+                for (uint16_t i = first; i < first + count; i++) {
+                    auto newPoint = message.add_points();
+                    newPoint->set_time(i * 60);
+                    newPoint->set_temperature(cnl::unwrap(temp_t(20 + i % 10)));
+                }
+                testBox.put(message);
+
+                auto decoded = blox::SetpointProfile();
+                testBox.processInputToProto(decoded);
+                return decoded;
+            };
+
+            writeChunk(blox::ProfileChunkOp::PROFILE_CHUNK_NONE, 0, 0, 25);
+            for (uint16_t first = 25; first < 100; first += 25) {
+                writeChunk(blox::ProfileChunkOp::PROFILE_CHUNK_APPEND, 0, first, 25);
+                CHECK(testBox.lastReplyHasStatusOk());
+            }
+
+            THEN("All points are added to the profile")
+            {
+                CHECK(profilePtr->get().points().size() == 100);
+            }
+
+            AND_WHEN("A range is replaced")
+            {
+                auto decoded = writeChunk(blox::ProfileChunkOp::PROFILE_CHUNK_REPLACE, 50, 0, 2);
+                CHECK(testBox.lastReplyHasStatusOk());
+                CHECK(decoded.points_size() == 100);
+                CHECK(decoded.points(50).time() == 0);
+                CHECK(decoded.points(51).time() == 60);
+                CHECK(decoded.points(52).time() == 52 * 60);
+            }
+
+            AND_WHEN("A range is replaced that would leave a gap, it is refused")
+            {
+                writeChunk(blox::ProfileChunkOp::PROFILE_CHUNK_REPLACE, 101, 0, 2);
+                CHECK(!testBox.lastReplyHasStatusOk());
+                CHECK(profilePtr->get().points().size() == 100);
+            }
+
+            AND_WHEN("The profile is truncated")
+            {
+                auto decoded = writeChunk(blox::ProfileChunkOp::PROFILE_CHUNK_TRUNCATE, 60, 0, 0);
+                CHECK(testBox.lastReplyHasStatusOk());
+                CHECK(decoded.points_size() == 60);
+            }
+        }
     }
-}
\ No newline at end of file
+}
@@ -126,7 +126,8 @@ SCENARIO("A TempSensorCombi block")
                 testBox.processInputToProto(decoded);
 
                 CHECK(testBox.lastReplyHasStatusOk());
-                CHECK(decoded.ShortDebugString() == "value: 90112 sensors: 101 sensors: 102 sensors: 103");
+                CHECK(decoded.ShortDebugString() == "value: 90112 sensors: 101 sensors: 102 sensors: 103 "
+                                                    "inputStaleness: 0 inputStaleness: 0 inputStaleness: 0");
             }
         }
     }
@@ -159,7 +160,8 @@ SCENARIO("A TempSensorCombi block")
                 testBox.processInputToProto(decoded);
 
                 CHECK(testBox.lastReplyHasStatusOk());
-                CHECK(decoded.ShortDebugString() == "value: 94208 combineFunc: SENSOR_COMBI_FUNC_MAX sensors: 101 sensors: 102 sensors: 103");
+                CHECK(decoded.ShortDebugString() == "value: 94208 combineFunc: SENSOR_COMBI_FUNC_MAX sensors: 101 sensors: 102 sensors: 103 "
+                                                    "inputStaleness: 0 inputStaleness: 0 inputStaleness: 0");
             }
         }
     }
@@ -192,7 +194,45 @@ SCENARIO("A TempSensorCombi block")
                 testBox.processInputToProto(decoded);
 
                 CHECK(testBox.lastReplyHasStatusOk());
-                CHECK(decoded.ShortDebugString() == "value: 86016 combineFunc: SENSOR_COMBI_FUNC_MIN sensors: 101 sensors: 102 sensors: 103");
+                CHECK(decoded.ShortDebugString() == "value: 86016 combineFunc: SENSOR_COMBI_FUNC_MIN sensors: 101 sensors: 102 sensors: 103 "
+                                                    "inputStaleness: 0 inputStaleness: 0 inputStaleness: 0");
+            }
+        }
+    }
+
+    WHEN("func is set to MEDIAN and the inputs have weights")
+    {
+        {
+            testBox.put(uint16_t(0)); // msg id
+            testBox.put(commands::WRITE_OBJECT);
+            testBox.put(cbox::obj_id_t(100));
+            testBox.put(uint8_t(0xFF));
+            testBox.put(TempSensorCombiBlock::staticTypeId());
+
+            TempSensorCombi.set_combinefunc(blox::SensorCombiFunc::SENSOR_COMBI_FUNC_MEDIAN);
+            TempSensorCombi.add_weights(2);
+            TempSensorCombi.add_weights(1);
+            TempSensorCombi.add_weights(1);
+            testBox.put(TempSensorCombi);
+
+            testBox.processInput();
+            CHECK(testBox.lastReplyHasStatusOk());
+
+            testBox.update(1000);
+
+            THEN("The value of the sensor is the middle one of the 3 and the weights are sent")
+            {
+                testBox.put(uint16_t(0)); // msg id
+                testBox.put(commands::READ_OBJECT);
+                testBox.put(cbox::obj_id_t(100));
+
+                auto decoded = blox::TempSensorCombi();
+                testBox.processInputToProto(decoded);
+
+                CHECK(testBox.lastReplyHasStatusOk());
+                CHECK(decoded.ShortDebugString() == "value: 90112 combineFunc: SENSOR_COMBI_FUNC_MEDIAN sensors: 101 sensors: 102 sensors: 103 "
+                                                    "weights: 2 weights: 1 weights: 1 "
+                                                    "inputStaleness: 0 inputStaleness: 0 inputStaleness: 0");
             }
         }
     }
@@ -261,7 +301,9 @@ SCENARIO("A TempSensorCombi block")
             testBox.processInputToProto(decoded);
 
             CHECK(testBox.lastReplyHasStatusOk());
-            CHECK(decoded.ShortDebugString() == "sensors: 101 sensors: 102 sensors: 103 strippedFields: 1");
+            CHECK(decoded.ShortDebugString() == "sensors: 101 sensors: 102 sensors: 103 "
+                                                "inputStaleness: 1 inputStaleness: 1 inputStaleness: 1 "
+                                                "strippedFields: 1");
         }
     }
 }
\ No newline at end of file
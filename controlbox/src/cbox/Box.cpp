@@ -160,6 +160,7 @@ Box::writeObject(DataIn& in, EncodedDataOut& out)
             }
             if (status == CboxError::OK) {
                 *cobj = ContainedObject(id, cobj->groups(), std::move(obj)); // replace contained object
+                objects.linksChanged();
             }
         }
         if (status == CboxError::OK) {
@@ -174,11 +175,13 @@ Box::writeObject(DataIn& in, EncodedDataOut& out)
         if ((cobj->groups() & activeGroups) == 0) {
             cobj->deactivate();
         }
+        notifyScanners(id);
     }
 
     out.writeResponseSeparator();
     out.write(asUint8(status));
     if (cobj != nullptr && status == CboxError::OK) {
+        warnIfCyclic(id, out);
         cobj->forcedUpdate(lastUpdateTime); // force an update of the object
         status = cobj->streamTo(out);
         if (status != CboxError::OK) {
@@ -262,10 +265,14 @@ Box::createObject(DataIn& in, EncodedDataOut& out)
         } else {
             status = CboxError::INVALID_OBJECT_ID;
         }
+        if (status == CboxError::OK) {
+            notifyScanners(id);
+        }
     }
     out.writeResponseSeparator();
     out.write(asUint8(status));
     if (ptrCobj != nullptr && status == CboxError::OK) {
+        warnIfCyclic(id, out);
         ptrCobj->forcedUpdate(lastUpdateTime); // force an update of the object
         status = ptrCobj->streamTo(out);
         if (status != CboxError::OK) {
@@ -274,6 +281,19 @@ Box::createObject(DataIn& in, EncodedDataOut& out)
     }
 }
 
+/**
+ * Adds an error annotation to the response if the object is part of a cycle of links.
+ * The object is still accepted, but it cannot be updated after all of its inputs.
+ */
+void
+Box::warnIfCyclic(const obj_id_t& id, EncodedDataOut& out)
+{
+    objects.refreshLinks();
+    if (objects.hasCyclicLinks(id)) {
+        out.writeError(CboxError::CYCLIC_OBJECT_LINKS);
+    }
+}
+
 /**
  * Handles the delete object command.
  *
@@ -304,6 +324,7 @@ Box::deleteObject(DataIn& in, EncodedDataOut& out)
     if (status == CboxError::OK) {
         status = objects.remove(id);
         storage.disposeObject(storageId);
+        notifyScanners(id);
     }
 
     out.writeResponseSeparator();
@@ -549,25 +570,98 @@ Box::clearObjects(DataIn& in, EncodedDataOut& out)
     }
 
     // remove user objects from storage
+    std::vector<obj_id_t> removedIds;
     auto cit = objects.userbegin();
     while (cit != objects.cend()) {
         auto id = cit->id();
         cit++;
         bool mergeDisposed = cit == objects.cend(); // merge disposed blocks on last delete
         storage.disposeObject(id, mergeDisposed);
+        removedIds.push_back(id);
     }
 
     // remove all user objects from vector
     objects.clear();
+    for (auto& id : removedIds) {
+        notifyScanners(id);
+    }
 
     out.write(asUint8(CboxError::OK));
 }
 
+void
+Box::restartDiscovery()
+{
+    discoveryScanner = 0;
+    discoveryActive = !scanners.empty();
+    if (discoveryActive) {
+        scanners[0]->reset();
+    }
+}
+
+bool
+Box::discoveryStep()
+{
+    if (!discoveryActive) {
+        return false;
+    }
+
+    bool done = false;
+    auto newId = scanners[discoveryScanner]->scanNextAndAdd(done);
+    if (newId) {
+        notifyScanners(newId);
+        if (auto cobj = objects.fetchContained(newId)) {
+            auto storeContained = [&cobj](DataOut& out) -> CboxError {
+                return cobj->streamPersistedTo(out);
+            };
+            storage.storeObject(newId, storeContained);
+        }
+        discoveredIds.push_back(newId);
+    }
+    if (done) {
+        ++discoveryScanner;
+        if (discoveryScanner < scanners.size()) {
+            scanners[discoveryScanner]->reset();
+        } else {
+            discoveryActive = false;
+        }
+    }
+    return discoveryActive;
+}
+
+// let the scanners update their index of the existing objects
+void
+Box::notifyScanners(const obj_id_t& id)
+{
+    auto cobj = objects.fetchContained(id);
+    Object* obj = cobj ? cobj->object().get() : nullptr;
+    for (auto& scanner : scanners) {
+        scanner->objectChanged(id, obj);
+    }
+}
+
+void
+Box::writeDiscoveredObjects(EncodedDataOut& out)
+{
+    for (auto& id : discoveredIds) {
+        auto cobj = objects.fetchContained(id);
+        if (cobj == nullptr) {
+            continue; // deleted since it was discovered
+        }
+        out.writeListSeparator();
+        out.put(id);
+        out.put(cobj->object()->typeId());
+    }
+    discoveredIds.clear();
+}
+
 /**
- * Search scannable buses for new objects and create them
- *
+ * Search scannable buses for new objects and create them.
+ * At most discoverStepsPerCommand candidates are examined before replying, so a large bus doesn't block the box.
+ * An unfinished search continues in the background, the next discover or read command reports what it finds.
+ * A search that is already running in the background is continued instead of restarted.
+ * Objects found by background discovery that were not read yet are included.
  */
-
 void
 Box::discoverNewObjects(DataIn& in, EncodedDataOut& out)
 {
@@ -583,26 +677,56 @@ Box::discoverNewObjects(DataIn& in, EncodedDataOut& out)
 
     out.write(asUint8(CboxError::OK));
 
-    for (auto& scanner : scanners) {
-        scanner->reset();
-        auto newId = obj_id_t(0);
-        do {
-            newId = scanner->scanAndAdd();
-            if (newId) {
-                auto cobj = objects.fetchContained(newId);
-
-                out.writeListSeparator();
-                out.put(newId);
-                if (cobj != nullptr) { // always true,  but just in case
-                    out.put(cobj->object()->typeId());
-                    auto storeContained = [&cobj](DataOut& out) -> CboxError {
-                        return cobj->streamPersistedTo(out);
-                    };
-                    storage.storeObject(newId, storeContained);
-                }
-            }
-        } while (newId);
+    if (!discoveryActive) {
+        restartDiscovery();
+    }
+    for (uint8_t i = 0; i < discoverStepsPerCommand && discoveryStep(); i++) {
+    }
+    writeDiscoveredObjects(out);
+}
+
+/**
+ * Start a search for new objects in the background.
+ * Each update examines a single candidate, so the box stays responsive on large buses.
+ * New objects are created as they are found and can be read with READ_DISCOVERED_OBJECTS.
+ */
+void
+Box::startDiscovery(DataIn& in, EncodedDataOut& out)
+{
+    in.spool();
+    auto crc = out.crc();
+
+    out.writeResponseSeparator();
+
+    if (crc) {
+        out.write(asUint8(CboxError::CRC_ERROR_IN_COMMAND));
+        return;
     }
+
+    restartDiscovery();
+    out.write(asUint8(CboxError::OK));
+}
+
+/**
+ * List the objects found by background discovery since the last read.
+ * The status is followed by a byte that is 1 while discovery is still in progress.
+ */
+void
+Box::readDiscoveredObjects(DataIn& in, EncodedDataOut& out)
+{
+    in.spool();
+    auto crc = out.crc();
+
+    out.writeResponseSeparator();
+
+    if (crc) {
+        out.write(asUint8(CboxError::CRC_ERROR_IN_COMMAND));
+        return;
+    }
+
+    out.write(asUint8(CboxError::OK));
+    out.write(uint8_t(discoveryActive));
+    writeDiscoveredObjects(out);
 }
 
 /*
@@ -663,6 +787,12 @@ Box::handleCommand(DataIn& dataIn, DataOut& dataOut)
         case DISCOVER_NEW_OBJECTS:
             discoverNewObjects(in, out);
             break;
+        case START_DISCOVERY:
+            startDiscovery(in, out);
+            break;
+        case READ_DISCOVERED_OBJECTS:
+            readDiscoveredObjects(in, out);
+            break;
         default:
             invalidCommand(in, out);
             break;
@@ -734,11 +864,13 @@ Box::setActiveGroupsAndUpdateObjects(const uint8_t newGroups)
             if (status != CboxError::OK) {
                 // TODO emit log event about reloading object from storage failing?
             }
+            notifyScanners(objId);
         }
 
         if (!shouldBeActive && objType != InactiveObject::staticTypeId()) {
             // replace object with inactive object
             objects.deactivate(cit);
+            notifyScanners(objId);
         }
     }
 }
@@ -790,6 +922,7 @@ Box::reloadStoredObject(const obj_id_t& id)
     if (!handlerCalled) {
         return CboxError::INVALID_OBJECT_ID; // write status if handler has not written it
     }
+    notifyScanners(id);
 
     return status;
 }
@@ -44,6 +44,12 @@ private:
     // Box receives commands from connections in the connection pool and streams back the answer to the same connection
     ConnectionPool& connections;
     std::vector<std::unique_ptr<ScanningFactory>> scanners;
+    // background discovery: the active scanner examines a candidate each update
+    size_t discoveryScanner = 0;
+    bool discoveryActive = false;
+    // the discover command examines at most this many candidates before replying, discovery continues in the background
+    static const uint8_t discoverStepsPerCommand = 16;
+    std::vector<obj_id_t> discoveredIds; // objects discovered since they were last reported
     uint8_t activeGroups = 0x81; // system group and first user group
     update_t lastUpdateTime = 0;
 
@@ -62,9 +68,14 @@ private:
     void factoryReset(DataIn& in, EncodedDataOut& out);
     void listCompatibleObjects(DataIn& in, EncodedDataOut& out);
     void discoverNewObjects(DataIn& in, EncodedDataOut& out);
+    void startDiscovery(DataIn& in, EncodedDataOut& out);
+    void readDiscoveredObjects(DataIn& in, EncodedDataOut& out);
 
     std::tuple<CboxError, std::shared_ptr<Object>, uint8_t> createObjectFromStream(DataIn& in);
     CboxError loadSingleObjectFromStorage(const storage_id_t& id, RegionDataIn& objInStorage);
+    void warnIfCyclic(const obj_id_t& id, EncodedDataOut& out);
+    void writeDiscoveredObjects(EncodedDataOut& out);
+    void notifyScanners(const obj_id_t& id);
 
 public:
     Box(const ObjectFactory& _factory,
@@ -101,8 +112,17 @@ public:
         lastUpdateTime = now;
         tracing::add(cbox::tracing::Action::UPDATE_OBJECTS);
         objects.update(now);
+        if (discoveryActive) {
+            discoveryStep();
+        }
     }
 
+    // Restart discovery of new objects from the first candidate of the first scanner
+    void restartDiscovery();
+
+    // Examine one candidate of the active scanner. Returns false when all scanners are done.
+    bool discoveryStep();
+
     void forcedUpdate(const update_t& now)
     {
         lastUpdateTime = now;
@@ -142,6 +162,8 @@ public:
         FACTORY_RESET = 10,           // erase all settings and reboot
         LIST_COMPATIBLE_OBJECTS = 11, // list object IDs implementing the requested interface
         DISCOVER_NEW_OBJECTS = 12,    // discover newly connected objects that support auto discovery
+        START_DISCOVERY = 13,         // start discovery of new objects in the background
+        READ_DISCOVERED_OBJECTS = 14, // list objects found by background discovery since the last read
     };
     // application can add additional commands, starting at 100.
 
@@ -61,6 +61,7 @@ enum class CboxError : uint8_t {
     OBJECT_DATA_NOT_ACCEPTED = 68,
 
     INVALID_OBJECT_PTR = 69,
+    CYCLIC_OBJECT_LINKS = 70,
 
     // freak events that should not be possible
     PERSISTING_TO_INACTIVE_OBJECT = 200,
@@ -45,6 +45,7 @@ public:
         if (newId != id) {
             id = std::move(newId);
             ptr.reset();
+            objects.linksChanged();
         }
     }
 
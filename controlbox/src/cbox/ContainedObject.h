@@ -93,6 +93,12 @@ public:
         }
     }
 
+    // make the object due for an update, for example because one of its inputs has new data
+    void scheduleUpdate(const update_t& now)
+    {
+        _nextUpdateTime = now;
+    }
+
     void forcedUpdate(const uint32_t& now)
     {
         if (_obj) {
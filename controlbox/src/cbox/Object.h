@@ -22,12 +22,25 @@
 #include "CboxError.h"
 #include "DataStream.h"
 #include "ObjectIds.h"
+#include <functional>
 #include <limits>
 
 namespace cbox {
 
 using update_t = uint32_t;
 
+/**
+ * Direction of data between an object and an object it refers to.
+ * INPUT: this object reads data from the linked object.
+ * OUTPUT: this object writes data to the linked object.
+ */
+enum class LinkType : uint8_t {
+    INPUT,
+    OUTPUT,
+};
+
+using LinkVisitor = std::function<void(const obj_id_t& id, const LinkType& type)>;
+
 class Object {
 public:
     Object() = default;
@@ -86,6 +99,44 @@ public:
      * @param iface: typeId of the interface requested
      */
     virtual void* implements(const obj_type_t& iface) = 0;
+
+    /**
+     * Objects that refer to other objects by id call the visitor for each link.
+     * The container uses these links to notify dependent objects when new data is available.
+     */
+    virtual void forEachLink(const LinkVisitor&) const
+    {
+    }
+
+    /**
+     * Called by the container when an object this object depends on has new data.
+     * The container schedules an update of this object right after the notification.
+     */
+    virtual void inputChanged()
+    {
+    }
+
+    /**
+     * Returns whether new data was produced for dependent objects since the last call and clears the flag.
+     */
+    bool takeChanged()
+    {
+        bool result = changed;
+        changed = false;
+        return result;
+    }
+
+protected:
+    /**
+     * Objects call this when they have new data for objects that depend on them.
+     */
+    void notifyChanged()
+    {
+        changed = true;
+    }
+
+private:
+    bool changed = false;
 };
 
 } // end namespace cbox
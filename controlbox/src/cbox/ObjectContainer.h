@@ -21,8 +21,10 @@
 
 #include "ContainedObject.h"
 #include "Object.h"
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <queue>
 #include <vector>
 
 namespace cbox {
@@ -32,6 +34,23 @@ private:
     std::vector<ContainedObject> objects;
     obj_id_t startId = obj_id_t::start();
 
+    // a link between two objects, data flows from source to dependent
+    struct Link {
+        obj_id_t source;
+        obj_id_t dependent;
+    };
+
+    struct SourceLess {
+        bool operator()(const Link& l, const obj_id_t& i) const { return l.source < i; }
+        bool operator()(const obj_id_t& i, const Link& l) const { return i < l.source; }
+        bool operator()(const Link& l1, const Link& l2) const { return l1.source < l2.source; }
+    };
+
+    std::vector<Link> links;           // sorted by source
+    std::vector<uint16_t> updateOrder; // object indices, sources before their dependents
+    std::vector<obj_id_t> cyclicIds;   // sorted ids of objects that are part of a link cycle
+    bool linksDirty = true;
+
 public:
     using Iterator = decltype(objects)::iterator;
     using CIterator = decltype(objects)::const_iterator;
@@ -74,6 +93,140 @@ private:
         return std::max(startId, objects.empty() ? startId : ++obj_id_t(objects.back().id()));
     }
 
+    // collect the links declared by all objects
+    void rebuildLinks()
+    {
+        links.clear();
+        for (auto& cobj : objects) {
+            if (auto& obj = cobj.object()) {
+                obj_id_t id = cobj.id();
+                obj->forEachLink([this, &id](const obj_id_t& other, const LinkType& type) {
+                    if (!other.isValid() || other == id) {
+                        return;
+                    }
+                    if (type == LinkType::INPUT) {
+                        links.push_back(Link{other, id});
+                    } else {
+                        links.push_back(Link{id, other});
+                    }
+                });
+            }
+        }
+        std::stable_sort(links.begin(), links.end(), SourceLess{});
+        rebuildUpdateOrder();
+        linksDirty = false;
+    }
+
+    // sort the objects topologically, so objects are updated after the objects they depend on.
+    // Without dependencies, objects keep their id order.
+    // Objects in a cycle cannot be ordered: they are recorded and updated last, in id order.
+    void rebuildUpdateOrder()
+    {
+        const uint16_t count = objects.size();
+        // links by object index, links to objects that do not exist are skipped.
+        // The edges are sorted by source, because the links are.
+        struct Edge {
+            uint16_t source;
+            uint16_t dependent;
+        };
+        std::vector<Edge> edges;
+        edges.reserve(links.size());
+        for (auto& link : links) {
+            auto s = findPosition(link.source);
+            auto d = findPosition(link.dependent);
+            if (s.first != s.second && d.first != d.second) {
+                edges.push_back(Edge{uint16_t(s.first - objects.begin()), uint16_t(d.first - objects.begin())});
+            }
+        }
+        auto firstEdgeFrom = [&edges](uint16_t source) {
+            return std::lower_bound(edges.cbegin(), edges.cend(), source, [](const Edge& e, const uint16_t& i) {
+                return e.source < i;
+            });
+        };
+
+        std::vector<uint16_t> inDegree(count, 0);
+        std::vector<uint16_t> outDegree(count, 0);
+        for (auto& e : edges) {
+            ++outDegree[e.source];
+            ++inDegree[e.dependent];
+        }
+
+        // Kahn's algorithm, always picking the lowest ready index to preserve id order
+        std::priority_queue<uint16_t, std::vector<uint16_t>, std::greater<uint16_t>> ready;
+        for (uint16_t i = 0; i < count; ++i) {
+            if (inDegree[i] == 0) {
+                ready.push(i);
+            }
+        }
+        std::vector<bool> ordered(count, false);
+        updateOrder.clear();
+        updateOrder.reserve(count);
+        while (!ready.empty()) {
+            auto i = ready.top();
+            ready.pop();
+            updateOrder.push_back(i);
+            ordered[i] = true;
+            for (auto it = firstEdgeFrom(i); it != edges.cend() && it->source == i; ++it) {
+                if (--inDegree[it->dependent] == 0) {
+                    ready.push(it->dependent);
+                }
+            }
+        }
+
+        cyclicIds.clear();
+        if (updateOrder.size() == count) {
+            return;
+        }
+
+        // The remaining objects are in a cycle or depend on one.
+        // Peel off the objects that have no remaining dependents to only keep the cycles.
+        // Edges from remaining objects never point to ordered objects, so their out degree is still accurate.
+        std::vector<bool> inCycle(count, false);
+        std::vector<uint16_t> peel;
+        for (uint16_t i = 0; i < count; ++i) {
+            if (!ordered[i]) {
+                inCycle[i] = true;
+                updateOrder.push_back(i);
+                if (outDegree[i] == 0) {
+                    peel.push_back(i);
+                }
+            }
+        }
+        while (!peel.empty()) {
+            auto i = peel.back();
+            peel.pop_back();
+            inCycle[i] = false;
+            for (auto& e : edges) {
+                if (e.dependent == i && inCycle[e.source] && --outDegree[e.source] == 0) {
+                    peel.push_back(e.source);
+                }
+            }
+        }
+        for (uint16_t i = 0; i < count; ++i) {
+            if (inCycle[i]) {
+                cyclicIds.push_back(objects[i].id());
+            }
+        }
+    }
+
+    // notify objects that depend on the given object and schedule them for an update
+    void notifyDependents(const ContainedObject& cobj, const update_t& now)
+    {
+        auto& obj = cobj.object();
+        if (!obj || !obj->takeChanged()) {
+            return;
+        }
+        auto range = std::equal_range(links.begin(), links.end(), cobj.id(), SourceLess{});
+        for (auto it = range.first; it != range.second; ++it) {
+            if (auto dependent = fetchContained(it->dependent)) {
+                if (auto& dependentObj = dependent->object()) {
+                    dependentObj->inputChanged();
+                }
+                dependent->scheduleUpdate(now);
+            }
+        }
+    }
+
 public:
     /**
      * finds the object entry with the given id.
@@ -108,6 +261,34 @@ public:
         startId = id;
     }
 
+    /**
+     * Mark the links between objects as changed, so they are collected again before the next update.
+     * Called when objects are added or removed and when an object changes which objects it refers to.
+     */
+    void linksChanged()
+    {
+        linksDirty = true;
+    }
+
+    /**
+     * Collect the links between objects and determine the update order, if the links have changed.
+     */
+    void refreshLinks()
+    {
+        if (linksDirty) {
+            rebuildLinks();
+        }
+    }
+
+    /**
+     * @return true if the object is part of a cycle of links, in which case it cannot be updated after all its inputs.
+     * Only valid after refreshLinks().
+     */
+    bool hasCyclicLinks(obj_id_t id) const
+    {
+        return std::binary_search(cyclicIds.cbegin(), cyclicIds.cend(), id);
+    }
+
     // create a new object and let box assign id
     obj_id_t add(std::shared_ptr<Object>&& obj, uint8_t active_in_groups)
     {
@@ -138,6 +319,7 @@ public:
             newId = id;
             position = p.first;
         }
+        linksChanged();
 
         if (replace) {
             *position = ContainedObject(newId, active_in_groups, std::move(obj));
@@ -155,6 +337,7 @@ public:
         }
         // find existing object
         auto p = findPosition(id);
+        linksChanged();
         objects.erase(p.first, p.second); // doesn't remove anything if no objects found (first == second)
         return p.first == p.second ? CboxError::INVALID_OBJECT_ID : CboxError::OK;
     }
@@ -180,6 +363,7 @@ public:
     {
         auto it = objects.erase(cit, cit); // convert to non-const iterator
         it->deactivate();
+        linksChanged();
     }
 
     // replace an object with an inactive object by id
@@ -188,6 +372,7 @@ public:
         auto p = findPosition(id);
         if (p.first != p.second) {
             p.first->deactivate();
+            linksChanged();
         }
     }
 
@@ -195,6 +380,7 @@ public:
     void clear()
     {
         objects.erase(userbegin(), cend());
+        linksChanged();
     }
 
     // remove all objects from the container
@@ -202,19 +388,27 @@ public:
     {
         objects.clear();
         objects.shrink_to_fit();
+        linksChanged();
     }
 
+    // update objects in topological order, so each object sees the data its inputs produced in the same pass
     void update(update_t now)
     {
-        for (auto& cobj : objects) {
+        refreshLinks();
+        for (auto i : updateOrder) {
+            auto& cobj = objects[i];
             cobj.update(now);
+            notifyDependents(cobj, now);
         }
     }
 
     void forcedUpdate(update_t now)
     {
-        for (auto& cobj : objects) {
+        refreshLinks();
+        for (auto i : updateOrder) {
+            auto& cobj = objects[i];
             cobj.forcedUpdate(now);
+            notifyDependents(cobj, now);
         }
     }
 };
@@ -28,7 +28,8 @@ namespace cbox {
 
 /**
  * A scanning factory has some kind of scan mechanism for new objects.
- * It has a reference to the object container to check if the new object already exists
+ * It has a reference to the object container to check if the new object already exists.
+ * A scan is done in steps that each examine a single candidate, so it can run in the background.
  */
 class ScanningFactory {
 protected:
@@ -41,16 +42,50 @@ public:
     }
     virtual ~ScanningFactory() = default;
 
+    // restart the scan from the first candidate
     virtual void reset() = 0;
-    virtual std::shared_ptr<Object> scan() = 0;
 
-    obj_id_t scanAndAdd()
+    // Called by the box when an object is added, written, replaced or removed. The object is nullptr when it was removed.
+    // A scanner that keeps an index of the existing objects updates it here, instead of walking the container.
+    virtual void objectChanged(const obj_id_t&, Object*)
+    {
+    }
+
+    // Examine the next candidate. Returns a new object if the candidate doesn't exist in the container yet.
+    // Sets done to true when all candidates have been examined.
+    virtual std::shared_ptr<Object> scanNext(bool& done) = 0;
+
+    // Examine candidates until a new object is found or the scan is complete
+    std::shared_ptr<Object> scan()
     {
-        if (auto newObj = scan()) {
+        bool done = false;
+        while (!done) {
+            if (auto newObj = scanNext(done)) {
+                return newObj;
+            }
+        }
+        return nullptr;
+    }
+
+    // Examine the next candidate and add it to the container if it is new. Returns the id of the new object or 0.
+    obj_id_t scanNextAndAdd(bool& done)
+    {
+        if (auto newObj = scanNext(done)) {
             return objectsRef.add(std::move(newObj), uint8_t(0x01)); // default to first profile
         }
         return 0;
     }
+
+    obj_id_t scanAndAdd()
+    {
+        bool done = false;
+        while (!done) {
+            if (auto id = scanNextAndAdd(done)) {
+                return id;
+            }
+        }
+        return 0;
+    }
 };
 
 } // end namespace cbox
@@ -41,6 +41,8 @@ namespace tracing {
         FACTORY_RESET = 10,           // erase all settings and reboot
         LIST_COMPATIBLE_OBJECTS = 11, // list object IDs implementing the requested interface
         DISCOVER_NEW_OBJECTS = 12,    // discover newly connected objects that support auto discovery
+        START_DISCOVERY = 13,         // start discovery of new objects in the background
+        READ_DISCOVERED_OBJECTS = 14, // list objects found by background discovery since the last read
 
         // object actions
         CONSTRUCT_OBJECT = 20,
@@ -40,6 +40,9 @@ SCENARIO("A controlbox Box")
          }},
         {NameableLongIntObject::staticTypeId(), std::make_shared<NameableLongIntObject>},
         {MockStreamObject::staticTypeId(), std::make_shared<MockStreamObject>},
+        {DataSink::staticTypeId(), [&container]() {
+             return std::make_shared<DataSink>(container);
+         }},
     };
 
     StringStreamConnectionSource connSource;
@@ -1340,6 +1343,85 @@ SCENARIO("A controlbox Box")
         clearStreams();
     }
 
+    WHEN("Device discovery is started in the background")
+    {
+        *in << "00000D"; // start discovery
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        expected << addCrc("00000D") << "|" << addCrc("00") << "\n";
+        CHECK(out->str() == expected.str());
+        clearStreams();
+
+        auto readDiscovered = [&]() {
+            clearStreams();
+            *in << "00000E"; // read discovered objects
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+            return out->str();
+        };
+
+        THEN("Nothing is discovered before the box is updated")
+        {
+            auto reply = readDiscovered();
+            expected << addCrc("00000E") << "|" << addCrc("0001") << "\n";
+            CHECK(reply == expected.str());
+        }
+
+        THEN("Each update examines a single candidate and new objects can be read when they are found")
+        {
+            box.update(1); // 0x11111111 exists
+            box.update(2); // 0x22222222 exists
+            box.update(3); // 0x33333333 is new
+
+            auto reply = readDiscovered();
+            expected << addCrc("00000E") << "|" << addCrc("0001")
+                     << "," << addCrc("6400E803") // new object id 100
+                     << "\n";
+            CHECK(reply == expected.str());
+
+            box.update(4); // 0x44444444 is new
+            box.update(5); // 0x55555555 is new
+            box.update(6); // scan complete
+
+            reply = readDiscovered();
+            expected << addCrc("00000E") << "|" << addCrc("0000")
+                     << "," << addCrc("6500E803") // new object id 101
+                     << "," << addCrc("6600E803") // new object id 102
+                     << "\n";
+            CHECK(reply == expected.str());
+
+            AND_THEN("The discovered objects are only reported once")
+            {
+                reply = readDiscovered();
+                expected << addCrc("00000E") << "|" << addCrc("0000") << "\n";
+                CHECK(reply == expected.str());
+            }
+        }
+
+        THEN("A discovery command continues the search that runs in the background and includes the objects it found")
+        {
+            box.update(1);
+            box.update(2);
+            box.update(3);
+
+            clearStreams();
+            *in << "00000C"; // discover new objects
+            *in << crc(in->str()) << "\n";
+            box.hexCommunicate();
+
+            expected << addCrc("00000C") << "|"
+                     << addCrc("00")              // status
+                     << "," << addCrc("6400E803") // new object id 100
+                     << "," << addCrc("6500E803") // new object id 101
+                     << "," << addCrc("6600E803") // new object id 102
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+
+        clearStreams();
+    }
+
     WHEN("The application implements a custom command")
     {
         *in << "000064"; // discover new objects
@@ -1408,4 +1490,45 @@ SCENARIO("A controlbox Box")
             CHECK(out->str() == expected.str());
         }
     }
+
+    WHEN("Objects are created that are linked in a cycle")
+    {
+        *in << "000003" // create object
+            << "6400"   // ID 100
+            << "7F"     // groups 7F
+            << "F003"   // type 1008 DataSink
+            << "6500";  // input 101
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        THEN("No error is reported while the cycle is not complete")
+        {
+            expected << addCrc("00000364007FF0036500") << "|"
+                     << addCrc("0064007FF0030000")
+                     << "\n";
+            CHECK(out->str() == expected.str());
+        }
+
+        clearStreams();
+
+        *in << "000003" // create object
+            << "6500"   // ID 101
+            << "7F"     // groups 7F
+            << "F003"   // type 1008 DataSink
+            << "6400";  // input 100
+        *in << crc(in->str()) << "\n";
+        box.hexCommunicate();
+
+        THEN("An error event annotation is inserted for the object that closes the cycle, but the object is created")
+        {
+            // the annotation is not part of the CRC, so the message is still valid
+            auto response = addCrc("0065007FF0030000");
+            response.insert(2, "<!CBOXERROR:46>");
+            expected << addCrc("00000365007FF0036400") << "|"
+                     << response
+                     << "\n";
+            CHECK(out->str() == expected.str());
+            CHECK(box.getObject(101).lock());
+        }
+    }
 }
@@ -30,28 +30,25 @@ public:
     {
         it = candidates.cbegin();
     };
-    virtual std::shared_ptr<Object> scan() override final
+    virtual std::shared_ptr<Object> scanNext(bool& done) override final
     {
-        while (it != candidates.cend()) {
-            bool found = false;
-            uint32_t value = *it;
-            ++it;
-            for (auto existing = objectsRef.cbegin(); existing != objectsRef.cend(); ++existing) {
-                LongIntObject* ptrIfCorrectType = reinterpret_cast<LongIntObject*>(existing->object()->implements(LongIntObject::staticTypeId()));
-                if (ptrIfCorrectType == nullptr) {
-                    continue; // not the right type, no match
-                }
-                if (ptrIfCorrectType->value() == value) {
-                    found = true; // object with value already exists
-                    break;
-                }
+        done = it == candidates.cend();
+        if (done) {
+            return nullptr;
+        }
+        uint32_t value = *it;
+        ++it;
+        for (auto existing = objectsRef.cbegin(); existing != objectsRef.cend(); ++existing) {
+            LongIntObject* ptrIfCorrectType = reinterpret_cast<LongIntObject*>(existing->object()->implements(LongIntObject::staticTypeId()));
+            if (ptrIfCorrectType == nullptr) {
+                continue; // not the right type, no match
             }
-            if (!found) {
-                // create new object
-                return std::make_shared<LongIntObject>(value);
+            if (ptrIfCorrectType->value() == value) {
+                return nullptr; // object with value already exists
             }
         }
-        return nullptr;
+        // create new object
+        return std::make_shared<LongIntObject>(value);
     };
 };
 
@@ -239,3 +239,113 @@ SCENARIO("A container with system objects passed in the initializer list")
         CHECK(obj_id_t(100) == objects.add(std::make_unique<LongIntObject>(0x33333333), 0xFF)); // will get start ID (100)
     }
 }
+
+SCENARIO("Objects linked to each other are notified when their input has new data")
+{
+    ObjectContainer container;
+
+    auto source = std::make_shared<DataSource>();
+    auto sinkAfter = std::make_shared<DataSink>(container, 2);
+    auto sinkBefore = std::make_shared<DataSink>(container, 2);
+    auto sinkUnlinked = std::make_shared<DataSink>(container);
+
+    container.add(std::shared_ptr<Object>(sinkBefore), 0xFF, 1);
+    container.add(std::shared_ptr<Object>(source), 0xFF, 2);
+    container.add(std::shared_ptr<Object>(sinkAfter), 0xFF, 3);
+    container.add(std::shared_ptr<Object>(sinkUnlinked), 0xFF, 4);
+
+    for (update_t now = 0; now <= 10000; now += 100) {
+        container.update(now);
+    }
+
+    THEN("Dependent objects are only updated when their input has new data")
+    {
+        CHECK(source->count() == 11);
+        CHECK(sinkAfter->notifications() == 11);
+        CHECK(sinkAfter->updates() == 11); // first notification coincides with the initial update
+        CHECK(sinkBefore->notifications() == 11);
+        CHECK(sinkBefore->updates() == 11);
+        CHECK(sinkUnlinked->notifications() == 0);
+        CHECK(sinkUnlinked->updates() == 1);
+    }
+
+    THEN("Objects are updated after their input, regardless of their id, and see the new data in the same update")
+    {
+        CHECK(sinkAfter->lastSeen() == 11);
+        CHECK(sinkBefore->lastSeen() == 11);
+    }
+
+    WHEN("An object changes its input, the links are updated")
+    {
+        sinkUnlinked->inputId(2);
+        sinkAfter->inputId(0);
+        container.update(11000);
+
+        CHECK(sinkUnlinked->notifications() == 1);
+        CHECK(sinkUnlinked->lastSeen() == 12);
+        CHECK(sinkAfter->notifications() == 11);
+    }
+
+    WHEN("The input is removed, the dependent object is no longer notified")
+    {
+        container.remove(2);
+        container.update(11000);
+        CHECK(sinkAfter->notifications() == 11);
+    }
+}
+
+SCENARIO("Objects that are linked in a cycle are detected")
+{
+    ObjectContainer container;
+
+    auto source = std::make_shared<DataSource>();
+    auto sink1 = std::make_shared<DataSink>(container, 3);
+    auto sink2 = std::make_shared<DataSink>(container, 4);
+    auto sink3 = std::make_shared<DataSink>(container, 2);
+    auto sinkBehindCycle = std::make_shared<DataSink>(container, 2);
+
+    container.add(std::shared_ptr<Object>(sinkBehindCycle), 0xFF, 1);
+    container.add(std::shared_ptr<Object>(sink1), 0xFF, 2);
+    container.add(std::shared_ptr<Object>(sink2), 0xFF, 3);
+    container.add(std::shared_ptr<Object>(sink3), 0xFF, 4);
+    container.add(std::shared_ptr<Object>(source), 0xFF, 5);
+
+    container.refreshLinks();
+
+    THEN("Only the objects in the cycle are reported")
+    {
+        CHECK(container.hasCyclicLinks(2));
+        CHECK(container.hasCyclicLinks(3));
+        CHECK(container.hasCyclicLinks(4));
+        CHECK_FALSE(container.hasCyclicLinks(1));
+        CHECK_FALSE(container.hasCyclicLinks(5));
+    }
+
+    THEN("All objects are still updated")
+    {
+        container.update(0);
+        CHECK(source->count() == 1);
+        CHECK(sink1->updates() == 1);
+        CHECK(sink2->updates() == 1);
+        CHECK(sink3->updates() == 1);
+        CHECK(sinkBehindCycle->updates() == 1);
+    }
+
+    WHEN("The cycle is broken, the objects are no longer reported after the links are refreshed")
+    {
+        sink3->inputId(5);
+        CHECK(container.hasCyclicLinks(2)); // not recalculated yet
+        container.refreshLinks();
+        CHECK_FALSE(container.hasCyclicLinks(2));
+        CHECK_FALSE(container.hasCyclicLinks(3));
+        CHECK_FALSE(container.hasCyclicLinks(4));
+
+        THEN("The chain is updated in order in a single pass")
+        {
+            container.update(0);
+            container.update(1000);
+            CHECK(source->count() == 2);
+            CHECK(sink3->lastSeen() == 2);
+        }
+    }
+}
@@ -371,4 +371,119 @@ public:
     {
         return cbox::Object::update_never(now);
     }
-};
\ No newline at end of file
+};
+
+/**
+ * An object that produces new data on each update and notifies the objects that depend on it
+ */
+class DataSource : public cbox::ObjectBase<1007> {
+private:
+    uint16_t _count = 0;
+
+public:
+    DataSource() = default;
+    virtual ~DataSource() = default;
+
+    uint16_t count() const
+    {
+        return _count;
+    }
+
+    virtual cbox::CboxError streamTo(cbox::DataOut& out) const override final
+    {
+        return out.put(_count) ? cbox::CboxError::OK : cbox::CboxError::OUTPUT_STREAM_WRITE_ERROR;
+    }
+
+    virtual cbox::CboxError streamFrom(cbox::DataIn&) override final
+    {
+        return cbox::CboxError::OK;
+    }
+
+    virtual cbox::CboxError streamPersistedTo(cbox::DataOut&) const override final
+    {
+        return cbox::CboxError::OK;
+    }
+
+    virtual cbox::update_t update(const cbox::update_t& now) override final
+    {
+        ++_count;
+        notifyChanged();
+        return now + 1000;
+    }
+};
+
+/**
+ * An object that reads the count of a DataSource and only updates when the source has new data
+ */
+class DataSink : public cbox::ObjectBase<1008> {
+private:
+    cbox::CboxPtr<DataSource> input;
+    uint16_t _notifications = 0;
+    uint16_t _updates = 0;
+    uint16_t _lastSeen = 0;
+
+public:
+    DataSink(cbox::ObjectContainer& objects, const cbox::obj_id_t& inputId = 0)
+        : input(objects, inputId)
+    {
+    }
+    virtual ~DataSink() = default;
+
+    uint16_t notifications() const
+    {
+        return _notifications;
+    }
+
+    uint16_t updates() const
+    {
+        return _updates;
+    }
+
+    uint16_t lastSeen() const
+    {
+        return _lastSeen;
+    }
+
+    void inputId(const cbox::obj_id_t& id)
+    {
+        input.setId(id);
+    }
+
+    virtual cbox::CboxError streamTo(cbox::DataOut& out) const override final
+    {
+        return out.put(_lastSeen) ? cbox::CboxError::OK : cbox::CboxError::OUTPUT_STREAM_WRITE_ERROR;
+    }
+
+    virtual cbox::CboxError streamFrom(cbox::DataIn& in) override final
+    {
+        cbox::obj_id_t newId;
+        if (in.get(newId)) {
+            input.setId(newId);
+        }
+        return cbox::CboxError::OK;
+    }
+
+    virtual cbox::CboxError streamPersistedTo(cbox::DataOut&) const override final
+    {
+        return cbox::CboxError::OK;
+    }
+
+    virtual void forEachLink(const cbox::LinkVisitor& visit) const override final
+    {
+        visit(input.getId(), cbox::LinkType::INPUT);
+    }
+
+    virtual void inputChanged() override final
+    {
+        ++_notifications;
+    }
+
+    virtual cbox::update_t update(const cbox::update_t& now) override final
+    {
+        ++_updates;
+        if (auto source = input.lock()) {
+            _lastSeen = source->count();
+        }
+        return update_never(now);
+    }
+};
@@ -20,10 +20,13 @@
 #pragma once
 
 #include "ActuatorDigitalBase.h"
+#include "StateHistory.h"
 #include "TicksTypes.h"
 #include <array>
+#include <memory>
 /*
  * An ActuatorDigitalBase wrapper that logs the most recent changes
+ * Optionally, a longer history is kept for statistics like the number of switches per hour
  */
 
 class ActuatorDigitalChangeLogged {
@@ -38,6 +41,7 @@ public:
 private:
     ActuatorDigitalBase& actuator;
     std::array<StateChange, 5> history; // uneven length makes last entry equal to first for toggling (PWM) behavior
+    std::unique_ptr<StateHistory> longHistory;
 
 protected:
     ticks_millis_t lastUpdateTime = 0;
@@ -81,5 +85,21 @@ public:
 
     void resetHistory();
 
+    // The long history is kept in RAM, which limits its size
+    static constexpr uint16_t maxStateHistorySize = 1024;
+
+    // Keep a longer history of changes with the given size in bytes, 0 disables it.
+    // Changing the size clears the long history. Returns false and changes nothing above maxStateHistorySize.
+    bool stateHistorySize(uint16_t bytes);
+
+    // size in bytes of the long history, 0 when disabled
+    uint16_t stateHistorySize() const;
+
+    // the long history, nullptr when disabled
+    const StateHistory* stateHistory() const
+    {
+        return longHistory.get();
+    }
+
     bool supportsFastIo() const;
 };
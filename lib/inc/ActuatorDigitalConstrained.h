@@ -20,466 +20,712 @@
 #pragma once
 
 #include "ActuatorDigitalChangeLogged.h"
+#include "MutexTarget.h"
 #include "TicksTypes.h"
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <memory>
-#include <mutex>
-#include <vector>
+#include <new>
 
-class ActuatorDigitalConstrained;
 namespace ADConstraints {
 using State = ActuatorDigitalBase::State;
 
-class Base {
+class MinOnTime {
+private:
+    duration_millis_t m_limit;
+
 public:
-    Base() = default;
-    virtual ~Base() = default;
+    explicit MinOnTime(const duration_millis_t& min)
+        : m_limit(min)
+    {
+    }
 
-    virtual duration_millis_t allowedImpl(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act) = 0;
+    duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act)
+    {
+        if (act.state() != State::Active) {
+            return 0;
+        }
+        if (newState == State::Active) {
+            return 0;
+        }
+        auto times = act.getLastStartEndTime(State::Active, now);
+        auto elapsedOn = times.end - times.start;
 
-    virtual uint8_t id() const = 0;
+        if (elapsedOn >= m_limit) {
+            return 0;
+        }
 
-    virtual uint8_t order() const = 0;
+        return m_limit - elapsedOn;
+    }
 
-    void timeRemaining(duration_millis_t v)
+    duration_millis_t limit() const
     {
-        m_timeRemaining = v;
+        return m_limit;
     }
+};
 
-    duration_millis_t timeRemaining() const
+class MinOffTime {
+private:
+    duration_millis_t m_limit;
+
+public:
+    explicit MinOffTime(const duration_millis_t& min)
+        : m_limit(min)
     {
-        return m_timeRemaining;
     }
 
     duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act)
     {
-        m_timeRemaining = allowedImpl(newState, now, act);
-        return m_timeRemaining;
+        if (act.state() != State::Inactive) {
+            return 0;
+        }
+
+        if (newState == State::Inactive) {
+            return 0;
+        }
+
+        auto times = act.getLastStartEndTime(State::Inactive, now);
+        auto elapsedOff = times.end - times.start;
+
+        if (elapsedOff >= m_limit) {
+            return 0;
+        }
+
+        return m_limit - elapsedOff;
     }
 
-private:
-    duration_millis_t m_timeRemaining = 0;
+    duration_millis_t limit() const
+    {
+        return m_limit;
+    }
 };
-} // end namespace ADConstraints
-
-class ActuatorDigitalConstrained : private ActuatorDigitalChangeLogged {
-public:
-    using Constraint = ADConstraints::Base;
 
+class DelayedOn {
 private:
-    std::vector<std::unique_ptr<Constraint>> constraints;
-    State m_desiredState = State::Inactive;
+    duration_millis_t m_limit;
+    ticks_millis_t m_time_requested = 0;
 
 public:
-    ActuatorDigitalConstrained(ActuatorDigitalBase& act)
-        : ActuatorDigitalChangeLogged(act)
+    explicit DelayedOn(const duration_millis_t& delay)
+        : m_limit(delay)
     {
     }
 
-    ActuatorDigitalConstrained(const ActuatorDigitalConstrained&) = delete;
-    ActuatorDigitalConstrained& operator=(const ActuatorDigitalConstrained&) = delete;
-    ActuatorDigitalConstrained& operator=(ActuatorDigitalConstrained&&) = delete;
-    ActuatorDigitalConstrained(ActuatorDigitalConstrained&&) = default;
+    duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged&)
+    {
+        if (newState == State::Active) {
+            if (m_time_requested == 0) {
+                m_time_requested = now != 0 ? now : -1;
+            }
+            auto elapsed = now - m_time_requested;
+            auto wait = (m_limit > elapsed) ? m_limit - elapsed : 0;
+            return wait;
+        }
 
-    virtual ~ActuatorDigitalConstrained() = default;
+        m_time_requested = 0;
+        return 0;
+    }
 
-    // ActuatorDigitalChangeLogged is inherited privately to prevent bypassing constraints.
-    // explicitly make functions available that should be in public interface here.
-    using ActuatorDigitalChangeLogged::activeDurations;
-    using ActuatorDigitalChangeLogged::getLastStartEndTime;
-    using ActuatorDigitalChangeLogged::setStateUnlogged;
-    using ActuatorDigitalChangeLogged::supportsFastIo;
+    duration_millis_t limit() const
+    {
+        return m_limit;
+    }
+};
+
+class DelayedOff {
+private:
+    duration_millis_t m_limit;
+    ticks_millis_t m_time_requested = 0;
+
+public:
+    explicit DelayedOff(const duration_millis_t& delay)
+        : m_limit(delay)
+    {
+    }
 
-    void addConstraint(std::unique_ptr<Constraint>&& newConstraint)
+    duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged&)
     {
-        if (constraints.size() < 8) {
-            constraints.push_back(std::move(newConstraint));
+        if (newState == State::Inactive) {
+            if (m_time_requested == 0) {
+                m_time_requested = now != 0 ? now : -1;
+            }
+            auto elapsed = now - m_time_requested;
+            auto wait = (m_limit > elapsed) ? m_limit - elapsed : 0;
+            return wait;
         }
-        std::sort(constraints.begin(), constraints.end(),
-                  [](const std::unique_ptr<Constraint>& a, const std::unique_ptr<Constraint>& b) { return a->order() < b->order(); });
+
+        m_time_requested = 0;
+        return 0;
     }
 
-    // remove all constraints and return vector of removed constraints
-    auto removeAllConstraints()
+    duration_millis_t limit() const
     {
-        auto oldConstraints = std::move(constraints);
-        constraints = std::vector<std::unique_ptr<Constraint>>();
-        return oldConstraints;
+        return m_limit;
     }
+};
 
-    void resetHistory()
+/*
+ * Only allows the actuator to turn on when it owns the mutex target.
+ * It never blocks: an actuator that has to wait is told how long, and queued at the target.
+ * allowedFromIsr() is called by the timer interrupt of a fast PWM, all other functions from the main loop.
+ */
+class Mutex {
+private:
+    std::function<std::shared_ptr<MutexTarget>()> m_mutexTarget;
+    duration_millis_t m_holdAfterTurnOff;
+    bool m_useCustomHoldDuration;
+    uint16_t m_targetId; // identifies the mutex target for the owner, the constraint does not use it
+    MutexTarget::Token m_token;
+    duration_millis_t m_waited = 0;
+    // keep shared pointer to mutex while owning or waiting for it, so it cannot be destroyed
+    std::shared_ptr<MutexTarget> m_target;
+    // The same target for interrupt context. It is cleared before the shared pointer is released,
+    // so an interrupt never sees a target that was destroyed.
+    std::atomic<MutexTarget*> m_isrTarget{nullptr};
+
+public:
+    explicit Mutex(
+        std::function<std::shared_ptr<MutexTarget>()>&& mut, duration_millis_t hold, bool useCustomHold, uint16_t targetId = 0)
+        : m_mutexTarget(std::move(mut))
+        , m_holdAfterTurnOff(hold)
+        , m_useCustomHoldDuration(useCustomHold)
+        , m_targetId(targetId)
+        , m_token(MutexTarget::newToken())
     {
-        ActuatorDigitalChangeLogged::resetHistory();
     }
+    Mutex(Mutex&& other)
+        : m_mutexTarget(std::move(other.m_mutexTarget))
+        , m_holdAfterTurnOff(other.m_holdAfterTurnOff)
+        , m_useCustomHoldDuration(other.m_useCustomHoldDuration)
+        , m_targetId(other.m_targetId)
+        , m_token(other.m_token)
+        , m_waited(other.m_waited)
+        , m_target(std::move(other.m_target))
+        , m_isrTarget(other.m_isrTarget.exchange(nullptr))
+    {
+        other.m_token = 0; // the token moves with the constraint, it is released once
+    }
+    Mutex& operator=(Mutex&&) = delete;
 
-    duration_millis_t checkConstraints(const State& val, const ticks_millis_t& now)
+    ~Mutex()
     {
-        for (auto& c : constraints) {
-            auto remaining = c->allowed(val, now, *this);
-            if (remaining > 0) {
-                return remaining;
+        if (m_target) {
+            m_target->abandon(m_token);
+        }
+        if (m_token) {
+            MutexTarget::releaseToken(m_token);
+        }
+    }
+
+    duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act)
+    {
+        if (newState == State::Active) {
+            if (!m_target || !(m_target->ownedBy(m_token) && (m_target->held() || m_target->reservedBy(m_token, now)))) {
+                // look up the target again, unless the actuator is the owner or within its hold time
+                target(m_mutexTarget());
+                if (!m_target) {
+                    return 1000;
+                }
+            }
+            auto remaining = m_target->tryAcquire(m_token, hold(), now);
+            m_waited = remaining > 0 ? m_target->waitedBy(m_token, now) : 0;
+            return remaining;
+        }
+
+        m_waited = 0;
+        if (!m_target) {
+            return 0;
+        }
+        if (m_target->held() && m_target->ownedBy(m_token)) {
+            // the hold time starts when the actuator turned off
+            duration_millis_t elapsedOff = 0;
+            if (act.state() == State::Inactive) {
+                auto times = act.getLastStartEndTime(State::Inactive, now);
+                elapsedOff = times.end - times.start;
             }
+            m_target->release(m_token, now - elapsedOff, now);
+        } else {
+            m_target->release(m_token, now, now); // give up a place in the queue
+        }
+        if (!m_target->reservedBy(m_token, now)) {
+            target(nullptr);
         }
         return 0;
     }
 
-    duration_millis_t desiredState(const State& val, const ticks_millis_t& now)
+    // Called from interrupt context when the actuator is switched on without checking the constraints.
+    // It may only turn on while it still owns the mutex, which it acquires in the main loop.
+    bool allowedFromIsr()
     {
-        lastUpdateTime = now; // always update fallback time for state setter without time
-        m_desiredState = val;
-        auto timeRemaining = checkConstraints(val, now);
-        if (timeRemaining == 0) {
-            ActuatorDigitalChangeLogged::state(val, now);
-        }
-        return timeRemaining;
+        auto t = m_isrTarget.load();
+        return t && t->holdFromIsr(m_token);
     }
 
-    duration_millis_t desiredState(const State& val)
+    auto holdAfterTurnOff() const
     {
-        return desiredState(val, lastUpdateTime);
+        return m_holdAfterTurnOff;
     }
 
-    State state() const
+    void holdAfterTurnOff(duration_millis_t v)
     {
-        return ActuatorDigitalChangeLogged::state();
+        m_holdAfterTurnOff = v;
     }
 
-    void setStateUnlogged(const State& val)
+    bool useCustomHoldDuration() const
     {
-        m_desiredState = val;
-        ActuatorDigitalChangeLogged::state(val);
+        return m_useCustomHoldDuration;
     }
 
-    ticks_millis_t update(ticks_millis_t now)
+    void useCustomHoldDuration(bool v)
     {
-        // re-apply constraints for new update time
-        auto remaining = desiredState(m_desiredState, now);
-        // update at least once per second
-        return (remaining < 1000) ? now + remaining : now + 1000;
+        m_useCustomHoldDuration = v;
     }
 
-    State
-    desiredState() const
+    uint16_t targetId() const
     {
-        return m_desiredState;
+        return m_targetId;
     }
 
-    const auto&
-    constraintsList() const
+    // true while the actuator is active with the mutex, or within its hold time after turning off.
+    // The hold time is checked against the deadline as of the last update of the target.
+    bool hasLock() const
     {
-        return constraints;
+        return m_target && m_target->ownedBy(m_token) && (m_target->held() || m_target->timeRemaining() > 0);
+    }
+
+    // time that the actuator has been waiting for the mutex, as of the last check
+    duration_millis_t waited() const
+    {
+        return m_waited;
+    }
+
+private:
+    duration_millis_t hold() const
+    {
+        return m_useCustomHoldDuration ? m_holdAfterTurnOff : m_target->holdAfterTurnOff();
+    }
+
+    void target(std::shared_ptr<MutexTarget>&& newTarget)
+    {
+        m_isrTarget.store(nullptr);
+        m_target = std::move(newTarget);
+        m_isrTarget.store(m_target.get());
     }
 };
 
-class MutexTarget {
+/*
+ * One constraint of any kind, stored inline instead of behind a pointer to a virtual base.
+ * The kinds are numbered in the order in which the constraints are checked.
+ */
+class Constraint {
 public:
-    MutexTarget() = default;
-    ~MutexTarget() = default;
-    std::mutex mut;
+    enum class Kind : uint8_t {
+        MIN_OFF,
+        MIN_ON,
+        DELAYED_ON,
+        DELAYED_OFF,
+        MUTEX,
+        NONE,
+    };
 
-    duration_millis_t holdAfterTurnOff() const
+    Constraint()
+        : m_kind(Kind::NONE)
     {
-        return m_holdAfterTurnOff;
     }
 
-    void holdAfterTurnOff(duration_millis_t v)
+    Constraint(MinOffTime&& c)
+        : m_kind(Kind::MIN_OFF)
     {
-        m_holdAfterTurnOff = v;
+        new (&m_minOff) MinOffTime(std::move(c));
     }
 
-    void timeRemaining(duration_millis_t v)
+    Constraint(MinOnTime&& c)
+        : m_kind(Kind::MIN_ON)
     {
-        m_timeRemaining = v;
+        new (&m_minOn) MinOnTime(std::move(c));
     }
 
-    duration_millis_t timeRemaining() const
+    Constraint(DelayedOn&& c)
+        : m_kind(Kind::DELAYED_ON)
     {
-        return m_timeRemaining;
+        new (&m_delayedOn) DelayedOn(std::move(c));
     }
 
-private:
-    duration_millis_t m_timeRemaining = 0;
-    duration_millis_t m_holdAfterTurnOff = 0;
-};
+    Constraint(DelayedOff&& c)
+        : m_kind(Kind::DELAYED_OFF)
+    {
+        new (&m_delayedOff) DelayedOff(std::move(c));
+    }
 
-namespace ADConstraints {
-template <uint8_t ID>
-class MinOnTime : public Base {
-private:
-    duration_millis_t m_limit;
+    Constraint(Mutex&& c)
+        : m_kind(Kind::MUTEX)
+    {
+        new (&m_mutex) Mutex(std::move(c));
+    }
 
-public:
-    MinOnTime(const duration_millis_t& min)
-        : m_limit(min)
+    Constraint(Constraint&& other)
+        : m_kind(Kind::NONE)
     {
+        moveFrom(std::move(other));
     }
 
-    duration_millis_t allowedImpl(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act) override final
+    Constraint& operator=(Constraint&& other)
     {
-        if (act.state() != State::Active) {
-            return 0;
-        }
-        if (newState == State::Active) {
-            return 0;
+        if (this != &other) {
+            destroy();
+            moveFrom(std::move(other));
         }
-        auto times = act.getLastStartEndTime(State::Active, now);
-        auto elapsedOn = times.end - times.start;
+        return *this;
+    }
 
-        if (elapsedOn >= m_limit) {
-            return 0;
-        }
+    Constraint(const Constraint&) = delete;
+    Constraint& operator=(const Constraint&) = delete;
 
-        return m_limit - elapsedOn;
+    ~Constraint()
+    {
+        destroy();
     }
 
-    virtual uint8_t id() const override final
+    Kind kind() const
     {
-        return ID;
+        return m_kind;
     }
 
-    duration_millis_t limit()
+    uint8_t order() const
     {
-        return m_limit;
+        return uint8_t(m_kind);
     }
 
-    virtual uint8_t order() const override final
+    duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act)
     {
-        return 1;
+        switch (m_kind) {
+        case Kind::MIN_OFF:
+            m_timeRemaining = m_minOff.allowed(newState, now, act);
+            break;
+        case Kind::MIN_ON:
+            m_timeRemaining = m_minOn.allowed(newState, now, act);
+            break;
+        case Kind::DELAYED_ON:
+            m_timeRemaining = m_delayedOn.allowed(newState, now, act);
+            break;
+        case Kind::DELAYED_OFF:
+            m_timeRemaining = m_delayedOff.allowed(newState, now, act);
+            break;
+        case Kind::MUTEX:
+            m_timeRemaining = m_mutex.allowed(newState, now, act);
+            break;
+        case Kind::NONE:
+            m_timeRemaining = 0;
+            break;
+        }
+        return m_timeRemaining;
     }
-};
-
-template <uint8_t ID>
-class MinOffTime : public Base {
-private:
-    duration_millis_t m_limit;
 
-public:
-    MinOffTime(const duration_millis_t& min)
-        : m_limit(min)
+    duration_millis_t timeRemaining() const
     {
+        return m_timeRemaining;
     }
 
-    virtual duration_millis_t allowedImpl(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act) override final
+    // access to the stored constraint, nullptr if it is of another kind
+    const MinOffTime* minOff() const
     {
-        if (act.state() != State::Inactive) {
-            return 0;
-        }
-
-        if (newState == State::Inactive) {
-            return 0;
-        }
+        return m_kind == Kind::MIN_OFF ? &m_minOff : nullptr;
+    }
 
-        auto times = act.getLastStartEndTime(State::Inactive, now);
-        auto elapsedOff = times.end - times.start;
+    const MinOnTime* minOn() const
+    {
+        return m_kind == Kind::MIN_ON ? &m_minOn : nullptr;
+    }
 
-        if (elapsedOff >= m_limit) {
-            return 0;
-        }
+    const DelayedOn* delayedOn() const
+    {
+        return m_kind == Kind::DELAYED_ON ? &m_delayedOn : nullptr;
+    }
 
-        return m_limit - elapsedOff;
+    const DelayedOff* delayedOff() const
+    {
+        return m_kind == Kind::DELAYED_OFF ? &m_delayedOff : nullptr;
     }
 
-    virtual uint8_t id() const override final
+    const Mutex* mutex() const
     {
-        return ID;
+        return m_kind == Kind::MUTEX ? &m_mutex : nullptr;
     }
 
-    duration_millis_t limit()
+    Mutex* mutex()
     {
-        return m_limit;
+        return m_kind == Kind::MUTEX ? &m_mutex : nullptr;
+    }
+
+private:
+    Kind m_kind;
+    duration_millis_t m_timeRemaining = 0;
+    union {
+        MinOffTime m_minOff;
+        MinOnTime m_minOn;
+        DelayedOn m_delayedOn;
+        DelayedOff m_delayedOff;
+        Mutex m_mutex;
+    };
+
+    void moveFrom(Constraint&& other)
+    {
+        m_timeRemaining = other.m_timeRemaining;
+        switch (other.m_kind) {
+        case Kind::MIN_OFF:
+            new (&m_minOff) MinOffTime(std::move(other.m_minOff));
+            break;
+        case Kind::MIN_ON:
+            new (&m_minOn) MinOnTime(std::move(other.m_minOn));
+            break;
+        case Kind::DELAYED_ON:
+            new (&m_delayedOn) DelayedOn(std::move(other.m_delayedOn));
+            break;
+        case Kind::DELAYED_OFF:
+            new (&m_delayedOff) DelayedOff(std::move(other.m_delayedOff));
+            break;
+        case Kind::MUTEX:
+            new (&m_mutex) Mutex(std::move(other.m_mutex));
+            break;
+        case Kind::NONE:
+            break;
+        }
+        m_kind = other.m_kind;
+        other.destroy(); // leave the moved-from constraint empty
     }
 
-    virtual uint8_t order() const override final
+    void destroy()
     {
-        return 0;
+        // the other kinds are trivially destructible
+        if (m_kind == Kind::MUTEX) {
+            m_mutex.~Mutex();
+        }
+        m_kind = Kind::NONE;
     }
 };
 
-template <uint8_t ID>
-class DelayedOn : public Base {
+/*
+ * A fixed number of constraints, stored inline and kept sorted by the order in which they are checked.
+ */
+class ConstraintSet {
 private:
-    duration_millis_t m_limit;
-    ticks_millis_t m_time_requested = 0;
+    std::array<Constraint, 8> m_constraints;
+    uint8_t m_size = 0;
 
 public:
-    DelayedOn(const duration_millis_t& delay)
-        : m_limit(delay)
+    ConstraintSet() = default;
+    ConstraintSet(ConstraintSet&& other)
+        : m_constraints(std::move(other.m_constraints))
+        , m_size(other.m_size)
+    {
+        other.clear();
+    }
+    ConstraintSet& operator=(ConstraintSet&& other)
     {
+        if (this != &other) {
+            m_constraints = std::move(other.m_constraints);
+            m_size = other.m_size;
+            other.clear();
+        }
+        return *this;
     }
+    ~ConstraintSet() = default;
 
-    duration_millis_t allowedImpl(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged&) override final
+    // returns false when the set is full
+    bool add(Constraint&& c)
     {
-        if (newState == State::Active) {
-            if (m_time_requested == 0) {
-                m_time_requested = now != 0 ? now : -1;
-            }
-            auto elapsed = now - m_time_requested;
-            auto wait = (m_limit > elapsed) ? m_limit - elapsed : 0;
-            return wait;
+        if (m_size == m_constraints.size()) {
+            return false;
         }
+        // insert after the constraints with the same order, to keep the order in which they were added
+        auto pos = std::upper_bound(begin(), end(), c, [](const Constraint& a, const Constraint& b) {
+            return a.order() < b.order();
+        });
+        std::move_backward(pos, end(), end() + 1);
+        *pos = std::move(c);
+        ++m_size;
+        return true;
+    }
 
-        m_time_requested = 0;
-        return 0;
+    void clear()
+    {
+        for (auto& c : *this) {
+            c = Constraint();
+        }
+        m_size = 0;
     }
 
-    virtual uint8_t id() const override final
+    Constraint* begin()
     {
-        return ID;
+        return m_constraints.data();
     }
 
-    duration_millis_t limit()
+    Constraint* end()
     {
-        return m_limit;
+        return m_constraints.data() + m_size;
     }
 
-    virtual uint8_t order() const override final
+    const Constraint* begin() const
     {
-        return 2;
+        return m_constraints.data();
     }
-};
 
-template <uint8_t ID>
-class DelayedOff : public Base {
-private:
-    duration_millis_t m_limit;
-    ticks_millis_t m_time_requested = 0;
+    const Constraint* end() const
+    {
+        return m_constraints.data() + m_size;
+    }
 
-public:
-    DelayedOff(const duration_millis_t& delay)
-        : m_limit(delay)
+    uint8_t size() const
     {
+        return m_size;
     }
 
-    duration_millis_t allowedImpl(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged&) override final
+    bool empty() const
     {
-        if (newState == State::Inactive) {
-            if (m_time_requested == 0) {
-                m_time_requested = now != 0 ? now : -1;
+        return m_size == 0;
+    }
+
+    // time until the first constraint that blocks the new state allows it, 0 if all allow it
+    duration_millis_t allowed(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act)
+    {
+        for (auto& c : *this) {
+            auto remaining = c.allowed(newState, now, act);
+            if (remaining > 0) {
+                return remaining;
             }
-            auto elapsed = now - m_time_requested;
-            auto wait = (m_limit > elapsed) ? m_limit - elapsed : 0;
-            return wait;
         }
-
-        m_time_requested = 0;
         return 0;
     }
 
-    virtual uint8_t id() const override final
+    // Whether an actuator can turn on from interrupt context. Only the mutexes are checked,
+    // because the interrupt switches a fast PWM on and off within the time limits of the other constraints.
+    bool allowedFromIsr()
     {
-        return ID;
+        for (auto& c : *this) {
+            if (auto m = c.mutex()) {
+                if (!m->allowedFromIsr()) {
+                    return false;
+                }
+            }
+        }
+        return true;
     }
+};
+} // end namespace ADConstraints
 
-    duration_millis_t limit()
+class ActuatorDigitalConstrained : private ActuatorDigitalChangeLogged {
+public:
+    using Constraint = ADConstraints::Constraint;
+    using ConstraintSet = ADConstraints::ConstraintSet;
+
+private:
+    ConstraintSet constraints;
+    State m_desiredState = State::Inactive;
+    // The constraints are not checked again while the state equals the desired state they allowed
+    bool m_stable = false;
+
+public:
+    ActuatorDigitalConstrained(ActuatorDigitalBase& act)
+        : ActuatorDigitalChangeLogged(act)
     {
-        return m_limit;
     }
 
-    virtual uint8_t order() const override final
+    ActuatorDigitalConstrained(const ActuatorDigitalConstrained&) = delete;
+    ActuatorDigitalConstrained& operator=(const ActuatorDigitalConstrained&) = delete;
+    ActuatorDigitalConstrained& operator=(ActuatorDigitalConstrained&&) = delete;
+    ActuatorDigitalConstrained(ActuatorDigitalConstrained&&) = default;
+
+    virtual ~ActuatorDigitalConstrained() = default;
+
+    // ActuatorDigitalChangeLogged is inherited privately to prevent bypassing constraints.
+    // explicitly make functions available that should be in public interface here.
+    using ActuatorDigitalChangeLogged::activeDurations;
+    using ActuatorDigitalChangeLogged::maxStateHistorySize;
+    using ActuatorDigitalChangeLogged::getLastStartEndTime;
+    using ActuatorDigitalChangeLogged::stateHistory;
+    using ActuatorDigitalChangeLogged::stateHistorySize;
+    using ActuatorDigitalChangeLogged::supportsFastIo;
+
+    // constraints beyond the capacity of the set are ignored
+    void addConstraint(Constraint&& newConstraint)
     {
-        return 3;
+        constraints.add(std::move(newConstraint));
+        m_stable = false;
     }
-};
 
-template <uint8_t ID>
-class Mutex : public Base {
-private:
-    const std::function<std::shared_ptr<MutexTarget>()> m_mutexTarget;
-    duration_millis_t m_holdAfterTurnOff;
-    bool m_useCustomHoldDuration;
-    // keep shared pointer to mutex, so it cannot be destroyed while locked
-    std::shared_ptr<MutexTarget> m_lockedMutex;
-    std::unique_lock<std::mutex> m_lock;
+    // remove all constraints and return the removed constraints
+    ConstraintSet removeAllConstraints()
+    {
+        m_stable = false;
+        return std::move(constraints);
+    }
 
-public:
-    explicit Mutex(
-        std::function<std::shared_ptr<MutexTarget>()>&& mut, duration_millis_t hold, bool useCustomHold)
-        : m_mutexTarget(mut)
-        , m_holdAfterTurnOff(hold)
-        , m_useCustomHoldDuration(useCustomHold)
+    void resetHistory()
     {
+        ActuatorDigitalChangeLogged::resetHistory();
     }
-    virtual ~Mutex() = default;
 
-    virtual duration_millis_t allowedImpl(const State& newState, const ticks_millis_t& now, const ActuatorDigitalChangeLogged& act) override final
+    duration_millis_t checkConstraints(const State& val, const ticks_millis_t& now)
     {
-        if (m_lock) {
-            // already owner of lock.
-            auto elapsedMinimal = m_useCustomHoldDuration ? m_holdAfterTurnOff : m_lockedMutex->holdAfterTurnOff();
-            if (newState == State::Inactive) {
-                // Release lock if actuator has been off for minimal time
-                duration_millis_t elapsedOff = 0;
-                if (act.state() == State::Inactive) {
-                    auto times = act.getLastStartEndTime(State::Inactive, now);
-                    elapsedOff = times.end - times.start;
-                }
+        return constraints.allowed(val, now, *this);
+    }
 
-                if (elapsedOff >= elapsedMinimal) {
-                    m_lockedMutex->timeRemaining(0);
-                    m_lock.unlock();
-                    m_lockedMutex.reset();
-                } else {
-                    m_lockedMutex->timeRemaining(elapsedMinimal - elapsedOff);
-                }
-            } else {
-                m_lockedMutex->timeRemaining(elapsedMinimal);
-            }
-            return 0;
-        }
-        if (newState == State::Inactive) {
-            // not locked, but no lock needed
+    duration_millis_t desiredState(const State& val, const ticks_millis_t& now)
+    {
+        lastUpdateTime = now; // always update fallback time for state setter without time
+        if (m_stable && val == m_desiredState && val == state()) {
+            ActuatorDigitalChangeLogged::state(val, now);
             return 0;
         }
-        if (newState == State::Active) {
-            m_lockedMutex = m_mutexTarget(); // store shared pointer to target so it can't be deleted while locked
-            if (m_lockedMutex) {
-                m_lock = std::unique_lock<std::mutex>(m_lockedMutex->mut, std::try_to_lock);
-                if (m_lock) {
-                    // successfully aquired lock of target
-                    return 0;
-                }
-                return m_lockedMutex->timeRemaining() + 1;
-            }
+        m_desiredState = val;
+        auto timeRemaining = checkConstraints(val, now);
+        if (timeRemaining == 0) {
+            ActuatorDigitalChangeLogged::state(val, now);
         }
-        return 1000;
-    }
-
-    auto holdAfterTurnOff() const
-    {
-        return m_holdAfterTurnOff;
+        m_stable = timeRemaining == 0;
+        return timeRemaining;
     }
 
-    void holdAfterTurnOff(duration_millis_t v)
+    duration_millis_t desiredState(const State& val)
     {
-        m_holdAfterTurnOff = v;
+        return desiredState(val, lastUpdateTime);
     }
 
-    bool useCustomHoldDuration() const
+    State state() const
     {
-        return m_useCustomHoldDuration;
+        return ActuatorDigitalChangeLogged::state();
     }
 
-    void useCustomHoldDuration(bool v)
+    // Set the state from the timer interrupt of a fast PWM, without checking the time based constraints.
+    // The actuator only turns on while it owns its mutexes. Otherwise the next update acquires them.
+    void setStateUnlogged(const State& val)
     {
-        m_useCustomHoldDuration = v;
+        m_desiredState = val;
+        m_stable = false; // the state was set without checking the constraints
+        if (val == State::Active && !constraints.allowedFromIsr()) {
+            return;
+        }
+        ActuatorDigitalChangeLogged::state(val);
     }
 
-    bool hasLock() const
+    ticks_millis_t update(ticks_millis_t now)
     {
-        return bool(m_lock);
+        // re-apply constraints for new update time
+        auto remaining = desiredState(m_desiredState, now);
+        // update when a blocking constraint can allow the desired state, but at least once per second
+        return (remaining > 0 && remaining < 1000) ? now + remaining : now + 1000;
     }
 
-    virtual uint8_t
-    id() const override final
+    State
+    desiredState() const
     {
-        return ID;
+        return m_desiredState;
     }
 
-    virtual uint8_t
-    order() const override final
+    const ConstraintSet&
+    constraintsList() const
     {
-        return 4;
+        return constraints;
     }
 };
-} // end namespace ADConstraints
@@ -48,6 +48,16 @@ private:
     bool m_settingValid = true;
     bool m_valueValid = true;
 
+    // Error diffusion: high time that periods which left the two period window were short of their target.
+    // It is carried over to the next periods, so errors that the window compensation misses are not lost.
+    // Kept in ms * raw duty units, so rounding to whole milliseconds doesn't leave an error either.
+    // Like stretching a period, it is only applied when the previous period had normal length.
+    int64_t m_dutyResidual = 0;
+    ticks_millis_t m_periodStart = 0;
+    duration_millis_t m_windowOldestActive = 0;
+    duration_millis_t m_windowOldestPeriod = 0;
+    uint8_t m_diffusionPaused = 0;
+
     static constexpr value_t maxDuty()
     {
         return value_t{100};
@@ -55,12 +65,18 @@ private:
 
     safe_elastic_fixed_point<2, 28> dutyFraction() const;
 
+    void diffuseError(const ActuatorDigitalChangeLogged::Durations& durations, ticks_millis_t periodStart);
+
+    void pauseDiffusion();
+
+    // the residual in whole milliseconds
+    int32_t residual() const;
+
     // separate flag for manually disabling the pwm actuator
     bool m_enabled = true;
 
 #if PLATFORM_ID != PLATFORM_GCC
-    uint8_t timerFuncId = 0;
-    duration_millis_t m_fastPwmElapsed = 0;
+    uint8_t timerPwmId = 0;
 #endif
 
 public:
@@ -119,12 +135,11 @@ public:
     update_t slowPwmUpdate(const update_t& now);
 
 #if PLATFORM_ID != PLATFORM_GCC
-    update_t fastUpdate(const update_t& now);
-
     /**
-    When the period is less than 1000ms, switch to timer interrupt based tasks
+    When the period is less than 1000ms, the edges are generated by the timer interrupt.
+    Called from the timer interrupt at the start of each period and at the end of the active time.
     */
-    void timerTask();
+    void timerEdge(bool active);
 
     void manageTimerTask();
 #endif
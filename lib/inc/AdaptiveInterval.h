@@ -0,0 +1,129 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "Temperature.h"
+#include "TicksTypes.h"
+#include <algorithm>
+
+/*
+ * Decides when to read a sensor, based on how fast its value changes.
+ * While the value is stable, the interval grows to the maximum. When it changes, the interval shrinks to the minimum.
+ * A step larger than the step threshold switches to the minimum interval immediately.
+ *
+ * Like TriggeredInterval, it reads when triggered by new input once the interval has passed.
+ * Without new input, it still reads shortly after the interval has passed, so missing input is detected.
+ * With equal minimum and maximum intervals, it behaves like TriggeredInterval<interval, interval + untriggeredDelay>.
+ */
+class AdaptiveInterval {
+public:
+    static constexpr const duration_millis_t untriggeredDelay = 500;
+
+private:
+    duration_millis_t m_minInterval;
+    duration_millis_t m_maxInterval;
+    duration_millis_t m_interval;
+    ticks_millis_t m_lastUpdate;
+    temp_t m_lastValue = 0;
+    bool m_lastValid = false;
+    bool m_triggered = false;
+
+public:
+    AdaptiveInterval(duration_millis_t minInterval = 500, duration_millis_t maxInterval = 500)
+        : m_minInterval(minInterval)
+        , m_maxInterval(maxInterval)
+        , m_interval(minInterval)
+        , m_lastUpdate(-(maxInterval + untriggeredDelay))
+    {
+    }
+    AdaptiveInterval(const AdaptiveInterval&) = delete;
+    AdaptiveInterval& operator=(const AdaptiveInterval&) = delete;
+    ~AdaptiveInterval() = default;
+
+    // signal that new input is available
+    void trigger()
+    {
+        m_triggered = true;
+    }
+
+    // a maximum below the minimum is raised to the minimum
+    void limits(duration_millis_t minInterval, duration_millis_t maxInterval)
+    {
+        m_minInterval = minInterval;
+        m_maxInterval = std::max(minInterval, maxInterval);
+        m_interval = std::min(std::max(m_interval, m_minInterval), m_maxInterval);
+    }
+
+    duration_millis_t minInterval() const
+    {
+        return m_minInterval;
+    }
+
+    duration_millis_t maxInterval() const
+    {
+        return m_maxInterval;
+    }
+
+    // the current interval between reads
+    duration_millis_t interval() const
+    {
+        return m_interval;
+    }
+
+    ticks_millis_t update(const ticks_millis_t& now, bool& doUpdate)
+    {
+        auto elapsed = now - m_lastUpdate;
+
+        if ((m_triggered && elapsed >= m_interval) || elapsed >= m_interval + untriggeredDelay) {
+            doUpdate = true;
+            m_triggered = false;
+            m_lastUpdate = now;
+            return now + m_interval + untriggeredDelay;
+        }
+        if (m_triggered) {
+            // postpone until the interval has passed
+            return m_lastUpdate + m_interval;
+        }
+        return m_lastUpdate + m_interval + untriggeredDelay;
+    }
+
+    // adapt the interval to the change since the previous read
+    void sample(const temp_t& value, bool valid)
+    {
+        // changes up to the tolerance count as stable, this is 2 steps of the DS18B20 resolution
+        const temp_t tolerance = temp_t{0.125};
+        const temp_t stepThreshold = temp_t{0.5};
+
+        temp_t change = value - m_lastValue;
+        if (change < 0) {
+            change = -change;
+        }
+
+        if (!valid || !m_lastValid || change >= stepThreshold) {
+            // read invalid values and steps at the highest rate, to recover and follow them quickly
+            m_interval = m_minInterval;
+        } else if (change > tolerance) {
+            m_interval = std::max(m_interval / 2, m_minInterval);
+        } else {
+            m_interval = std::min(m_interval + m_interval / 2, m_maxInterval);
+        }
+        m_lastValue = value;
+        m_lastValid = valid;
+    }
+};
@@ -30,22 +30,53 @@ template <uint8_t ID>
 class Balanced;
 }
 
+/*
+ * Divides the available total between the actuators that are constrained by it.
+ *
+ * The balancer works in two phases per cycle:
+ * - Collect: each actuator requests a value when its setting is written. Until the next update, it is limited to
+ *   its current grant, so the settings never add up to more than the available total.
+ * - Apply: update() calculates the grants for all requests at once, then calls the apply callback of each requester,
+ *   which sets its actuator again with the new grant. All actuators use the new allocation in the same cycle.
+ * Requesters are stored in order of id, with an index by id, so looking up a requester doesn't search.
+ */
 class BalancerImpl {
 public:
     using value_t = ActuatorAnalog::value_t;
     BalancerImpl() = default;
     virtual ~BalancerImpl() = default;
 
+    enum class Policy : uint8_t {
+        PROPORTIONAL, // scale all requests by the same factor
+        WEIGHTED,     // divide in proportion to weight, requests smaller than their share are granted fully
+        PRIORITY,     // grant requests in order of priority, equal priority in order of id
+    };
+
     struct Request {
         uint8_t id;
         value_t requested;
         value_t granted;
+        uint8_t weight = 1;
+        uint8_t priority = 0;         // higher goes first
+        std::function<void()> apply; // sets the actuator again after its grant was calculated
     };
 
     const value_t available = 100;
 
+private:
+    static constexpr uint8_t noIndex = 0xFF;
+
     std::vector<Request> requesters;
+    std::vector<uint8_t> index; // position in requesters by id
+    Policy m_policy = Policy::PROPORTIONAL;
+
+    Request* find(uint8_t requester_id);
+    const Request* find(uint8_t requester_id) const;
+    void grantProportional();
+    void grantWeighted();
+    void grantPriority();
 
+public:
     uint8_t registerEntry();
 
     void unregisterEntry(const uint8_t& requester_id);
@@ -54,8 +85,21 @@ public:
 
     value_t granted(const uint8_t& requester_id) const;
 
+    void configure(const uint8_t& requester_id, uint8_t weight, uint8_t priority, const std::function<void()>& apply);
+
+    // calculate the grants for the requests made since the last update and apply them to all requesters
     void update();
 
+    Policy policy() const
+    {
+        return m_policy;
+    }
+
+    void policy(Policy v)
+    {
+        m_policy = v;
+    }
+
     const std::vector<Request>& clients() const
     {
         return requesters;
@@ -78,15 +122,26 @@ template <uint8_t ID>
 class Balanced : public Base {
 private:
     const std::function<std::shared_ptr<Balancer<ID>>()> m_balancer;
-    mutable uint8_t m_req_id; // can be updated by balancer in request
+    mutable uint8_t m_req_id = 0; // can be updated by balancer in request
+    uint8_t m_weight;
+    uint8_t m_priority;
+    std::function<void()> m_apply;
 
 public:
+    // apply is called by the balancer when it has calculated the new grants, to set the actuator again
     explicit Balanced(
-        std::function<std::shared_ptr<Balancer<ID>>()>&& balancer)
+        std::function<std::shared_ptr<Balancer<ID>>()>&& balancer,
+        uint8_t weight = 1,
+        uint8_t priority = 0,
+        std::function<void()>&& apply = nullptr)
         : m_balancer(balancer)
+        , m_weight(weight)
+        , m_priority(priority)
+        , m_apply(std::move(apply))
     {
         if (auto balancerPtr = m_balancer()) {
             m_req_id = balancerPtr->registerEntry();
+            balancerPtr->configure(m_req_id, m_weight, m_priority, m_apply);
         }
     }
 
@@ -103,7 +158,12 @@ public:
     virtual value_t constrain(const value_t& val) const override final
     {
         if (auto balancerPtr = m_balancer()) {
-            return balancerPtr->constrain(m_req_id, val);
+            auto oldId = m_req_id;
+            auto result = balancerPtr->constrain(m_req_id, val);
+            if (m_req_id != oldId) {
+                balancerPtr->configure(m_req_id, m_weight, m_priority, m_apply); // registered again
+            }
+            return result;
         }
         return val;
     }
@@ -118,6 +178,16 @@ public:
         return m_req_id;
     }
 
+    uint8_t weight() const
+    {
+        return m_weight;
+    }
+
+    uint8_t priority() const
+    {
+        return m_priority;
+    }
+
     value_t granted() const
     {
         if (auto balancerPtr = m_balancer()) {
@@ -24,6 +24,7 @@
 #include "OneWireDevice.h"
 #include "TempSensor.h"
 #include "Temperature.h"
+#include <vector>
 
 class OneWire;
 
@@ -45,9 +46,9 @@ class DS18B20 final : public TempSensor, public OneWireDevice {
             return data[i];
         }
 
-        bool valid()
+        uint8_t* begin()
         {
-            return OneWireCrc8(data, 8) == data[8];
+            return data;
         }
 
     private:
@@ -58,6 +59,14 @@ public:
 private:
     temp_t m_calibrationOffset;
     temp_t m_cachedValue = 0;
+    bool m_readPending = false;
+    bool m_initPending = false;
+    uint8_t m_readRetries = 0;
+    bool m_alarmMode = false;
+    uint8_t m_alarmHigh = 1;      // alarm thresholds written to the scratchpad, a reset reverts them to the values in EEPROM
+    uint8_t m_alarmLow = 0;
+    uint32_t m_alarmSearches = 0; // alarm search count of the bus when the sensor last decided whether to read
+    uint8_t m_skippedReads = 0;
 
 public:
     /**
@@ -75,7 +84,7 @@ public:
     DS18B20(const DS18B20&) = delete;
     DS18B20& operator=(const DS18B20&) = delete;
 
-    virtual ~DS18B20() = default;
+    virtual ~DS18B20();
 
     static constexpr uint8_t familyCode{0x28};
 
@@ -85,7 +94,44 @@ public:
     }
 
     virtual temp_t value() const override final; // return cached value
-    void update();                               // read from hardware sensor
+    void update();                               // read from hardware sensor and request the next conversion on the bus
+
+    /**
+     * Reads the sensor without blocking: the scratchpad is read by the transaction queue of the bus.
+     * The cached value is updated when the transaction completes. Returns false if a read is already pending,
+     * or in alarm mode when the value has not changed.
+     */
+    bool updateAsync();
+
+    bool readPending() const
+    {
+        return m_readPending;
+    }
+
+    // expected time in microseconds until the pending read has completed, from the operations queued before it
+    duration_micros_t readExpected() const
+    {
+        return m_readPending ? oneWire->transactions().expectedCompletion(this) : 0;
+    }
+
+    using OneWireDevice::bus;
+    virtual void bus(OneWire& newBus) override final;
+
+    /**
+     * In alarm mode, the alarm thresholds of the sensor are set to the whole degrees around its last value.
+     * After each conversion the bus queues a single alarm search, and the sensor is only read when that search found
+     * its temperature outside the band, or when it has skipped maxSkippedReads conversions.
+     * The sensor compares whole degrees only, so a smaller change is seen at the latest when the read is forced:
+     * with a conversion every second, the value is at most about 10 seconds old.
+     */
+    void alarmMode(bool enabled);
+
+    static constexpr const uint8_t maxSkippedReads = 10;
+
+    bool alarmMode() const
+    {
+        return m_alarmMode;
+    }
 
     void setCalibration(temp_t const& calib)
     {
@@ -102,12 +148,24 @@ private:
 
     void requestConversion();
 
+    // in alarm mode, false until an alarm search completed since the last call has found the sensor
+    bool readNeeded();
+
+    void updateAlarmBand(int16_t tempRaw);
+
     /**
 	 * Reads the temperature. If successful, constrains the temp to the range of the temperature type and
 	 * updates lastRequestTime. On successful, leaves lastRequestTime alone and returns DEVICE_DISCONNECTED.
 	 */
     temp_t readAndConstrainTemp();
 
+    // converts a raw reading to a temperature and updates the connected state
+    temp_t convertRawTemp(int16_t tempRaw);
+
+    void submitScratchPadRead();
+
+    void scratchPadReceived(const OneWireTransactionQueue::Result& result);
+
     bool readScratchPad(ScratchPad& scratchPad);
 
     void writeScratchPad(const ScratchPad& scratchPad, bool copyToEeprom);
@@ -119,4 +177,6 @@ private:
     void startConversion();
 
     int16_t getRawTemp();
+
+    int16_t rawTempFromScratchPad(const uint8_t* scratchPad) const;
 };
@@ -28,6 +28,21 @@ private:
     uint8_t scratchpad[9];
     uint8_t eeprom[3];
     bool parasite = false;
+    uint32_t conversions = 0;
+    uint32_t reads = 0;
+    uint8_t lastCmd = 0;
+    duration_micros_t conversionTime = 0; // 0 for an instant conversion
+    ticks_micros_t conversionStart = 0;
+    bool converting = false;
+    int16_t measured; // raw temperature that is written to the scratchpad by the next conversion
+
+    void finishConversion()
+    {
+        converting = false;
+        scratchpad[0] = measured & 0xFF;
+        scratchpad[1] = (int8_t)(measured >> 8);
+        scratchpad[8] = OneWireCrc8(scratchpad, 8);
+    }
 
 public:
     static constexpr uint8_t family_code{0x28};
@@ -47,10 +62,12 @@ public:
         eeprom[0] = scratchpad[2];
         eeprom[1] = scratchpad[3];
         eeprom[2] = scratchpad[4];
+        measured = (int16_t(scratchpad[1]) << 8) | scratchpad[0];
     }
 
     virtual void processImpl(uint8_t cmd) override final
     {
+        lastCmd = cmd;
         switch (cmd) {
         case 0x4E: // WRITE SCRATCHPAD
             // write 3 byte of data to scratchpad[2:4], ds18s20 only first 2 bytes (TH, TL)
@@ -58,6 +75,7 @@ public:
             scratchpad[8] = OneWireCrc8(scratchpad, 8);
             break;
         case 0xBE: // READ SCRATCHPAD
+            ++reads;
             send(scratchpad, 9);
             break;
 
@@ -80,6 +98,13 @@ public:
         } break;
 
         case 0x44: // CONVERT
+            ++conversions;
+            if (conversionTime) {
+                converting = true;
+                conversionStart = now;
+            } else {
+                finishConversion();
+            }
             break;
         default:
             break;
@@ -87,13 +112,76 @@ public:
     }
 
     static constexpr const int16_t scale = 1 << (cnl::_impl::fractional_digits<temp_t>::value - 4);
+    // Set the measured temperature. Without a conversion time, it is written to the scratchpad immediately.
+    // Otherwise it is written when the next conversion completes, like the real sensor.
     void setTemperature(temp_t temperature)
     {
-        int16_t raw = cnl::unwrap(temperature) / scale;
-        scratchpad[0] = raw & 0xFF;
-        scratchpad[1] = (int8_t)(raw >> 8);
+        measured = cnl::unwrap(temperature) / scale;
+        if (!conversionTime) {
+            finishConversion();
+        }
+    }
+
+    void setConversionTime(const duration_micros_t& t)
+    {
+        conversionTime = t;
+    }
+
+    bool isConverting() const
+    {
+        return converting;
+    }
+
+    virtual void powerOnReset() override final
+    {
+        // settings are reloaded from eeprom and the temperature register is reset to 85 degrees
+        scratchpad[0] = 0x50;
+        scratchpad[1] = 0x05;
+        scratchpad[2] = eeprom[0];
+        scratchpad[3] = eeprom[1];
+        scratchpad[4] = eeprom[2];
         scratchpad[8] = OneWireCrc8(scratchpad, 8);
+        converting = false;
+    }
+
+    virtual void resetImpl() override final
+    {
+        lastCmd = 0;
+    }
+
+protected:
+    virtual void timeChanged() override final
+    {
+        if (converting && now - conversionStart >= conversionTime) {
+            finishConversion();
+        }
+    }
+
+    // the sensor holds the bus low on read slots while a conversion is in progress
+    virtual uint8_t idleRead() const override final
+    {
+        return (converting && lastCmd == 0x44) ? 0x00 : 0xFF;
+    }
+
+    // the whole degrees of the temperature are compared with the alarm thresholds
+    virtual bool alarm() const override final
+    {
+        int16_t rawTemperature = (((int16_t)scratchpad[1]) << 8) | scratchpad[0];
+        auto wholeDegrees = int8_t(rawTemperature >> 4);
+        return wholeDegrees >= int8_t(scratchpad[2]) || wholeDegrees <= int8_t(scratchpad[3]);
+    }
+
+public:
+    uint32_t scratchpadReads() const
+    {
+        return reads;
     }
+
+    uint32_t conversionCount() const
+    {
+        return conversions;
+    }
+
     temp_t getTemperature() const
     {
         int16_t rawTemperature = (((int16_t)scratchpad[1]) << 8) | scratchpad[0];
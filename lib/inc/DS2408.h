@@ -20,10 +20,12 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 
 #include "IoArray.h"
 #include "OneWireDevice.h"
+#include "TicksTypes.h"
 
 #define DS2408_FAMILY_ID 0x29
 
@@ -46,6 +48,10 @@ private:
     uint8_t cond_search_mask = 0x00; // 3 = conditional search channel selection mask
     uint8_t cond_search_pol = 0x00;  // 4 = conditional search channel polarity selection
     uint8_t status = 0x08;           // 5 = control/status register
+    ticks_millis_t lastPoll = 0;
+    std::array<ticks_millis_t, 8> senseHeldUntil{}; // per channel, time before which the input is not expected to change
+
+    bool writeLatches(uint8_t newLatches);
 
 public:
     /**
@@ -65,14 +71,29 @@ public:
 
     static constexpr uint8_t familyCode{0x29};
 
+    // even when all inputs are held off, the device is read at this interval to detect a reset or disconnect
+    static constexpr duration_millis_t maxPollInterval = 5000;
+
     bool update();
     bool writeNeeded() const;
 
+    // An input that is not expected to change before the given time doesn't need a fresh read before then.
+    // A time in the past clears the hold off.
+    void holdOffSense(uint8_t channel, const ticks_millis_t& until);
+
+    // true when an input needs a fresh read, a write is needed or the maximum poll interval has passed
+    bool pollDue(const ticks_millis_t& now) const;
+
+    // periodic update, only communicates with the device when a poll is due
+    bool poll(const ticks_millis_t& now);
+
     // generic ArrayIo interface
     virtual bool senseChannelImpl(uint8_t channel, State& result) const override final;
 
     virtual bool writeChannelImpl(uint8_t channel, ChannelConfig config) override final;
 
+    virtual bool commitChannels() override final;
+
     virtual bool supportsFastIo() const override final
     {
         return false;
@@ -21,6 +21,7 @@
 
 #include "OneWireCrc.h"
 #include "OneWireMockDevice.h"
+#include <vector>
 
 class DS2408Mock : public OneWireMockDevice {
 private:
@@ -38,6 +39,7 @@ private:
     uint8_t externalPullDowns = 0xFF;
     uint8_t sampleCounter = 0;
     uint16_t crc = 0;
+    std::vector<uint8_t> writes; // latch values written by the master, in order
 
 public:
     static constexpr uint8_t family_code{0x29};
@@ -123,6 +125,7 @@ public:
             if (newLatches == inverted) {
                 send(0xAA); // confirm
                 latches = newLatches;
+                writes.push_back(newLatches);
                 update();
                 send(pins);
             }
@@ -137,6 +140,24 @@ public:
         cmd = 0x00;
     }
 
+    virtual void powerOnReset() override final
+    {
+        // output latches are released and the power-on reset flag is set
+        latches = 0xFF;
+        status |= 0x08;
+        update();
+    }
+
+    const std::vector<uint8_t>& latchWrites() const
+    {
+        return writes;
+    }
+
+    void clearLatchWrites()
+    {
+        writes.clear();
+    }
+
     void setExternalPullDown(uint8_t bit, bool enabled)
     {
         uint8_t mask = uint8_t{0x1} << bit;
@@ -75,6 +75,9 @@ public:
     virtual bool
     writeChannelImpl(uint8_t channel, ChannelConfig config) override final;
 
+    virtual bool
+    commitChannels() override final;
+
     virtual bool
     supportsFastIo() const override final
     {
@@ -84,4 +87,5 @@ public:
 
 private:
     bool processStatus(uint8_t data);
+    bool writeLatches(uint8_t latches);
 };
@@ -74,6 +74,13 @@ public:
         cmd = 0x00;
     }
 
+    virtual void powerOnReset() override final
+    {
+        // output latches are released
+        latchA = true;
+        latchB = true;
+    }
+
     void
     sendStatus()
     {
@@ -78,6 +78,10 @@ public:
     virtual bool write(uint8_t b) override final;
     virtual bool read(uint8_t& b) override final;
 
+    // The bridge reads one byte per command. A block read checks for idle only once and polls the status
+    // without setting the read pointer, which reduces the I2C transfers per byte from 7 to 4.
+    virtual bool read_bytes(uint8_t* buf, uint16_t count, uint8_t& crc) override final;
+
     virtual bool write_bit(bool bit) override final;
     virtual bool read_bit(bool& bit) override final;
 
@@ -98,9 +102,18 @@ public:
     // Returns – The DS248X status byte result from the triplet command
     virtual uint8_t search_triplet(bool search_direction) override final;
 
+    // Non-blocking operations: start writes the command to the bridge, poll reads the status register once.
+    virtual bool start(AsyncOp op, uint8_t value) override final;
+    virtual AsyncStatus poll(uint8_t& result) override final;
+
 private:
     uint8_t mAddress;
     uint8_t mStatus = 0;
+    AsyncOp mPendingOp = AsyncOp::RESET;
+    bool mPendingFailed = false;
 
-    bool busyWait(); //blocks until ready or timeout, updates status
+    bool readStatus();        // reads status once, without waiting
+    bool readCommandStatus(); // reads status once after a 1-Wire command, which leaves the read pointer at the status register
+    bool busyWait();          //blocks until ready or timeout, updates status
+    bool commandWait();       // like busyWait, but using readCommandStatus
 };
@@ -37,7 +37,7 @@ public:
     IoArray(const IoArray&) = delete;
     IoArray& operator=(const IoArray&) = delete;
 
-    virtual ~IoArray() = default;
+    virtual ~IoArray();
 
     enum class ChannelConfig {
         UNUSED = 0,
@@ -118,6 +118,23 @@ public:
         return channels.size();
     }
 
+    /*
+     * While a batch is open, devices with slow IO defer the hardware writes of channel changes.
+     * When the outermost batch is closed, each device with deferred changes commits them at once,
+     * in the order in which the devices were first written.
+     * This merges the changes of one update pass into a single bus transaction per device.
+     */
+    class Batch {
+    public:
+        Batch()
+        {
+            ++batchDepth;
+        }
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+        ~Batch();
+    };
+
     // virtual functions to be implemented by super class that perform actual hardware IO.
     // most data and/or caching is stored in this class.
     // the super class can choose to apply/read immediately or to implement no-op functions and sync in an update function
@@ -127,10 +144,24 @@ protected:
     virtual bool senseChannelImpl(uint8_t channel, State& result) const = 0;
     virtual bool writeChannelImpl(uint8_t channel, ChannelConfig config) = 0;
 
+    // write deferred channel changes to the hardware, called when the outermost batch is closed
+    virtual bool commitChannels()
+    {
+        return true;
+    }
+
+    // Called by writeChannelImpl after updating the cached state.
+    // Returns true when a batch is open, the write is then committed when the batch closes.
+    bool deferWrite();
+
     struct Channel {
         ChannelConfig config = ChannelConfig::UNUSED;
         State state = State::Unknown;
     };
 
     mutable std::vector<Channel> channels;
+
+private:
+    static uint8_t batchDepth;
+    static std::vector<IoArray*> pendingCommits;
 };
\ No newline at end of file
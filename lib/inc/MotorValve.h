@@ -21,12 +21,19 @@
 
 #include "ActuatorDigitalBase.h"
 #include "DS2408.h"
+#include "TicksTypes.h"
+#include <algorithm>
 #include <functional>
 #include <memory>
 
 /*
  * A digital actuator that toggles a channel of an ArrayIo object.
  *
+ * The position of the valve is estimated from the time the motor has been driven, and corrected when an end switch
+ * is reached. This allows intermediate positions, and it allows the DS2408 to skip reading the end switches while
+ * the valve is travelling and cannot have reached them yet.
+ * The estimate needs the travel time from closed to open. Unless it is configured, it is measured in the first run
+ * from the closed to the open end switch. Until then, the end switches are read every update.
  */
 class MotorValve : public ActuatorDigitalBase {
 
@@ -51,9 +58,24 @@ private:
     uint8_t m_startChannel = 0;
     uint8_t m_desiredChannel = 0;
 
-    ValveState m_desiredValveState = ValveState::InitIdle;
+    ValveState m_desiredValveState = ValveState::InitIdle; // HalfOpenIdle when holding an intermediate position
     ValveState m_actualValveState = ValveState::InitIdle;
 
+    duration_millis_t m_travelTimeSetting = 0;  // configured travel time, 0 to measure it
+    duration_millis_t m_measuredTravelTime = 0; // last measured run from the closed to the open end switch
+    duration_millis_t m_travelTime = 0;         // time to drive the valve from closed to open, 0 while unknown
+    duration_millis_t m_travelled = 0;          // estimated position, as time driven from closed
+    duration_millis_t m_runFromClosed = 0;      // time driven open since the closed end switch was left
+    bool m_measuring = false;                   // the valve is opening, without stopping since it was closed
+    bool m_positionKnown = false;               // the position is only known after an end switch has been reached
+    uint8_t m_targetPosition = 0;               // percentage open
+    ticks_millis_t m_lastUpdate = 0;
+    bool m_updated = false;
+
+    ValveState drive() const;
+    void calibrate();
+    void holdOffSense(std::shared_ptr<DS2408>& devPtr, const ticks_millis_t& now);
+
 public:
     explicit MotorValve(std::function<std::shared_ptr<DS2408>()>&& target, uint8_t startChan)
         : m_target(target)
@@ -80,8 +102,62 @@ public:
 
     ValveState getValveState(const std::shared_ptr<DS2408>& devPtr) const;
 
+    // apply the desired state without advancing the position estimate
     void update();
 
+    // Advance the position estimate to now and drive the motor towards the target.
+    // Returns the time of the next update needed to stop at an intermediate position.
+    ticks_millis_t update(const ticks_millis_t& now);
+
+    // Move to a position in percent open. 0 and 100 drive the valve into the end switch, like state().
+    // An intermediate position is reached by motor run time, from a closed valve when the position is not known yet.
+    // When the travel time is not known either, the valve is opened fully from closed first, to measure it.
+    // It is applied in the next timed update.
+    void position(uint8_t percent);
+
+    // estimated position in percent open, only the end positions while the travel time is unknown
+    uint8_t position() const
+    {
+        if (m_travelTime == 0) {
+            return m_actualValveState == ValveState::Open ? 100 : 0;
+        }
+        return (uint32_t(m_travelled) * 100 + m_travelTime / 2) / m_travelTime;
+    }
+
+    bool positionKnown() const
+    {
+        return m_positionKnown;
+    }
+
+    uint8_t targetPosition() const
+    {
+        return m_targetPosition;
+    }
+
+    // the travel time that is used, configured or measured, 0 while unknown
+    duration_millis_t travelTime() const
+    {
+        return m_travelTime;
+    }
+
+    duration_millis_t travelTimeSetting() const
+    {
+        return m_travelTimeSetting;
+    }
+
+    // configure the travel time from closed to open, 0 to measure it
+    void travelTime(duration_millis_t v)
+    {
+        m_travelTimeSetting = v;
+        m_travelTime = v ? v : m_measuredTravelTime;
+        m_travelled = std::min(m_travelled, m_travelTime);
+    }
+
+    duration_millis_t measuredTravelTime() const
+    {
+        return m_measuredTravelTime;
+    }
+
     uint8_t startChannel() const
     {
         return m_desiredChannel;
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "TicksTypes.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/*
+ * Gives one actuator at a time permission to be active.
+ *
+ * Actuators identify themselves with a token. The owner is kept in a single atomic word, so acquiring it never blocks.
+ * When the owner turns off, it keeps a reservation until its hold time has passed. It can turn on again during
+ * that time, other actuators have to wait until the deadline.
+ * Actuators that have to wait are queued and get the mutex in the order in which they asked for it.
+ *
+ * Only ownedBy(), held() and holdFromIsr() can be called from interrupt context, they only access the owner word.
+ * All other functions are called from the main loop.
+ */
+class MutexTarget {
+public:
+    using Token = uint16_t;
+
+private:
+    struct Waiter {
+        Token token;
+        ticks_millis_t since; // when the actuator started waiting
+        ticks_millis_t lastSeen;
+    };
+
+    static constexpr uint32_t heldFlag = uint32_t(1) << 16;
+
+    std::atomic<uint32_t> m_owner{0}; // token of the owner in the lower 16 bits and heldFlag while it is active
+    ticks_millis_t m_releasedAt = 0;
+    duration_millis_t m_ownerHold = 0; // hold time of the owner after it turns off
+    std::array<Waiter, 8> m_waiting;
+    uint8_t m_waitingCount = 0;
+    duration_millis_t m_longestWait = 0;
+    duration_millis_t m_timeRemaining = 0;
+    duration_millis_t m_holdAfterTurnOff = 0;
+
+public:
+    MutexTarget() = default;
+    MutexTarget(const MutexTarget&) = delete;
+    MutexTarget& operator=(const MutexTarget&) = delete;
+    ~MutexTarget() = default;
+
+    // A new token for an actuator, never 0. Tokens that are still in use are skipped when the counter wraps.
+    static Token newToken();
+
+    // the token is no longer used and can be handed out again
+    static void releaseToken(Token token);
+
+    // Take the mutex for an actuator that wants to turn on, with the hold time it will use when it turns off.
+    // Returns 0 when the actuator is the owner, otherwise the estimated time it has to wait.
+    duration_millis_t tryAcquire(Token token, duration_millis_t hold, const ticks_millis_t& now);
+
+    // The actuator turned off at releasedAt, or no longer wants to turn on.
+    // When it is the owner, other actuators can take the mutex when its hold time has passed.
+    void release(Token token, const ticks_millis_t& releasedAt, const ticks_millis_t& now);
+
+    // The actuator no longer wants the mutex. An owner gives it up immediately, without hold time.
+    void abandon(Token token);
+
+    // true while the actuator is active, or off and not replaced by another actuator yet
+    bool ownedBy(Token token) const
+    {
+        return Token(m_owner.load()) == token;
+    }
+
+    // true while the actuator is off, but within its hold time
+    bool reservedBy(Token token, const ticks_millis_t& now) const
+    {
+        return ownedBy(token) && !held() && reservationRemaining(now) > 0;
+    }
+
+    // true when the owner is active
+    bool held() const
+    {
+        return m_owner.load() & heldFlag;
+    }
+
+    // An actuator that is switched from interrupt context marks itself active again, when it is still the owner.
+    // Returns false when another actuator has taken the mutex, the actuator should stay off then.
+    bool holdFromIsr(Token token);
+
+    // refresh the time remaining while no actuator asks for the mutex
+    void update(const ticks_millis_t& now);
+
+    duration_millis_t holdAfterTurnOff() const
+    {
+        return m_holdAfterTurnOff;
+    }
+
+    void holdAfterTurnOff(duration_millis_t v)
+    {
+        m_holdAfterTurnOff = v;
+    }
+
+    // time until other actuators can take the mutex, as of the last call with the current time
+    duration_millis_t timeRemaining() const
+    {
+        return m_timeRemaining;
+    }
+
+    uint8_t waitingCount() const
+    {
+        return m_waitingCount;
+    }
+
+    // time that the actuator has been waiting for the mutex, 0 if it is not waiting
+    duration_millis_t waitedBy(Token token, const ticks_millis_t& now) const;
+
+    // time that the first actuator in the queue has been waiting, as of the last update
+    duration_millis_t longestWait() const
+    {
+        return m_longestWait;
+    }
+
+private:
+    duration_millis_t reservationRemaining(const ticks_millis_t& now) const;
+    void enqueue(Token token, const ticks_millis_t& now);
+    void dequeue(Token token);
+    void dropStaleWaiters(const ticks_millis_t& now);
+};
@@ -2,11 +2,16 @@
 
 #include "OneWireAddress.h"
 #include "OneWireLowLevelInterface.h"
+#include "OneWireStats.h"
+#include "OneWireTransactionQueue.h"
+#include <vector>
 
 class OneWire {
 public:
-    explicit OneWire(OneWireLowLevelInterface& driverImpl)
+    explicit OneWire(OneWireLowLevelInterface& driverImpl, OneWireClock clock_ = nullptr)
         : driver(driverImpl)
+        , clock(clock_)
+        , queue(driverImpl, clock_)
     {
         // base class OneWireLowLevelInterface configures pin or bus master IC
         init();
@@ -19,11 +24,29 @@ public:
 
 private:
     OneWireLowLevelInterface& driver;
+    OneWireClock clock;
+    OneWireTransactionQueue queue;
     // global search state
     OneWireAddress ROM_NO;
     uint8_t lastDiscrepancy;
     bool lastDeviceFlag;
     uint8_t lockedSearchBits;
+    // a temperature conversion is requested by at least one device
+    bool conversionRequested = false;
+    // an alarm search is requested by at least one device, to run when the conversion has finished
+    bool alarmSearchRequested = false;
+    bool alarmSearchActive = false;
+    uint32_t alarmSearches = 0;
+    std::vector<OneWireAddress> alarmedDevices; // found by the last completed alarm search
+    // state of the alarm search in progress, separate from the discovery search state
+    OneWireAddress alarmRom;
+    uint8_t alarmLastDiscrepancy = 64;
+    std::vector<OneWireAddress> alarmFound;
+
+    bool search(OneWireAddress& newAddr, uint8_t command);
+
+    void submitAlarmSearchPass();
+    void alarmSearchPassDone(const OneWireTransactionQueue::Result& result);
 
 public:
     // wrappers for low level functions
@@ -53,9 +76,37 @@ public:
 
     bool reset()
     {
+        // blocking operations start with a reset, finish the transaction on the bus first so they don't interleave
+        if (!queue.finishActive()) {
+            return false;
+        }
+        // a missing presence pulse is counted by the caller, which knows which device didn't respond
+        ++stats().resets;
         return driver.reset();
     }
 
+    OneWireStats& stats()
+    {
+        return queue.stats();
+    }
+
+    const OneWireStats& stats() const
+    {
+        return queue.stats();
+    }
+
+    // microseconds from the clock passed on construction, 0 if no clock was set
+    ticks_micros_t micros() const
+    {
+        return clock ? clock() : 0;
+    }
+
+    // Queue for non-blocking transactions. The owner of the bus processes it from the main loop.
+    OneWireTransactionQueue& transactions()
+    {
+        return queue;
+    }
+
     // high level functions
 
     // Issue a 1-Wire rom select command, you do the reset first.
@@ -68,6 +119,9 @@ public:
 
     bool read_bytes(uint8_t* buf, uint16_t count);
 
+    // read bytes and compute their CRC8 while reading, the crc is 0 when the bytes end with their valid CRC
+    bool read_bytes(uint8_t* buf, uint16_t count, uint8_t& crc);
+
     // Clear the search state so that if will start from the beginning again.
     void reset_search();
 
@@ -83,4 +137,42 @@ public:
     // When the last device has been return, reset_search or target_search has to be called
     // to reset the search.
     bool search(OneWireAddress& newAddr);
+
+    // Request a temperature conversion for the next broadcast.
+    // Devices call this instead of starting a conversion themselves, so all sensors on the bus share one conversion.
+    void requestConversion()
+    {
+        conversionRequested = true;
+    }
+
+    // If a conversion was requested, start it on all devices at once with a skip ROM command.
+    // The broadcast is queued as a transaction. Returns true if a conversion was requested.
+    bool startRequestedConversions();
+
+    // Request an alarm search after the next conversion, for devices that only need to be read when in alarm
+    void requestAlarmSearch()
+    {
+        alarmSearchRequested = true;
+    }
+
+    // If requested, find all devices with an alarm condition with a single conditional search.
+    // Call this when the conversion has finished. The search is queued as transactions, one per device found,
+    // so it doesn't block. A discovery search in progress is not disturbed.
+    // Returns true if an alarm search was started.
+    bool startRequestedAlarmSearch();
+
+    // an alarm search is queued or in progress, alarmed() still holds the result of the previous search
+    bool alarmSearchPending() const
+    {
+        return alarmSearchActive;
+    }
+
+    // number of alarm searches that have completed, so devices can tell whether alarmed() is up to date for them
+    uint32_t alarmSearchCount() const
+    {
+        return alarmSearches;
+    }
+
+    // the device was found by the last completed alarm search
+    bool alarmed(const OneWireAddress& address) const;
 };
@@ -5,6 +5,11 @@
 uint8_t
 OneWireCrc8(const uint8_t* addr, uint8_t len);
 
+// Add a byte to a running CRC8, so the CRC can be computed while bytes arrive.
+// The CRC over data followed by its own CRC byte is 0.
+uint8_t
+OneWireCrc8Update(uint8_t input, uint8_t crc);
+
 uint16_t
 OneWireCrc16(const uint8_t* input, uint16_t len);
 uint16_t
@@ -21,6 +21,7 @@
 
 #include "OneWire.h"
 #include "OneWireAddress.h"
+#include "OneWireStats.h"
 
 class OneWireDevice {
 public:
@@ -39,6 +40,17 @@ public:
         m_address = addr;
     }
 
+    OneWire& bus() const
+    {
+        return *oneWire;
+    }
+
+    // move the device to another bus, for example when the device block selects a different bus
+    virtual void bus(OneWire& newBus)
+    {
+        oneWire = &newBus;
+    }
+
     bool connected() const
     {
         return m_connected;
@@ -46,14 +58,49 @@ public:
 
     void connected(bool _connected);
 
-    bool selectRom() const
+    bool selectRom()
     {
-        return oneWire.reset() && oneWire.select(m_address);
+        if (oneWire->reset() && oneWire->select(m_address)) {
+            return true;
+        }
+        recordPresenceError();
+        return false;
+    }
+
+    const OneWireStats& stats() const
+    {
+        return m_stats;
     }
 
 protected:
-    OneWire& oneWire;
+    OneWire* oneWire;
     OneWireAddress m_address;
+    OneWireStats m_stats;
+
+    // count an error for this device and for the bus it is on
+    void recordPresenceError()
+    {
+        ++m_stats.presenceErrors;
+        ++oneWire->stats().presenceErrors;
+    }
+
+    void recordCrcError()
+    {
+        ++m_stats.crcErrors;
+        ++oneWire->stats().crcErrors;
+    }
+
+    void recordRetry()
+    {
+        ++m_stats.retries;
+        ++oneWire->stats().retries;
+    }
+
+    void recordResetDetection()
+    {
+        ++m_stats.resetDetections;
+        ++oneWire->stats().resetDetections;
+    }
 
 private:
     bool m_connected = false;
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include "OneWireCrc.h"
 #include <cstdint>
 
 class OneWireLowLevelInterface {
@@ -43,6 +44,19 @@ public:
     // Read a byte.
     virtual bool read(uint8_t& v) = 0;
 
+    // Read a block of bytes and add them to a running CRC8 while they arrive.
+    // Drivers override this when they can read a block with less overhead than a read per byte.
+    virtual bool read_bytes(uint8_t* buf, uint16_t count, uint8_t& crc)
+    {
+        for (uint16_t i = 0; i < count; i++) {
+            if (!read(buf[i])) {
+                return false;
+            }
+            crc = OneWireCrc8Update(buf[i], crc);
+        }
+        return true;
+    }
+
     // Write a bit
     virtual bool write_bit(bool v) = 0;
 
@@ -51,4 +65,66 @@ public:
 
     // Perform a triple operation which will perform 2 read bits and 1 write bit, returns device status
     virtual uint8_t search_triplet(bool search_direction) = 0;
+
+    // Non-blocking operations, used by OneWireTransactionQueue.
+    // An operation is started with start() and its progress is checked with poll().
+    // Drivers that cannot work asynchronously use the default implementation, which performs the blocking operation in start().
+    enum class AsyncOp : uint8_t {
+        RESET,
+        WRITE,
+        READ,
+        WRITE_BIT,
+        READ_BIT,
+        SEARCH_TRIPLET, // the value is the search direction, the result is the status byte of search_triplet()
+    };
+
+    enum class AsyncStatus : uint8_t {
+        BUSY,
+        DONE,
+        FAILED,
+    };
+
+    // Start an operation. Returns false if the driver cannot accept it yet and start should be tried again later.
+    virtual bool start(AsyncOp op, uint8_t value)
+    {
+        bool success = false;
+        bool bit = false;
+        switch (op) {
+        case AsyncOp::RESET:
+            success = true;
+            asyncResult = reset() ? 1 : 0;
+            break;
+        case AsyncOp::WRITE:
+            success = write(value);
+            break;
+        case AsyncOp::READ:
+            success = read(asyncResult);
+            break;
+        case AsyncOp::WRITE_BIT:
+            success = write_bit(value != 0);
+            break;
+        case AsyncOp::READ_BIT:
+            success = read_bit(bit);
+            asyncResult = bit ? 1 : 0;
+            break;
+        case AsyncOp::SEARCH_TRIPLET:
+            success = true;
+            asyncResult = search_triplet(value != 0);
+            break;
+        }
+        asyncStatus = success ? AsyncStatus::DONE : AsyncStatus::FAILED;
+        return true;
+    }
+
+    // Check the progress of the last started operation, without waiting.
+    // When done, result holds the byte or bit read, or the presence pulse for a reset.
+    virtual AsyncStatus poll(uint8_t& result)
+    {
+        result = asyncResult;
+        return asyncStatus;
+    }
+
+private:
+    uint8_t asyncResult = 0;
+    AsyncStatus asyncStatus = AsyncStatus::DONE;
 };
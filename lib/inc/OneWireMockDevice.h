@@ -20,6 +20,7 @@
 #pragma once
 
 #include "OneWireAddress.h"
+#include "TicksTypes.h"
 #include <deque>
 #include <vector>
 class OneWireMockDriver;
@@ -78,6 +79,45 @@ public:
         connected = v;
     }
 
+    bool isConnected() const
+    {
+        return connected;
+    }
+
+    // simulate a power loss: the device loses its volatile state
+    virtual void powerOnReset()
+    {
+    }
+
+    // the driver sets the time of the bus before each operation, for devices that model timing
+    void setTime(const ticks_micros_t& t)
+    {
+        now = t;
+        timeChanged();
+    }
+
+    const OneWireAddress& getAddress() const
+    {
+        return address;
+    }
+
+protected:
+    virtual void timeChanged()
+    {
+    }
+
+    // value of a read time slot when the device has no data to send
+    virtual uint8_t idleRead() const
+    {
+        return 0xFF;
+    }
+
+    // the device responds to an alarm search
+    virtual bool alarm() const
+    {
+        return false;
+    }
+
 private:
     void positionsToMasks(const std::vector<uint32_t>& positions, std::deque<uint8_t>& queue);
 
@@ -89,6 +129,7 @@ protected:
     bool selected = false;
     bool parasite = false;
     uint8_t search_bitnr = 0;
+    ticks_micros_t now = 0;
     std::deque<uint8_t> flippedWriteBits;
     std::deque<uint8_t> flippedReadBits;
 
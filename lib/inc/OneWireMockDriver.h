@@ -22,12 +22,22 @@
 #include "OneWireAddress.h"
 #include "OneWireLowLevelInterface.h"
 #include "OneWireMockDevice.h"
+#include "OneWireStats.h"
 #include <memory>
 #include <vector>
 
 class OneWireMockDriver : public OneWireLowLevelInterface {
 
 public:
+    /*
+     * Duration of bus operations in microseconds, standard speed defaults.
+     * A byte takes 8 bit time slots, a search triplet 3.
+     */
+    struct Timing {
+        duration_micros_t reset = 960;
+        duration_micros_t bit = 70;
+    };
+
     OneWireMockDriver()
     {
     }
@@ -41,17 +51,20 @@ public:
 
     virtual bool read(uint8_t& v) override final
     {
+        elapse(8 * timing.bit);
         // if multiple devices are answering, the result is a binary AND
         // This will only give valid responses with single bit replies, just like the real hardware
         v = 0xFF;
         for (auto& device : devices) {
             v &= device->read();
         }
+        v ^= injectedError();
         return true;
     }
 
     virtual bool write(uint8_t b) override final
     {
+        elapse(8 * timing.bit);
         for (auto& device : devices) {
             device->write(b);
         }
@@ -77,7 +90,7 @@ public:
 
     virtual bool reset() override final
     {
-
+        elapse(timing.reset);
         bool devicePresent = false;
         for (auto& device : devices) {
             devicePresent |= device->reset();
@@ -90,6 +103,77 @@ public:
         devices.push_back(std::move(device));
     }
 
+    const std::vector<std::shared_ptr<OneWireMockDevice>>& attached() const
+    {
+        return devices;
+    }
+
+    // Non-blocking operations are executed when started, but report busy for a fixed number of polls.
+    // This makes the timing of asynchronous transactions deterministic in tests.
+    // With a clock set, they also report busy until the duration of the operation has passed on the clock.
+    virtual bool start(AsyncOp op, uint8_t value) override final;
+    virtual AsyncStatus poll(uint8_t& result) override final;
+
+    void setAsyncLatency(uint8_t polls)
+    {
+        asyncLatency = polls;
+    }
+
+    // number of polls that returned busy since construction
+    uint32_t busyPolls() const
+    {
+        return busyPollCount;
+    }
+
+    void setTiming(const Timing& t)
+    {
+        timing = t;
+    }
+
+    // Without a clock, time only advances by bus operations and blocking operations return immediately.
+    // With a clock, blocking operations wait for their duration, like the hardware would.
+    void setClock(OneWireClock clock_)
+    {
+        clock = clock_;
+    }
+
+    // total time the bus has been busy in microseconds
+    duration_micros_t busTime() const
+    {
+        return busyTime;
+    }
+
+    // Corrupt a random bit in the given fraction of the bytes read (per million).
+    // The pseudo random sequence is seeded, so a load test can be reproduced.
+    void setReadErrorRate(uint32_t perMillion, uint32_t seed = 1)
+    {
+        readErrorRate = perMillion;
+        randomState = seed ? seed : 1;
+    }
+
+    uint32_t injectedErrors() const
+    {
+        return injectedErrorCount;
+    }
+
 private:
     std::vector<std::shared_ptr<OneWireMockDevice>> devices;
+    uint8_t asyncLatency = 0;
+    uint8_t asyncRemaining = 0;
+    uint8_t asyncResult = 0;
+    bool asyncPending = false;
+    uint32_t busyPollCount = 0;
+    Timing timing;
+    OneWireClock clock = nullptr;
+    duration_micros_t busyTime = 0;
+    ticks_micros_t asyncStart = 0;
+    duration_micros_t asyncDuration = 0;
+    bool asyncOp = false; // an operation is started with start(), it is waited for in poll()
+    uint32_t readErrorRate = 0;
+    uint32_t randomState = 1;
+    uint32_t injectedErrorCount = 0;
+
+    // advance the bus time for an operation and pass the time to the devices
+    void elapse(const duration_micros_t& duration);
+    uint8_t injectedError();
 };
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the Brewblox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireMockDriver.h"
+#include <istream>
+
+/**
+ * Attaches mock devices to a mock bus from a text description, to simulate a bus with many devices.
+ * Each line describes one device:
+ *
+ *     <type> <address> [option...]
+ *
+ * - type: DS18B20, DS2408 or DS2413
+ * - address: hex bytes in the order of OneWireAddress::toString(), starting with the family code.
+ *   With 7 bytes, the CRC byte is added.
+ * - options:
+ *   - temp=<degrees>: temperature of a DS18B20
+ *   - conversion=<microseconds>: conversion time of a DS18B20, instant by default
+ *   - disconnected: the device does not respond until it is connected
+ *
+ * Empty lines and lines starting with # are ignored, as are lines that cannot be parsed.
+ * Returns the number of devices that were attached.
+ */
+uint16_t
+loadMockPopulation(OneWireMockDriver& driver, std::istream& in);
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the Brewblox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWire.h"
+#include <vector>
+
+/**
+ * The OneWire buses of the system, each with its own transaction queue.
+ * A bus is identified by its index, in the order in which the buses were added.
+ *
+ * process() advances the queues of all buses in turns of a limited number of operations.
+ * Each bus master works on its own bus, so while one bus waits for its master, the others make progress.
+ * The bus that gets the first turn rotates, so a slow or failing bus cannot starve the others.
+ */
+class OneWireScheduler {
+public:
+    static constexpr const uint8_t noBus = 0xFF;
+
+private:
+    std::vector<OneWire*> buses;
+    uint8_t first = 0;
+    uint16_t stepsPerTurn;
+
+public:
+    explicit OneWireScheduler(uint16_t stepsPerTurn_ = 4)
+        : stepsPerTurn(stepsPerTurn_)
+    {
+    }
+    OneWireScheduler(const OneWireScheduler&) = delete;
+    OneWireScheduler& operator=(const OneWireScheduler&) = delete;
+    ~OneWireScheduler() = default;
+
+    // returns the index of the added bus
+    uint8_t add(OneWire& bus);
+
+    uint8_t size() const
+    {
+        return buses.size();
+    }
+
+    // the bus with the given index, nullptr if it doesn't exist
+    OneWire* bus(uint8_t index) const
+    {
+        return index < buses.size() ? buses[index] : nullptr;
+    }
+
+    // the index of a bus, noBus if it was not added
+    uint8_t indexOf(const OneWire& bus) const;
+
+    // Advance the transactions of all buses without waiting. Returns true while transactions are pending.
+    bool process();
+};
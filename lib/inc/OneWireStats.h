@@ -0,0 +1,89 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the Brewblox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "TicksTypes.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// microsecond clock used to measure transaction latency, can be nullptr when latency is not measured
+using OneWireClock = ticks_micros_t (*)();
+
+/*
+ * A window with the most recent latency samples.
+ * A new sample replaces the oldest one, so recording a sample never allocates.
+ */
+template <uint8_t N>
+class LatencyWindow {
+private:
+    std::array<duration_micros_t, N> samples = {0};
+    uint8_t next = 0;
+    uint8_t count = 0;
+
+public:
+    void add(const duration_micros_t& sample)
+    {
+        samples[next] = sample;
+        next = (next + 1) % N;
+        if (count < N) {
+            ++count;
+        }
+    }
+
+    uint8_t size() const
+    {
+        return count;
+    }
+
+    // the sample below which the given percentage of samples falls, 0 if no samples are recorded
+    duration_micros_t percentile(uint8_t percent) const
+    {
+        if (count == 0) {
+            return 0;
+        }
+        auto sorted = samples;
+        auto rank = std::min<uint16_t>(uint16_t(count) * percent / 100, count - 1);
+        std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + count);
+        return sorted[rank];
+    }
+
+    duration_micros_t max() const
+    {
+        return count ? *std::max_element(samples.begin(), samples.begin() + count) : 0;
+    }
+};
+
+/*
+ * Error and latency counters of a OneWire bus or device
+ */
+struct OneWireStats {
+    uint32_t resets = 0;          // reset pulses sent on the bus
+    uint32_t presenceErrors = 0;  // resets or selects without a presence pulse
+    uint32_t crcErrors = 0;       // reads with an invalid CRC
+    uint32_t retries = 0;         // reads that were retried
+    uint32_t resetDetections = 0; // devices that lost power and their configuration
+    LatencyWindow<16> latency;    // duration of the last reads in microseconds
+
+    uint32_t errors() const
+    {
+        return presenceErrors + crcErrors + resetDetections;
+    }
+};
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the Brewblox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OneWireAddress.h"
+#include "OneWireLowLevelInterface.h"
+#include "OneWireStats.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/**
+ * A sequence of bus operations that is executed without interruption by other devices.
+ * The bytes read by the transaction are passed to the completion callback.
+ */
+class OneWireTransaction {
+public:
+    using Op = OneWireLowLevelInterface::AsyncOp;
+
+    struct Step {
+        Op op;
+        uint8_t value;
+    };
+
+    OneWireTransaction() = default;
+    ~OneWireTransaction() = default;
+
+    // Reset pulse. The transaction fails if no device responds with a presence pulse.
+    OneWireTransaction& reset()
+    {
+        steps.push_back({Op::RESET, 0});
+        return *this;
+    }
+
+    // Match ROM, address a single device
+    OneWireTransaction& select(const OneWireAddress& rom)
+    {
+        write(0x55);
+        for (uint8_t i = 0; i < 8; i++) {
+            write(rom[i]);
+        }
+        return *this;
+    }
+
+    // Skip ROM, address all devices on the bus
+    OneWireTransaction& skip()
+    {
+        return write(0xCC);
+    }
+
+    OneWireTransaction& write(uint8_t b)
+    {
+        steps.push_back({Op::WRITE, b});
+        return *this;
+    }
+
+    OneWireTransaction& read(uint8_t count)
+    {
+        for (uint8_t i = 0; i < count; i++) {
+            steps.push_back({Op::READ, 0});
+        }
+        return *this;
+    }
+
+    OneWireTransaction& readBit()
+    {
+        steps.push_back({Op::READ_BIT, 0});
+        return *this;
+    }
+
+    // One bit of a ROM search: 2 read bits and 1 write bit. The status byte is passed to the callback like a read.
+    OneWireTransaction& searchTriplet(bool direction)
+    {
+        steps.push_back({Op::SEARCH_TRIPLET, direction ? uint8_t(1) : uint8_t(0)});
+        return *this;
+    }
+
+    const std::vector<Step>& getSteps() const
+    {
+        return steps;
+    }
+
+    // Typical duration of an operation at standard speed: a reset pulse with presence detect, or 8 time slots for a byte
+    static duration_micros_t expectedDuration(Op op)
+    {
+        switch (op) {
+        case Op::RESET:
+            return 960;
+        case Op::WRITE:
+        case Op::READ:
+            return 560;
+        case Op::READ_BIT:
+        case Op::WRITE_BIT:
+            return 70;
+        case Op::SEARCH_TRIPLET:
+            return 210;
+        }
+        return 0;
+    }
+
+private:
+    std::vector<Step> steps;
+};
+
+/**
+ * Executes OneWire transactions one by one, without blocking the caller.
+ * Devices submit a transaction with a completion callback. The owner of the bus calls process() from the main loop,
+ * which advances the active transaction as far as the driver allows without waiting for it.
+ */
+class OneWireTransactionQueue {
+public:
+    // Passed to the completion callback of a transaction
+    struct Result {
+        bool success;                     // false when an operation failed
+        const std::vector<uint8_t>& data; // bytes read by the transaction
+        uint8_t crc;                      // CRC8 of the data, computed while it arrives. 0 when it ends with its valid CRC
+        duration_micros_t latency;        // time on the bus in microseconds, 0 without a clock
+    };
+
+    using Callback = std::function<void(const Result& result)>;
+
+    explicit OneWireTransactionQueue(OneWireLowLevelInterface& driver_, OneWireClock clock_ = nullptr)
+        : driver(driver_)
+        , clock(clock_)
+    {
+    }
+    OneWireTransactionQueue(const OneWireTransactionQueue&) = delete;
+    OneWireTransactionQueue(OneWireTransactionQueue&&) = default;
+    OneWireTransactionQueue& operator=(const OneWireTransactionQueue&) = delete;
+    ~OneWireTransactionQueue() = default;
+
+    // Add a transaction to the queue. The owner can be used to cancel its transactions.
+    void submit(const void* owner, OneWireTransaction&& transaction, Callback&& callback);
+
+    // Remove all transactions of an owner, for example when the owner is destroyed.
+    // A transaction that is in progress is finished on the bus, but its callback is not called.
+    void cancel(const void* owner);
+
+    // Advance the queue without waiting, by at most maxSteps operations. Returns true while transactions are pending.
+    bool process(uint16_t maxSteps = UINT16_MAX);
+
+    // Process until the queue is empty.
+    // Like the blocking drivers, it gives up when the bus master stops making progress and returns false then.
+    bool flush();
+
+    // Process until the transaction that is in progress on the bus has completed, without starting the next one.
+    // Blocking bus operations use this so they don't interleave with a transaction, the rest of the queue waits.
+    bool finishActive();
+
+    // Expected time until the last queued transaction of the owner has completed, 0 if it has none queued.
+    // Based on the typical duration of the remaining operations before it, so the owner knows when to check again.
+    duration_micros_t expectedCompletion(const void* owner) const;
+
+    bool busy() const
+    {
+        return !queue.empty();
+    }
+
+    // number of operations that completed since construction, to detect progress
+    uint32_t completedSteps() const
+    {
+        return completed;
+    }
+
+    // statistics of the bus, counted by the queue and by blocking operations
+    OneWireStats& stats()
+    {
+        return m_stats;
+    }
+
+    const OneWireStats& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    // flush() and finishActive() give up when no operation completes within this time, or this number of polls without a clock
+    static constexpr const duration_micros_t flushTimeout = 10000;
+    static constexpr const uint16_t flushRetries = 100;
+
+    struct Entry {
+        const void* owner;
+        OneWireTransaction transaction;
+        Callback callback;
+    };
+
+    OneWireLowLevelInterface& driver;
+    OneWireClock clock;
+    OneWireStats m_stats;
+    std::deque<Entry> queue;
+    std::vector<uint8_t> data; // bytes read by the active transaction
+    uint16_t step = 0;         // index of the active step in the active transaction
+    uint8_t crc = 0;           // CRC8 of the bytes read by the active transaction
+    uint32_t completed = 0;    // operations completed since construction
+    uint32_t finished = 0;     // transactions finished since construction
+    bool started = false;      // the active step is started on the driver
+    bool processing = false;   // guards against processing the queue from a callback
+    ticks_micros_t activeSince = 0;
+
+    bool active() const
+    {
+        return !queue.empty() && (step > 0 || started);
+    }
+
+    void finish(bool success);
+    bool processUntil(bool activeOnly);
+};
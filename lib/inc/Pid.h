@@ -21,6 +21,7 @@
 
 #include "ProcessValue.h"
 #include "SetpointSensorPair.h"
+#include "TicksTypes.h"
 #include <cstring>
 #include <functional>
 
@@ -73,7 +74,8 @@ public:
 
     void init();
 
-    void update();
+    // elapsed is the time since the previous update, which scales the integral increase
+    void update(const duration_millis_t& elapsed = 1000);
 
     // state
     auto error() const
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ActuatorOffset.h"
+#include "Pid.h"
+#include "ProcessValue.h"
+#include "SetpointSensorPair.h"
+#include <functional>
+#include <memory>
+
+/*
+ * Two PIDs in cascade, updated together.
+ *
+ * The outer PID controls the outer process value (for example beer temperature) by setting the setpoint of the
+ * inner process value (for example fridge or glycol temperature) to the outer setting + its output, like an
+ * ActuatorOffset. The inner PID drives the actuator. Both run in the same update, so the inner loop acts on a new
+ * inner setpoint right away, instead of an update interval later.
+ *
+ * Optionally, a feed-forward term is added to the inner setpoint: gain * (feed-forward value - outer setting).
+ * With the ambient temperature as feed-forward value, the inner setpoint is corrected for heat ingress before it
+ * shows up as an error in the outer loop. The feed-forward term is hidden from the outer PID, so it doesn't cause
+ * integrator windup.
+ */
+class PidCascade {
+public:
+    using in_t = Pid::in_t;
+    using out_t = Pid::out_t;
+
+private:
+    // The output of the outer PID: an offset from the outer setting, with the feed-forward term added
+    class InnerSetpoint final : public ProcessValue<out_t> {
+    private:
+        ActuatorOffset m_offset;
+        out_t m_feedForward = 0;
+
+    public:
+        InnerSetpoint(
+            std::function<std::shared_ptr<SetpointSensorPair>()>&& target,
+            std::function<std::shared_ptr<SetpointSensorPair>()>&& reference)
+            : m_offset(std::move(target), std::move(reference))
+        {
+        }
+
+        virtual void setting(const out_t& v) override final
+        {
+            m_offset.setting(v + m_feedForward);
+        }
+
+        virtual out_t setting() const override final
+        {
+            return m_offset.setting() - m_feedForward;
+        }
+
+        virtual out_t value() const override final
+        {
+            return m_offset.value() - m_feedForward;
+        }
+
+        virtual bool valueValid() const override final
+        {
+            return m_offset.valueValid();
+        }
+
+        virtual bool settingValid() const override final
+        {
+            return m_offset.settingValid();
+        }
+
+        virtual void settingValid(bool v) override final
+        {
+            m_offset.settingValid(v);
+        }
+
+        void feedForward(const out_t& v)
+        {
+            m_feedForward = v;
+        }
+
+        out_t feedForward() const
+        {
+            return m_feedForward;
+        }
+
+        // the offset written to the inner setpoint, including feed-forward
+        out_t offset() const
+        {
+            return m_offset.setting();
+        }
+    };
+
+    const std::function<std::shared_ptr<SetpointSensorPair>()> m_outerInput;
+    const std::function<std::shared_ptr<ProcessValue<temp_t>>()> m_feedForwardInput;
+
+    InnerSetpoint m_innerSetpoint;
+    Pid m_outer;
+    Pid m_inner;
+
+    in_t m_feedForwardGain = 0;
+
+public:
+    explicit PidCascade(
+        std::function<std::shared_ptr<SetpointSensorPair>()>&& outerInput, // process value to control
+        std::function<std::shared_ptr<SetpointSensorPair>()>&& innerInput, // process value that the outer PID sets
+        std::function<std::shared_ptr<ProcessValue<out_t>>()>&& output,    // actuator driven by the inner PID
+        std::function<std::shared_ptr<ProcessValue<temp_t>>()>&& feedForwardInput = nullptr);
+
+    PidCascade(const PidCascade&) = delete;
+    PidCascade& operator=(const PidCascade&) = delete;
+
+    ~PidCascade() = default;
+
+    // update the outer PID, then the inner PID with the new inner setpoint
+    void update(const duration_millis_t& elapsed = 1000);
+
+    Pid& outer()
+    {
+        return m_outer;
+    }
+
+    const Pid& outer() const
+    {
+        return m_outer;
+    }
+
+    Pid& inner()
+    {
+        return m_inner;
+    }
+
+    const Pid& inner() const
+    {
+        return m_inner;
+    }
+
+    void enabled(bool v)
+    {
+        m_outer.enabled(v);
+        m_inner.enabled(v);
+    }
+
+    bool enabled() const
+    {
+        return m_outer.enabled() && m_inner.enabled();
+    }
+
+    bool active() const
+    {
+        return m_outer.active() && m_inner.active();
+    }
+
+    in_t feedForwardGain() const
+    {
+        return m_feedForwardGain;
+    }
+
+    void feedForwardGain(const in_t& v)
+    {
+        m_feedForwardGain = v;
+    }
+
+    // feed-forward term of the last update
+    out_t feedForward() const
+    {
+        return m_innerSetpoint.feedForward();
+    }
+
+    // offset of the inner setpoint from the outer setting: outer PID output + feed-forward
+    out_t innerOffset() const
+    {
+        return m_innerSetpoint.offset();
+    }
+};
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Generates the edges of multiple PWM outputs from a single timer.
+ *
+ * Each channel has a period and an active time in timer ticks. The scheduler keeps the channels sorted by the
+ * time of their next edge, so the timer only has to interrupt at that time, instead of at every tick.
+ * The cost of PWM is then proportional to the number of edges per second, not to the number of channels.
+ *
+ * The scheduler doesn't depend on the hardware: the platform calls process() when the timer compare fires and
+ * programs the compare to the time it returns. Time is a free running tick count that is allowed to wrap.
+ * Changing channels while process() can be called from an interrupt should be done with interrupts disabled.
+ */
+class PwmScheduler {
+public:
+    using ticks_t = uint32_t;
+    // sets the output of a channel, called from process()
+    using Output = std::function<void(bool active)>;
+
+    static constexpr uint8_t maxChannels = 8;
+    static constexpr uint8_t noChannel = 0;
+
+private:
+    struct Channel {
+        uint8_t id = noChannel;
+        Output output;
+        ticks_t period = 0;
+        ticks_t activeTime = 0;
+        ticks_t nextPeriod = 0; // applied at the start of the next period
+        ticks_t nextActiveTime = 0;
+        ticks_t periodStart = 0;
+        ticks_t nextEdge = 0;
+        bool active = false;
+    };
+
+    std::array<Channel, maxChannels> channels;
+    std::array<uint8_t, maxChannels> order; // indices of the used channels, sorted by next edge
+    uint8_t count = 0;
+    uint8_t lastId = noChannel;
+    uint32_t edges = 0;
+
+public:
+    PwmScheduler() = default;
+    PwmScheduler(const PwmScheduler&) = delete;
+    PwmScheduler& operator=(const PwmScheduler&) = delete;
+    ~PwmScheduler() = default;
+
+    // Add a channel that starts its first period at now. Returns the channel id, noChannel when all channels are used.
+    uint8_t add(Output&& output, ticks_t period, ticks_t activeTime, ticks_t now);
+
+    void remove(uint8_t id);
+
+    // Change the period and active time of a channel. The change is applied at the start of the next period.
+    void set(uint8_t id, ticks_t period, ticks_t activeTime);
+
+    // Generate the edges that are due. Returns the time of the next edge.
+    ticks_t process(ticks_t now);
+
+    // time of the next edge, only valid when not empty
+    ticks_t nextEdge() const
+    {
+        return channels[order[0]].nextEdge;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    uint8_t size() const
+    {
+        return count;
+    }
+
+    // total number of edges generated, for profiling
+    uint32_t edgeCount() const
+    {
+        return edges;
+    }
+
+private:
+    Channel* find(uint8_t id);
+    void edge(Channel& c, ticks_t now);
+    void sortFirst();
+};
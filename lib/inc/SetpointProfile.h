@@ -22,7 +22,7 @@
 #include "SetpointSensorPair.h"
 #include "Temperature.h"
 #include "TicksTypes.h"
-#include <algorithm>
+#include <cstdint>
 #include <vector>
 
 class SetpointProfile {
@@ -32,17 +32,154 @@ public:
         temp_t temp;
     };
 
+    class Points;
+
+    /**
+     * Iterates over encoded points, decoding them one at a time.
+     */
+    class PointIterator {
+    public:
+        PointIterator(const std::vector<uint8_t>& encoded, size_t pos)
+            : m_encoded(&encoded)
+            , m_pos(pos)
+            , m_next(pos)
+            , m_point{0, temp_t(0)}
+        {
+            decode();
+        }
+
+        Point operator*() const
+        {
+            return m_point;
+        }
+
+        const Point* operator->() const
+        {
+            return &m_point;
+        }
+
+        PointIterator& operator++()
+        {
+            m_pos = m_next;
+            decode();
+            return *this;
+        }
+
+        bool operator==(const PointIterator& other) const
+        {
+            return m_pos == other.m_pos;
+        }
+
+        bool operator!=(const PointIterator& other) const
+        {
+            return m_pos != other.m_pos;
+        }
+
+    private:
+        friend class Points;
+
+        const std::vector<uint8_t>* m_encoded;
+        size_t m_pos;  // position of the current point
+        size_t m_next; // position of the next point
+        Point m_point;
+
+        void decode();
+    };
+
+    /**
+     * A compact sequence of points.
+     * Each point is stored as the difference with the previous point:
+     * seconds and raw temperature, both as zig-zag encoded varints.
+     * A point with a few hours and a few degrees between it and the previous point takes 5 bytes instead of 8.
+     */
+    class Points {
+    public:
+        void push_back(const Point& p);
+
+        void clear()
+        {
+            m_encoded.clear();
+            m_last = Point{0, temp_t(0)};
+            m_count = 0;
+        }
+
+        void append(const Points& other)
+        {
+            for (const auto& p : other) {
+                push_back(p);
+            }
+        }
+
+        // keep only the first count points
+        void truncate(size_t count);
+
+        // release the memory reserved for points that are not added yet
+        void shrink_to_fit()
+        {
+            m_encoded.shrink_to_fit();
+        }
+
+        PointIterator begin() const
+        {
+            return PointIterator(m_encoded, 0);
+        }
+
+        PointIterator end() const
+        {
+            return PointIterator(m_encoded, m_encoded.size());
+        }
+
+        size_t size() const
+        {
+            return m_count;
+        }
+
+        bool empty() const
+        {
+            return m_count == 0;
+        }
+
+        // number of bytes used to store the points
+        size_t encodedSize() const
+        {
+            return m_encoded.size();
+        }
+
+    private:
+        std::vector<uint8_t> m_encoded;
+        Point m_last{0, temp_t(0)};
+        size_t m_count = 0;
+    };
+
 private:
     const std::function<std::shared_ptr<SetpointSensorPair>()> m_target;
     utc_seconds_t m_profileStartTime = 0;
     bool m_enabled = true;
 
-    std::vector<Point> m_points;
+    Points m_points;
+
+    // Cursor on the current segment, it only moves forward while time moves forward.
+    // m_lower is the last point that is not in the future, m_upper is the point after it.
+    PointIterator m_upper;
+    Point m_lower{0, temp_t(0)};
+    bool m_started = false;  // false when the first point is still in the future
+    int64_t m_slope = 0;     // raw temperature change per second in the current segment, scaled by 2^slopeShift
+    bool m_slopeValid = false;
+
+    static constexpr const uint8_t slopeShift = 24;
+
+    void resetCursor()
+    {
+        m_upper = m_points.begin();
+        m_started = false;
+        m_slopeValid = false;
+    }
 
 public:
     explicit SetpointProfile(
         std::function<std::shared_ptr<SetpointSensorPair>()>&& target) // process value to manipulate setpoint of
         : m_target(target)
+        , m_upper(m_points.begin())
     {
     }
     SetpointProfile(const SetpointProfile&) = delete;
@@ -51,12 +188,14 @@ public:
 
     void addPoint(Point&& p)
     {
-        m_points.push_back(std::move(p));
+        m_points.push_back(p);
+        resetCursor();
     }
 
     void removeAllPoints()
     {
         m_points.clear();
+        resetCursor();
     }
 
     bool isDriving() const
@@ -76,14 +215,34 @@ public:
         m_enabled = v;
     }
 
-    const std::vector<Point>& points() const
+    const Points& points() const
     {
         return m_points;
     }
 
-    void points(std::vector<Point>&& newPoints)
+    /**
+     * Profiles can be uploaded in chunks. These functions apply a chunk to the existing points.
+     */
+    void appendPoints(const Points& newPoints)
+    {
+        m_points.append(newPoints);
+        resetCursor();
+    }
+
+    // replace the points starting at index start, extending the profile if needed
+    bool replacePoints(size_t start, const Points& newPoints);
+
+    void truncatePoints(size_t count)
+    {
+        m_points.truncate(count);
+        resetCursor();
+    }
+
+    void points(Points&& newPoints)
     {
-        m_points = newPoints;
+        m_points = std::move(newPoints);
+        m_points.shrink_to_fit();
+        resetCursor();
     }
 
     utc_seconds_t startTime() const
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ActuatorDigitalBase.h"
+#include "TicksTypes.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/*
+ * A long history of state changes of a digital actuator, stored compactly in a ring of bytes.
+ *
+ * Each change is encoded as the time since the previous change, shifted left by 2 bits with the new state in the
+ * lower bits, as a variable length integer with 7 bits per byte. A change within 4 seconds takes 2 bytes, within
+ * 8 minutes 3 bytes. When the ring is full, the oldest changes are dropped.
+ *
+ * The total number of activations and the total active time are counted separately, so they are not limited by the
+ * size of the ring.
+ */
+class StateHistory {
+public:
+    using State = ActuatorDigitalBase::State;
+
+    struct Aggregates {
+        uint32_t activations = 0;  // changes to active
+        uint32_t changes = 0;      // all logged changes
+        uint64_t activeMillis = 0; // total time active
+        bool complete = false;     // false when the period started before the oldest logged change
+    };
+
+private:
+    std::vector<uint8_t> m_buffer;
+    uint16_t m_head = 0;               // position of the oldest byte
+    uint16_t m_used = 0;               // number of bytes used
+    uint16_t m_count = 0;              // number of logged changes
+    ticks_millis_t m_baseTime = 0;     // time that the delta of the oldest change is relative to
+    ticks_millis_t m_lastTime = 0;     // time of the newest change
+    State m_lastState = State::Unknown;
+    uint32_t m_totalActivations = 0;
+    uint64_t m_totalActiveMillis = 0; // excluding the time since the last change
+
+public:
+    // capacity in bytes, at least 5 bytes are needed to log any change
+    explicit StateHistory(uint16_t capacity)
+        : m_buffer(capacity)
+    {
+    }
+    StateHistory(const StateHistory&) = delete;
+    StateHistory& operator=(const StateHistory&) = delete;
+    ~StateHistory() = default;
+
+    // log a change to a new state, times should not decrease
+    void add(const State& state, const ticks_millis_t& time);
+
+    void clear();
+
+    // visit the logged changes from old to new
+    void forEach(const std::function<void(const State& state, const ticks_millis_t& time)>& visit) const;
+
+    // aggregates of the logged changes between since and now
+    Aggregates aggregate(const ticks_millis_t& since, const ticks_millis_t& now) const;
+
+    // aggregates since the history was created, not limited by its capacity
+    Aggregates totals(const ticks_millis_t& now) const;
+
+    // Write the history as: age in ms of the base time (uint32), number of changes (uint16), number of bytes (uint16)
+    // and the encoded changes from old to new. Multi-byte values are little endian.
+    // Returns false when a write failed.
+    bool streamTo(const std::function<bool(uint8_t)>& write, const ticks_millis_t& now) const;
+
+    uint16_t capacity() const
+    {
+        return m_buffer.size();
+    }
+
+    uint16_t bytesUsed() const
+    {
+        return m_used;
+    }
+
+    uint16_t size() const
+    {
+        return m_count;
+    }
+
+private:
+    uint8_t decode(uint16_t pos, ticks_millis_t& delta, State& state) const;
+    void dropOldest();
+};
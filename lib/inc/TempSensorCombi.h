@@ -20,12 +20,10 @@
 #pragma once
 
 #include "TempSensor.h"
+#include "TicksTypes.h"
 #include <functional>
 #include <memory>
 #include <vector>
-/*
- * A process value has a setting and an current value
- */
 class TempSensorCombi : public TempSensor {
 public:
     enum class CombineFunc : uint8_t {
@@ -33,14 +31,36 @@ public:
         AVG = 0,
         MIN = 1,
         MAX = 2,
+        MEDIAN = 3,
+    };
+
+    struct Input {
+        Input(std::function<std::shared_ptr<TempSensor>()>&& lookup_, uint8_t weight_ = 1)
+            : lookup(std::move(lookup_))
+            , weight(weight_)
+        {
+        }
+
+        std::function<std::shared_ptr<TempSensor>()> lookup;
+        uint8_t weight;              // weight in the average, inputs with weight 0 are ignored for AVG
+        duration_millis_t stale = 0; // time since this input last had a valid value
     };
 
-    std::vector<std::function<std::shared_ptr<TempSensor>()>> inputs;
+    std::vector<Input> inputs;
     CombineFunc func = CombineFunc::AVG;
+    temp_t outlierThreshold = temp_t{0}; // inputs further than this from the median are ignored, 0 to disable
 
 private:
+    struct Sample {
+        temp_t value;
+        uint8_t weight;
+    };
+
     temp_t m_value = temp_t{0};
     bool m_valid = false;
+    ticks_millis_t m_lastUpdate = 0;
+    bool m_updated = false;
+    std::vector<Sample> m_samples; // valid input values, kept to reuse the allocation
 
 public:
     TempSensorCombi() = default;
@@ -56,5 +76,9 @@ public:
         return m_value;
     }
 
-    void update();
+    void update(const ticks_millis_t& now);
+
+private:
+    void sortSamples();
+    temp_t median() const;
 };
@@ -1,9 +1,19 @@
+#pragma once
+
+#include "PwmScheduler.h"
 #include <cinttypes>
-#include <functional>
 
+/**
+ * Hardware timer that generates the edges of fast PWM outputs.
+ * The timer compare is programmed for the next edge of the PwmScheduler, so it only interrupts when an output toggles.
+ */
 class TimerInterrupts {
 public:
+    static constexpr uint32_t ticksPerSecond = 10000;
+
     static void init();
-    static int16_t add(std::function<void()>&& func);
-    static void remove(uint8_t id);
+    // returns the PWM channel id, 0 when no channel is available
+    static uint8_t addPwm(PwmScheduler::Output&& output, PwmScheduler::ticks_t period, PwmScheduler::ticks_t activeTime);
+    static void setPwm(uint8_t id, PwmScheduler::ticks_t period, PwmScheduler::ticks_t activeTime);
+    static void removePwm(uint8_t id);
 };
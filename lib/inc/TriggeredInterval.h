@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "TicksTypes.h"
+
+/*
+ * Decides when an object that processes input from another object should update.
+ * It updates when triggered by new input, but not faster than MIN_INTERVAL.
+ * Without new input it still updates every MAX_INTERVAL, so missing input is detected.
+ */
+template <ticks_millis_t MIN_INTERVAL, ticks_millis_t MAX_INTERVAL>
+class TriggeredInterval {
+private:
+    ticks_millis_t m_lastUpdate = -MAX_INTERVAL;
+    duration_millis_t m_elapsed = 0;
+    bool m_triggered = false;
+
+public:
+    TriggeredInterval() = default;
+    TriggeredInterval(const TriggeredInterval&) = delete;
+    TriggeredInterval& operator=(const TriggeredInterval&) = delete;
+    ~TriggeredInterval() = default;
+
+    // signal that new input is available
+    void trigger()
+    {
+        m_triggered = true;
+    }
+
+    ticks_millis_t update(const ticks_millis_t& now, bool& doUpdate)
+    {
+        auto elapsed = now - m_lastUpdate;
+
+        if ((m_triggered && elapsed >= MIN_INTERVAL) || elapsed >= MAX_INTERVAL) {
+            doUpdate = true;
+            m_triggered = false;
+            m_elapsed = elapsed < MAX_INTERVAL ? elapsed : MAX_INTERVAL;
+            m_lastUpdate = now;
+            return now + MAX_INTERVAL;
+        }
+        if (m_triggered) {
+            // postpone until minimum interval has passed
+            return m_lastUpdate + MIN_INTERVAL;
+        }
+        return m_lastUpdate + MAX_INTERVAL;
+    }
+
+    // time between the last two updates, at most MAX_INTERVAL
+    duration_millis_t elapsed() const
+    {
+        return m_elapsed;
+    }
+};
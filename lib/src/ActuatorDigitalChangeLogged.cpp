@@ -56,6 +56,9 @@ ActuatorDigitalChangeLogged::update(const ticks_millis_t& now)
     if (state() != history.front().newState) {
         std::rotate(history.rbegin(), history.rbegin() + 1, history.rend());
         history[0] = {state(), now};
+        if (longHistory) {
+            longHistory->add(history[0].newState, now);
+        }
     }
     lastUpdateTime = now;
 }
@@ -139,6 +142,29 @@ ActuatorDigitalChangeLogged::resetHistory()
     lastUpdateTime = 0;
 }
 
+bool
+ActuatorDigitalChangeLogged::stateHistorySize(uint16_t bytes)
+{
+    if (bytes > maxStateHistorySize) {
+        return false;
+    }
+    if (bytes == 0) {
+        longHistory.reset();
+        return true;
+    }
+    if (!longHistory || longHistory->capacity() != bytes) {
+        longHistory = std::make_unique<StateHistory>(bytes);
+        longHistory->add(history[0].newState, history[0].startTime); // start with the current state
+    }
+    return true;
+}
+
+uint16_t
+ActuatorDigitalChangeLogged::stateHistorySize() const
+{
+    return longHistory ? longHistory->capacity() : 0;
+}
+
 bool
 ActuatorDigitalChangeLogged::supportsFastIo() const
 {
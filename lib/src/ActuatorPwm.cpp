@@ -17,6 +17,11 @@ ActuatorPwm::ActuatorPwm(
 void
 ActuatorPwm::setting(const value_t& val)
 {
+    if (val - m_dutySetting > value_t{1} || m_dutySetting - val > value_t{1}) {
+        // The window compensation handles the transition to the new setting.
+        // Small changes, like the output of a PID, keep the carried error.
+        pauseDiffusion();
+    }
     if (val <= value_t{0}) {
         m_dutySetting = value_t{0};
         m_dutyTime = 0;
@@ -28,6 +33,11 @@ ActuatorPwm::setting(const value_t& val)
         auto unScaledTime = m_dutySetting * m_period;
         m_dutyTime = uint64_t(unScaledTime) / 100;
     }
+#if PLATFORM_ID != PLATFORM_GCC
+    if (timerPwmId) {
+        TimerInterrupts::setPwm(timerPwmId, m_period, m_dutyTime);
+    }
+#endif
 
     settingValid(true);
 }
@@ -52,13 +62,13 @@ ActuatorPwm::manageTimerTask()
 {
     if (m_period < 1000 && m_enabled) {
         m_period = 100;
-        if (!timerFuncId) {
-            timerFuncId = TimerInterrupts::add([this]() { timerTask(); });
+        if (!timerPwmId) {
+            timerPwmId = TimerInterrupts::addPwm([this](bool active) { timerEdge(active); }, m_period, m_dutyTime);
         }
     } else {
-        if (timerFuncId) {
-            TimerInterrupts::remove(timerFuncId);
-            timerFuncId = 0;
+        if (timerPwmId) {
+            TimerInterrupts::removePwm(timerPwmId);
+            timerPwmId = 0;
             m_dutyAchieved = value_t{0};
         }
     }
@@ -69,6 +79,7 @@ void
 ActuatorPwm::period(const duration_millis_t& p)
 {
     m_period = p;
+    pauseDiffusion();
     if (auto actPtr = m_target()) {
         if (p < 1000 && !actPtr->supportsFastIo()) {
             m_period = 1000;
@@ -92,37 +103,28 @@ ActuatorPwm::period() const
 
 #if PLATFORM_ID != PLATFORM_GCC
 void
-ActuatorPwm::timerTask()
+ActuatorPwm::timerEdge(bool active)
 {
-
     // timer clock is 10 kHz, 100 steps at 100Hz
-    if (m_fastPwmElapsed == 0) {
-        auto actPtr = m_target();
-        if (m_dutyTime != 0 && actPtr) {
+    if (auto actPtr = m_target()) {
+        if (active) {
             if (actPtr->state() == State::Active) {
                 m_dutyAchieved = maxDuty(); // was never low
             } else {
                 actPtr->setStateUnlogged(State::Active);
             }
         } else {
-            m_dutyAchieved = value_t{0};
-        }
-        m_fastPwmElapsed = 0;
-    }
-    if (m_fastPwmElapsed == m_dutyTime) {
-        if (auto actPtr = m_target()) {
+            // the target stays off when it could not take its mutex at the active edge
+            m_dutyAchieved = actPtr->state() == State::Active ? m_dutySetting : value_t{0};
             actPtr->setStateUnlogged(State::Inactive);
-            m_dutyAchieved = m_dutySetting;
         }
     }
-
-    m_fastPwmElapsed = m_fastPwmElapsed >= 99 ? 0 : m_fastPwmElapsed + 1;
 }
 
 ActuatorPwm::update_t
 ActuatorPwm::update(const update_t& now)
 {
-    if (timerFuncId) {
+    if (timerPwmId) {
         return now + 1000;
     }
     return slowPwmUpdate(now);
@@ -135,11 +137,60 @@ ActuatorPwm::update(const update_t& now)
 }
 #endif
 
+void
+ActuatorPwm::diffuseError(const ActuatorDigitalChangeLogged::Durations& durations, ticks_millis_t periodStart)
+{
+    if (periodStart != m_periodStart) {
+        // a new period has started, the oldest period leaves the two period window
+        m_periodStart = periodStart;
+        if (m_dutyTime == 0 || m_dutyTime == m_period) {
+            m_dutyResidual = 0; // nothing to compensate at 0% and 100%
+        } else if (m_diffusionPaused > 0) {
+            --m_diffusionPaused;
+        } else if (m_windowOldestActive > 0) {
+            // Only complete periods are carried over.
+            // Like in the window compensation, long periods are compressed to 3 periods, keeping their duty cycle.
+            int64_t period = m_windowOldestPeriod;
+            int64_t active = m_windowOldestActive;
+            int64_t maxPeriod = 3 * m_period;
+            if (period > maxPeriod) {
+                active = active * maxPeriod / period;
+                period = maxPeriod;
+            }
+            m_dutyResidual += period * int64_t(cnl::unwrap(m_dutySetting));
+            m_dutyResidual -= active * int64_t(cnl::unwrap(maxDuty()));
+
+            // limit the correction, the carried error should only be a small part of the period
+            auto limit = int64_t(std::max(m_dutyTime, m_period - m_dutyTime) / 4) * int64_t(cnl::unwrap(maxDuty()));
+            m_dutyResidual = std::max(-limit, std::min(m_dutyResidual, limit));
+        }
+    }
+    m_windowOldestActive = durations.previousActive;
+    m_windowOldestPeriod = durations.previousPeriod;
+}
+
+void
+ActuatorPwm::pauseDiffusion()
+{
+    m_dutyResidual = 0;
+    m_diffusionPaused = 4; // skip the periods that are in the window now and the transition to the new situation
+}
+
+int32_t
+ActuatorPwm::residual() const
+{
+    return m_dutyResidual / int64_t(cnl::unwrap(maxDuty()));
+}
+
 ActuatorPwm::update_t
 ActuatorPwm::slowPwmUpdate(const update_t& now)
 {
     if (auto actPtr = m_target()) {
         auto durations = actPtr->activeDurations(now);
+        auto periodStart = actPtr->getLastStartEndTime(State::Active, now).start;
+        if (periodStart <= now) {
+            diffuseError(durations, periodStart);
+        }
         auto currentHighTime = durations.currentActive;
         auto previousHighTime = durations.previousActive;
         auto previousPeriod = durations.previousPeriod;
@@ -271,13 +322,16 @@ ActuatorPwm::slowPwmUpdate(const update_t& now)
                     wait = minHighTime - currentHighTime;
                 } else {
                     auto maxHighTime = std::max(std::max(m_dutyTime, durations.previousActive), (3 * m_dutyTime) >> 2);
+                    int32_t carried = 0;
                     if (durations.previousPeriod >= m_period) {
                         maxHighTime += maxHighTime / 2; // stretching allowed if previous period was not shortened
+                        carried = residual();           // the carried error is only applied under the same rule
                     }
 
                     if (currentHighTime < maxHighTime) {
                         // for checking the currently achieved value, look back max 2 periods (toggles)
                         auto twoPeriodTargetHighTime = duration_millis_t(twoPeriodElapsed * dutyFraction());
+                        twoPeriodTargetHighTime = duration_millis_t(std::max(int32_t(twoPeriodTargetHighTime) + carried, int32_t(0)));
 
                         // make sure that periods following each other do not continuously alternate in shortend/stretched cycle
                         // by converging to the mean or unadjusted, whichever is higher
@@ -321,13 +375,16 @@ ActuatorPwm::slowPwmUpdate(const update_t& now)
                 } else {
                     auto maxLowTime = std::max(std::max(invDutyTime, durations.previousPeriod - durations.previousActive), (3 * invDutyTime) >> 2);
 
+                    int32_t carried = 0;
                     if (durations.previousPeriod >= m_period) {
                         maxLowTime += maxLowTime / 2; // stretching only allowed if previous period was not shortened
+                        carried = residual();         // the carried error is only applied under the same rule
                     }
 
                     if (currentLowTime < maxLowTime) {
                         // for checking the currently achieved value, look back max 2 periods (toggles)
                         auto twoPeriodTargetLowTime = twoPeriodElapsed - duration_millis_t(dutyFraction() * twoPeriodElapsed);
+                        twoPeriodTargetLowTime = duration_millis_t(std::max(int32_t(twoPeriodTargetLowTime) - carried, int32_t(0)));
                         auto previousLowTime = previousPeriod - previousHighTime;
 
                         // make sure that periods following each other do not continuously alternate in shortend/stretched cycle
@@ -353,6 +410,10 @@ ActuatorPwm::slowPwmUpdate(const update_t& now)
             } else {
                 wait = actPtr->desiredState(State::Inactive, now);
             }
+            if (wait > 0) {
+                // the target is held back by its constraints, which is not an error that can be carried over
+                pauseDiffusion();
+            }
             // update state in case we toggled
             lastHistoricState = actPtr->state();
         }
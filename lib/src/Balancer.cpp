@@ -21,70 +21,140 @@
 
 using value_t = ActuatorAnalog::value_t;
 
+constexpr uint8_t BalancerImpl::noIndex;
+
+BalancerImpl::Request*
+BalancerImpl::find(uint8_t requester_id)
+{
+    if (requester_id < index.size() && index[requester_id] != noIndex) {
+        return &requesters[index[requester_id]];
+    }
+    return nullptr;
+}
+
+const BalancerImpl::Request*
+BalancerImpl::find(uint8_t requester_id) const
+{
+    if (requester_id < index.size() && index[requester_id] != noIndex) {
+        return &requesters[index[requester_id]];
+    }
+    return nullptr;
+}
+
 uint8_t
 BalancerImpl::registerEntry()
 {
-    for (uint8_t id = 1; id < 255; id++) {
-        // find free id
-        auto match = find_if(requesters.begin(), requesters.end(), [&id](const Request& r) {
-            return r.id == id;
-        });
-
-        if (match == requesters.end()) {
-            requesters.push_back(Request{id, available, 0});
-            return id;
-        }
-    };
-    return 0;
+    // use the lowest free id, so ids stay small and the index stays dense
+    uint8_t id = 1;
+    while (id < index.size() && index[id] != noIndex) {
+        ++id;
+    }
+    if (id == 255) {
+        return 0;
+    }
+    if (id >= index.size()) {
+        index.resize(id + 1, noIndex);
+    }
+
+    // requesters are kept in order of id
+    auto pos = std::upper_bound(requesters.begin(), requesters.end(), id, [](const uint8_t& i, const Request& r) { return i < r.id; });
+    pos = requesters.insert(pos, Request{id, available, 0});
+    for (; pos != requesters.end(); ++pos) {
+        index[pos->id] = pos - requesters.begin();
+    }
+    return id;
 }
 
 void
 BalancerImpl::unregisterEntry(const uint8_t& requester_id)
 {
-    requesters.erase(std::remove_if(requesters.begin(), requesters.end(), [&requester_id](const Request& r) { return r.id == requester_id; }),
-                     requesters.end());
+    auto match = find(requester_id);
+    if (!match) {
+        return;
+    }
+    index[requester_id] = noIndex;
+    auto pos = requesters.erase(requesters.begin() + (match - requesters.data()));
+    for (; pos != requesters.end(); ++pos) {
+        index[pos->id] = pos - requesters.begin();
+    }
 }
 
 value_t
 BalancerImpl::constrain(uint8_t& requester_id, const value_t& val)
 {
-    auto match = find_if(requesters.begin(), requesters.end(), [&requester_id](const Request& r) {
-        return r.id == requester_id;
-    });
-
-    if (match != requesters.end()) {
-        match->requested = val;
-        return std::min(val, match->granted);
-    };
-
-    // not found. Could happen is actuator was created before the balancer.
-    // assign new requester id
-    requester_id = registerEntry();
-    return 0;
+    auto match = find(requester_id);
+    if (!match) {
+        // not found. Could happen is actuator was created before the balancer.
+        // assign new requester id
+        requester_id = registerEntry();
+        return 0;
+    }
+
+    match->requested = val;
+    return std::min(val, match->granted);
 }
 
 value_t
 BalancerImpl::granted(const uint8_t& requester_id) const
 {
-    auto match = find_if(requesters.begin(), requesters.end(), [&requester_id](const Request& r) {
-        return r.id == requester_id;
-    });
-
-    if (match == requesters.end()) {
+    auto match = find(requester_id);
+    if (!match) {
         return 0;
     }
 
     return match->granted;
 }
 
+void
+BalancerImpl::configure(const uint8_t& requester_id, uint8_t weight, uint8_t priority, const std::function<void()>& apply)
+{
+    if (auto match = find(requester_id)) {
+        match->weight = weight;
+        match->priority = priority;
+        match->apply = apply;
+    }
+}
+
 void
 BalancerImpl::update()
 {
-    int8_t numActuators = requesters.size(); // signed, because value_t is signed too
-    if (numActuators == 0) {
+    if (requesters.empty()) {
         return;
     }
 
+    switch (m_policy) {
+    case Policy::PROPORTIONAL:
+        grantProportional();
+        break;
+    case Policy::WEIGHTED:
+        grantWeighted();
+        break;
+    case Policy::PRIORITY:
+        grantPriority();
+        break;
+    }
+
+    // the shares are rounded, take what they add up to above the available total off the last grants
+    auto budgetLeft = available;
+    for (auto& a : requesters) {
+        a.granted = std::min(a.granted, budgetLeft);
+        budgetLeft -= a.granted;
+    }
+
+    // The actuators request again while they are set, which only updates their entry.
+    // The callbacks are copied, because a requester could be registered again by its actuator.
+    for (size_t i = 0; i < requesters.size(); i++) {
+        if (auto apply = requesters[i].apply) {
+            apply();
+        }
+    }
+}
+
+void
+BalancerImpl::grantProportional()
+{
+    int8_t numActuators = requesters.size(); // signed, because value_t is signed too
+
     auto requestedTotal = value_t(0);
     for (const auto& a : requesters) {
         requestedTotal += a.requested;
@@ -103,3 +173,77 @@ BalancerImpl::update()
         a.granted += budgetLeftPerActuator;
     }
 }
+
+void
+BalancerImpl::grantWeighted()
+{
+    // Water filling: requests that are smaller than their share are granted fully.
+    // What they don't use is divided again between the others, until the remaining requests are all larger than their share.
+    auto budgetLeft = available;
+    for (auto& a : requesters) {
+        a.granted = 0;
+    }
+    bool satisfiedAny = true;
+    while (satisfiedAny) {
+        satisfiedAny = false;
+        uint16_t totalWeight = 0;
+        for (const auto& a : requesters) {
+            if (a.granted < a.requested) {
+                totalWeight += a.weight;
+            }
+        }
+        if (totalWeight == 0) {
+            break;
+        }
+        for (auto& a : requesters) {
+            if (a.granted < a.requested) {
+                value_t share = cnl::quotient(budgetLeft * a.weight, totalWeight);
+                if (a.requested <= share) {
+                    a.granted = a.requested;
+                    budgetLeft -= a.requested;
+                    satisfiedAny = true;
+                }
+            }
+        }
+        if (!satisfiedAny) {
+            // all remaining requests are larger than their share
+            for (auto& a : requesters) {
+                if (a.granted < a.requested) {
+                    a.granted = cnl::quotient(budgetLeft * a.weight, totalWeight);
+                }
+            }
+            return;
+        }
+    }
+
+    // all requests are granted, divide what is left by weight, so actuators can increase their request
+    uint16_t totalWeight = 0;
+    for (const auto& a : requesters) {
+        totalWeight += a.weight;
+    }
+    if (totalWeight > 0 && budgetLeft > value_t(0)) {
+        for (auto& a : requesters) {
+            a.granted += value_t(cnl::quotient(budgetLeft * a.weight, totalWeight));
+        }
+    }
+}
+
+void
+BalancerImpl::grantPriority()
+{
+    // requesters are in order of id, a stable sort on priority keeps that order for equal priority
+    std::vector<Request*> ordered;
+    ordered.reserve(requesters.size());
+    for (auto& a : requesters) {
+        ordered.push_back(&a);
+    }
+    std::stable_sort(ordered.begin(), ordered.end(), [](const Request* lhs, const Request* rhs) { return lhs->priority > rhs->priority; });
+
+    auto budgetLeft = available;
+    for (auto a : ordered) {
+        a->granted = std::max(std::min(a->requested, budgetLeft), value_t(0));
+        budgetLeft -= a->granted;
+    }
+    // what is left goes to the highest priority, so it can increase its request
+    ordered.front()->granted += budgetLeft;
+}
@@ -22,6 +22,7 @@
 #include "../inc/OneWire.h"
 #include "../inc/OneWireAddress.h"
 #include "../inc/Temperature.h"
+#include <algorithm>
 
 // OneWire commands
 static constexpr const uint8_t STARTCONVO = 0x44;      // Start a new conversion to be read from scratchpad 750ms later
@@ -57,6 +58,7 @@ DS18B20::init()
 {
     ScratchPad scratchPad;
     bool writeSettings = false;
+    m_initPending = false;
 
     // parasitic power is not supported, it is unreliable at higher temperatures or with many devices on the bus
     if (isParasitePowered()) {
@@ -82,14 +84,30 @@ DS18B20::init()
         writeSettings = true;
     }
 
+    // In alarm mode, LOW_ALARM_TEMP is zero in EEPROM too. A sensor that reset then always has an alarm condition,
+    // so it is read and the reset is detected.
+    if (m_alarmMode && scratchPad[LOW_ALARM_TEMP]) {
+        scratchPad[LOW_ALARM_TEMP] = 0;
+        writeSettings = true;
+    }
+
     if (writeSettings) {
         writeScratchPad(scratchPad, true); // save settings to eeprom
     }
-    // Write HIGH_ALARM_TEMP again, but don't save to EEPROM, so that it reverts to 0 on reset
-    // from this point on, if we read a scratchpad with a  different value than 1 HIGH_ALARM (detectedReset() returns true)
-    // it means the device has reset and reloaed the 0 value from EEPROM or the previous write of the scratchpad above was unsuccessful.
+    // Write the alarm thresholds again, but don't save to EEPROM, so that they revert to the EEPROM values on reset
+    // from this point on, if we read a scratchpad with different thresholds than were written (detectedReset() returns true)
+    // it means the device has reset and reloaed the values from EEPROM or the previous write of the scratchpad above was unsuccessful.
     // Either way, initConnection() should be called again
-    scratchPad[HIGH_ALARM_TEMP] = 1;
+    if (m_alarmMode) {
+        // an empty band, the sensor has an alarm condition until the band is set around its first value
+        m_alarmHigh = 0x80; // -128
+        m_alarmLow = 0x7F;  // 127
+    } else {
+        m_alarmHigh = 1;
+        m_alarmLow = scratchPad[LOW_ALARM_TEMP];
+    }
+    scratchPad[HIGH_ALARM_TEMP] = m_alarmHigh;
+    scratchPad[LOW_ALARM_TEMP] = m_alarmLow;
     writeScratchPad(scratchPad, false);
 
     startConversion();
@@ -99,8 +117,26 @@ void
 DS18B20::startConversion()
 {
     selectRom();
-    oneWire.write(STARTCONVO);
-    oneWire.reset();
+    oneWire->write(STARTCONVO);
+    oneWire->reset();
+}
+
+DS18B20::~DS18B20()
+{
+    oneWire->transactions().cancel(this);
+}
+
+void
+DS18B20::bus(OneWire& newBus)
+{
+    if (&newBus == oneWire) {
+        return;
+    }
+    // a pending read on the previous bus is dropped, the sensor is configured again on the new bus
+    oneWire->transactions().cancel(this);
+    m_readPending = false;
+    m_initPending = true;
+    OneWireDevice::bus(newBus);
 }
 
 temp_t
@@ -113,35 +149,175 @@ DS18B20::value() const
     return m_cachedValue;
 }
 
+void
+DS18B20::requestConversion()
+{
+    oneWire->requestConversion();
+    if (m_alarmMode) {
+        oneWire->requestAlarmSearch();
+    }
+}
+
+void
+DS18B20::alarmMode(bool enabled)
+{
+    if (enabled != m_alarmMode) {
+        m_alarmMode = enabled;
+        m_initPending = true; // the alarm thresholds are written again on the next read
+    }
+}
+
+bool
+DS18B20::readNeeded()
+{
+    // A sensor that was not alarmed is still read after maxSkippedReads conversions.
+    // This bounds the age of changes within the band, and recovers when the alarm search missed the sensor.
+
+    // only a search that completed since the last decision tells whether the value changed
+    auto searches = oneWire->alarmSearchCount();
+    bool searched = searches != m_alarmSearches;
+    m_alarmSearches = searches;
+
+    if (!m_alarmMode || m_initPending || !connected()) {
+        return true;
+    }
+    if (!(searched && oneWire->alarmed(address())) && m_skippedReads < maxSkippedReads) {
+        ++m_skippedReads;
+        return false;
+    }
+    m_skippedReads = 0;
+    return true;
+}
+
+void
+DS18B20::updateAlarmBand(int16_t tempRaw)
+{
+    // The sensor has an alarm condition when the whole degrees of the temperature are at or beyond a threshold.
+    // The thresholds are set one degree around the last value, so the alarm is raised when the whole degree changes.
+    auto wholeDegrees = int8_t(tempRaw >> 4);
+    auto high = uint8_t(int8_t(wholeDegrees + 1));
+    auto low = uint8_t(int8_t(wholeDegrees - 1));
+    if (high == m_alarmHigh && low == m_alarmLow) {
+        return;
+    }
+    m_alarmHigh = high;
+    m_alarmLow = low;
+    // if the write fails, the next read sees different thresholds and detects it like a reset
+    OneWireTransaction transaction;
+    transaction.reset().select(address()).write(WRITESCRATCH).write(high).write(low).write(0x7F).reset();
+    oneWire->transactions().submit(this, std::move(transaction), nullptr);
+}
+
 void
 DS18B20::update()
 {
+    if (!readNeeded()) {
+        requestConversion();
+        return;
+    }
     m_cachedValue = readAndConstrainTemp();
-    startConversion();
+    // The next conversion is started for all sensors on the bus at once by OneWire::startRequestedConversions()
+    requestConversion();
+}
+
+bool
+DS18B20::updateAsync()
+{
+    if (m_readPending) {
+        return false;
+    }
+    if (!readNeeded()) {
+        // the value did not change, only the next conversion is needed
+        requestConversion();
+        return false;
+    }
+    if (m_initPending) {
+        // configuring a sensor after a reset is rare and uses the blocking functions
+        m_initPending = false;
+        init();
+    }
+    m_readPending = true;
+    m_readRetries = 0;
+    submitScratchPadRead();
+    return true;
+}
+
+void
+DS18B20::submitScratchPadRead()
+{
+    OneWireTransaction transaction;
+    transaction.reset().select(address()).write(READSCRATCH).read(9).reset();
+    oneWire->transactions().submit(this, std::move(transaction), [this](const OneWireTransactionQueue::Result& result) {
+        scratchPadReceived(result);
+    });
+}
+
+void
+DS18B20::scratchPadReceived(const OneWireTransactionQueue::Result& result)
+{
+    const auto& data = result.data;
+    bool success = result.success;
+    if (!success) {
+        recordPresenceError(); // the transaction fails when the device does not respond to the reset
+    } else {
+        // the CRC is computed by the queue while the bytes arrive, the temperature is decoded from the received bytes
+        success = data.size() == 9 && result.crc == 0;
+        if (!success) {
+            recordCrcError();
+        }
+    }
+    if (!success && ++m_readRetries < 2) {
+        recordRetry();
+        submitScratchPadRead();
+        return;
+    }
+    if (success) {
+        // the bus records the latency of all its transactions
+        m_stats.latency.add(result.latency);
+    }
+
+    int16_t tempRaw = success ? rawTempFromScratchPad(data.data()) : DEVICE_DISCONNECTED_RAW;
+    if (tempRaw == RESET_DETECTED_RAW) {
+        recordResetDetection();
+        // re-init on the next update, the blocking functions cannot be used while the queue is processed
+        m_initPending = true;
+    }
+    m_cachedValue = convertRawTemp(tempRaw);
+    m_readPending = false;
+    requestConversion();
 }
 
 temp_t
 DS18B20::readAndConstrainTemp()
 {
-    // difference in precision between DS18B20 format and temperature format
-    static constexpr const int32_t scale = 1 << (cnl::_impl::fractional_digits<temp_t>::value - 4);
-    int32_t tempRaw;
-    bool success;
-
-    tempRaw = getRawTemp();
-    success = tempRaw > RESET_DETECTED_RAW;
+    int16_t tempRaw = getRawTemp();
 
     if (tempRaw == RESET_DETECTED_RAW) {
         // retry re-init if the sensor is present, but needs a reset
+        recordResetDetection();
         init();
     }
 
+    return convertRawTemp(tempRaw);
+}
+
+temp_t
+DS18B20::convertRawTemp(int16_t tempRaw)
+{
+    // difference in precision between DS18B20 format and temperature format
+    static constexpr const int32_t scale = 1 << (cnl::_impl::fractional_digits<temp_t>::value - 4);
+    bool success = tempRaw > RESET_DETECTED_RAW;
+
     connected(success);
 
     if (!success) {
         return 0;
     }
 
+    if (m_alarmMode) {
+        updateAlarmBand(tempRaw);
+    }
+
     temp_t temp = cnl::wrap<temp_t>(tempRaw * scale) + m_calibrationOffset;
 
     return temp;
@@ -151,16 +327,27 @@ bool
 DS18B20::readScratchPad(ScratchPad& scratchPad)
 {
     for (uint8_t retries = 0; retries < 2; retries++) {
+        if (retries) {
+            recordRetry();
+        }
+        auto start = oneWire->micros();
         bool success = false;
         if (selectRom()) {
-            if (oneWire.write(READSCRATCH)) {
-                if (oneWire.read_bytes(&scratchPad[0], 9)) {
-                    success = scratchPad.valid();
+            if (oneWire->write(READSCRATCH)) {
+                uint8_t crc = 0;
+                if (oneWire->read_bytes(scratchPad.begin(), 9, crc)) {
+                    success = crc == 0;
+                    if (!success) {
+                        recordCrcError();
+                    }
                 }
             }
         }
-        oneWire.reset();
+        oneWire->reset();
         if (success) {
+            auto latency = oneWire->micros() - start;
+            m_stats.latency.add(latency);
+            oneWire->stats().latency.add(latency);
             return true;
         }
     }
@@ -172,25 +359,25 @@ DS18B20::writeScratchPad(const ScratchPad& scratchPad, bool copyToEeprom)
 {
     if (selectRom()) {
         uint8_t bytes[4] = {WRITESCRATCH, scratchPad[HIGH_ALARM_TEMP], scratchPad[LOW_ALARM_TEMP], scratchPad[CONFIGURATION]};
-        if (oneWire.write_bytes(bytes, 4)) {
+        if (oneWire->write_bytes(bytes, 4)) {
             // save the newly written values to eeprom
             if (copyToEeprom) {
                 selectRom();
-                oneWire.write(COPYSCRATCH);
+                oneWire->write(COPYSCRATCH);
             }
         }
     }
 
-    oneWire.reset();
+    oneWire->reset();
 }
 
 void
 DS18B20::recallScratchpad()
 {
     if (selectRom()) {
-        oneWire.write(RECALLSCRATCH);
+        oneWire->write(RECALLSCRATCH);
     }
-    oneWire.reset();
+    oneWire->reset();
 }
 
 bool
@@ -199,11 +386,11 @@ DS18B20::
 {
     bool busHigh = true;
     if (selectRom()) {
-        oneWire.write(READPOWERSUPPLY);
+        oneWire->write(READPOWERSUPPLY);
         // Parasite powered sensors pull the bus low
-        oneWire.read_bit(busHigh);
+        oneWire->read_bit(busHigh);
     }
-    oneWire.reset();
+    oneWire->reset();
     return !busHigh;
 }
 
@@ -214,10 +401,16 @@ DS18B20::getRawTemp()
     if (!readScratchPad(scratchPad)) {
         return DEVICE_DISCONNECTED_RAW;
     }
+    return rawTempFromScratchPad(scratchPad.begin());
+}
+
+int16_t
+DS18B20::rawTempFromScratchPad(const uint8_t* scratchPad) const
+{
     // return DEVICE_DISCONNECTED when a reset has been detected to force it to be reconfigured
     // we detect a reset by creating a mismatch beteween the eeprom and the on device scratchpad
     // On reset, the EEPROM value will be reloaded, signaling that a reset has  occurred
-    if (scratchPad[HIGH_ALARM_TEMP] != 1) {
+    if (scratchPad[HIGH_ALARM_TEMP] != m_alarmHigh || scratchPad[LOW_ALARM_TEMP] != m_alarmLow) {
         return RESET_DETECTED_RAW;
     }
     int16_t rawTemperature = (((int16_t)scratchPad[TEMP_MSB]) << 8) | scratchPad[TEMP_LSB];
@@ -39,10 +39,50 @@ DS2408::writeNeeded() const
     return !connected() || desiredLatches != latches;
 }
 
+constexpr duration_millis_t DS2408::maxPollInterval;
+
+void
+DS2408::holdOffSense(uint8_t channel, const ticks_millis_t& until)
+{
+    if (validChannel(channel)) {
+        senseHeldUntil[channel - 1] = until;
+    }
+}
+
+bool
+DS2408::pollDue(const ticks_millis_t& now) const
+{
+    if (!connected() || writeNeeded() || now - lastPoll >= maxPollInterval) {
+        return true;
+    }
+    // outputs are also verified by reading, so only skip a read when there are inputs and all of them are held off
+    bool held = false;
+    for (uint8_t i = 0; i < size(); ++i) {
+        if (channels[i].config != ChannelConfig::INPUT) {
+            continue;
+        }
+        if (int32_t(senseHeldUntil[i] - now) <= 0) {
+            return true;
+        }
+        held = true;
+    }
+    return !held;
+}
+
+bool
+DS2408::poll(const ticks_millis_t& now)
+{
+    if (!pollDue(now)) {
+        return connected();
+    }
+    lastPoll = now;
+    return update();
+}
+
 bool
 DS2408::update()
 {
-    selectRom();
+    bool selected = selectRom();
 
     // Compute the 1-Wire CRC16 and compare it against the received CRC.
     // Put everything in one buffer so we can compute the CRC easily.
@@ -51,13 +91,16 @@ DS2408::update()
     buf[0] = READ_PIO_REG;            // Read PIO Registers
     buf[1] = ADDRESS_PIO_STATE_LOWER; // LSB address
     buf[2] = ADDRESS_UPPER;           // MSB address
-    oneWire.write_bytes(buf, 3);      // Write 3 cmd bytes
-    oneWire.read_bytes(&buf[3], 10);  // Read 6 data bytes, 2 0xFF, CRC16
+    oneWire->write_bytes(buf, 3);      // Write 3 cmd bytes
+    oneWire->read_bytes(&buf[3], 10);  // Read 6 data bytes, 2 0xFF, CRC16
 
     uint16_t crcCalculated = OneWireCrc16(buf, 11);
     // device sends CRC inverted
     uint16_t crcReceived = ~((uint16_t(buf[12]) << 8) | uint16_t(buf[11]));
     bool success = crcCalculated == crcReceived;
+    if (selected && !success) {
+        recordCrcError();
+    }
     connected(success);
 
     if (success) {
@@ -70,25 +113,40 @@ DS2408::update()
         dirty = false;
     }
     if (writeNeeded()) {
-        if (selectRom()) {
-            uint8_t bytes[3] = {ACCESS_WRITE, desiredLatches, uint8_t(~desiredLatches)};
-
-            if (oneWire.write_bytes(bytes, 3)) {
-                /* Acknowledgement byte, 0xAA for success, 0xFF for failure. */
-                uint8_t ack;
-                if (oneWire.read(ack) && ack == ACK_SUCCESS) {
-                    success = success && oneWire.read(pins);
-                }
-            };
+        // Break before make: when latches are released and others enabled in the same write,
+        // first release them, so two channels driving the same load (like a valve H-bridge) are never enabled together.
+        uint8_t released = desiredLatches | latches;
+        if (success && released != latches && released != desiredLatches) {
+            success = writeLatches(released);
         }
+        bool written = writeLatches(desiredLatches);
+        success = success && written;
         connected(success);
     }
 
-    oneWire.reset();
+    oneWire->reset();
 
     return success;
 }
 
+bool
+DS2408::writeLatches(uint8_t newLatches)
+{
+    if (selectRom()) {
+        uint8_t bytes[3] = {ACCESS_WRITE, newLatches, uint8_t(~newLatches)};
+
+        if (oneWire->write_bytes(bytes, 3)) {
+            /* Acknowledgement byte, 0xAA for success, 0xFF for failure. */
+            uint8_t ack;
+            if (oneWire->read(ack) && ack == ACK_SUCCESS && oneWire->read(pins)) {
+                latches = newLatches;
+                return true;
+            }
+        };
+    }
+    return false;
+}
+
 bool
 DS2408::senseChannelImpl(uint8_t channel, State& result) const
 {
@@ -119,7 +177,16 @@ DS2408::writeChannelImpl(uint8_t channel, ChannelConfig config)
     if (!connected()) {
         return false;
     }
-    if (writeNeeded()) {
+    if (deferWrite()) {
+        return true;
+    }
+    return commitChannels();
+}
+
+bool
+DS2408::commitChannels()
+{
+    if (connected() && writeNeeded()) {
         // only directly update when connected, to prevent disconnected devices to continuously try to update
         // they will reconnect in the normal update tick, which should happen every second
         return update();
@@ -29,11 +29,11 @@ DS2413::update()
     bool success = false;
     if (!writeNeeded()) { // skip read if we need to write anyway, which also returns status
         if (selectRom()) {
-            if (!oneWire.write(ACCESS_READ)) {
+            if (!oneWire->write(ACCESS_READ)) {
                 return false;
             }
             uint8_t status;
-            if (!oneWire.read(status)) {
+            if (!oneWire->read(status)) {
                 return false;
             }
             success = processStatus(status);
@@ -41,25 +41,38 @@ DS2413::update()
         connected(success);
     }
     if (writeNeeded()) { // check again
-        if (selectRom()) {
-            uint8_t data = (desiredState & 0b1000) >> 2 | (desiredState & 0b0010) >> 1;
-            uint8_t bytes[3] = {ACCESS_WRITE, data, uint8_t(~data)};
+        // Break before make: when one latch is released and the other enabled, release it first.
+        // The latch state is only known when connected.
+        uint8_t released = (desiredState | actualState) & 0b1010;
+        if (connected() && released != (actualState & 0b1010) && released != (desiredState & 0b1010)) {
+            writeLatches(released);
+        }
+        success = writeLatches(desiredState);
+        connected(success);
+    }
+    oneWire->reset();
+
+    return success;
+}
+
+bool
+DS2413::writeLatches(uint8_t latches)
+{
+    if (selectRom()) {
+        uint8_t data = (latches & 0b1000) >> 2 | (latches & 0b0010) >> 1;
+        uint8_t bytes[3] = {ACCESS_WRITE, data, uint8_t(~data)};
 
-            if (oneWire.write_bytes(bytes, 3)) {
-                /* Acknowledgement byte, 0xAA for success, 0xFF for failure. */
+        if (oneWire->write_bytes(bytes, 3)) {
+            /* Acknowledgement byte, 0xAA for success, 0xFF for failure. */
 
-                if (oneWire.read(data) && data == ACK_SUCCESS) {
-                    if (oneWire.read(data)) {
-                        success = processStatus(data);
-                    }
+            if (oneWire->read(data) && data == ACK_SUCCESS) {
+                if (oneWire->read(data)) {
+                    return processStatus(data);
                 }
             }
         }
-        connected(success);
     }
-    oneWire.reset();
-
-    return success;
+    return false;
 }
 
 bool
@@ -89,7 +102,16 @@ DS2413::writeChannelImpl(uint8_t channel, ChannelConfig config)
     if (!connected()) {
         return false;
     }
-    if (writeNeeded()) {
+    if (deferWrite()) {
+        return true;
+    }
+    return commitChannels();
+}
+
+bool
+DS2413::commitChannels()
+{
+    if (connected() && writeNeeded()) {
         // only directly update when connected, to prevent disconnected devices to continuously try to update
         // they will reconnect in the normal update tick, which should happen every second
         return update();
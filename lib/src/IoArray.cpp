@@ -0,0 +1,54 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of BrewBlox.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IoArray.h"
+#include <algorithm>
+
+uint8_t IoArray::batchDepth = 0;
+std::vector<IoArray*> IoArray::pendingCommits;
+
+IoArray::~IoArray()
+{
+    pendingCommits.erase(std::remove(pendingCommits.begin(), pendingCommits.end(), this), pendingCommits.end());
+}
+
+bool
+IoArray::deferWrite()
+{
+    if (batchDepth == 0) {
+        return false;
+    }
+    if (std::find(pendingCommits.cbegin(), pendingCommits.cend(), this) == pendingCommits.cend()) {
+        pendingCommits.push_back(this);
+    }
+    return true;
+}
+
+IoArray::Batch::~Batch()
+{
+    if (--batchDepth > 0) {
+        return;
+    }
+    // each array is removed from the list before it commits, so the list stays valid when a commit changes it
+    while (!pendingCommits.empty()) {
+        auto array = pendingCommits.front();
+        pendingCommits.erase(pendingCommits.begin());
+        array->commitChannels();
+    }
+}
@@ -22,13 +22,26 @@
 void
 MotorValve::state(const State& v)
 {
+    position(v == State::Active ? 100 : 0);
+}
+
+void
+MotorValve::position(uint8_t percent)
+{
+    percent = std::min(percent, uint8_t(100));
     auto oldState = m_desiredValveState;
-    if (v == State::Active) {
+    auto oldTarget = m_targetPosition;
+    m_targetPosition = percent;
+    if (percent == 100) {
         m_desiredValveState = ValveState::Opening;
-    } else {
+    } else if (percent == 0) {
         m_desiredValveState = ValveState::Closing;
+    } else {
+        m_desiredValveState = ValveState::HalfOpenIdle;
     }
-    if (oldState != m_desiredValveState) {
+    // An intermediate position is reached by run time, which is counted from the last timed update.
+    // It is applied in the next timed update, so the motor doesn't start between updates.
+    if (m_desiredValveState != ValveState::HalfOpenIdle && (oldState != m_desiredValveState || oldTarget != m_targetPosition)) {
         update();
     }
 }
@@ -54,6 +67,8 @@ MotorValve::applyValveState(ValveState v, std::shared_ptr<DS2408>& devPtr)
     }
     // ACTIVE HIGH means latch pull down enabled, so the input to the H-bridge is inverted.
     // We keep the motor enabled just in case. The valve itself has an internal shutoff.
+    // Both channels are written in a single transaction, or with the other valves in the same update pass.
+    IoArray::Batch batch;
     if (v == ValveState::Opening || v == ValveState::Open) {
         devPtr->writeChannelConfig(m_startChannel + chanOpeningHigh, DS2408::ChannelConfig::ACTIVE_LOW);
         devPtr->writeChannelConfig(m_startChannel + chanClosingHigh, DS2408::ChannelConfig::ACTIVE_HIGH);
@@ -112,6 +127,32 @@ MotorValve::getValveState(const std::shared_ptr<DS2408>& devPtr) const
     return vs;
 }
 
+MotorValve::ValveState
+MotorValve::drive() const
+{
+    if (m_desiredValveState != ValveState::HalfOpenIdle) {
+        return m_desiredValveState;
+    }
+    if (!m_positionKnown) {
+        return ValveState::Closing; // the position is counted from the closed end switch
+    }
+    if (m_travelTime == 0) {
+        return m_actualValveState == ValveState::Open ? ValveState::Closing : ValveState::Opening; // measure the travel time
+    }
+
+    // Keep driving until the target is passed, start driving when further away than the tolerance.
+    // The tolerance prevents moving back and forth around the target.
+    auto tolerance = int32_t(m_travelTime / 50);
+    auto diff = int32_t(uint32_t(m_travelTime) * m_targetPosition / 100) - int32_t(m_travelled);
+    if ((m_actualValveState == ValveState::Opening && diff > 0) || diff > tolerance) {
+        return ValveState::Opening;
+    }
+    if ((m_actualValveState == ValveState::Closing && diff < 0) || diff < -tolerance) {
+        return ValveState::Closing;
+    }
+    return ValveState::HalfOpenIdle;
+}
+
 void
 MotorValve::update()
 {
@@ -123,21 +164,108 @@ MotorValve::update()
     }
     if (auto devPtr = m_target()) {
         m_actualValveState = getValveState(devPtr);
+        calibrate();
 
-        if (m_desiredValveState == ValveState::Closing && m_actualValveState == ValveState::Closed) {
+        auto desired = drive();
+        if (desired == ValveState::Closing && m_actualValveState == ValveState::Closed) {
             return; // leave motor driven
         }
-        if (m_desiredValveState == ValveState::Opening && m_actualValveState == ValveState::Open) {
+        if (desired == ValveState::Opening && m_actualValveState == ValveState::Open) {
             return; // leave motor driven
         }
 
-        if (m_actualValveState != m_desiredValveState) {
-            applyValveState(m_desiredValveState, devPtr);
+        if (m_actualValveState != desired) {
+            applyValveState(desired, devPtr);
             m_actualValveState = getValveState(devPtr);
         }
     }
 }
 
+void
+MotorValve::calibrate()
+{
+    // The end switches calibrate the position estimate.
+    // A run from the closed to the open end switch without stopping measures the travel time.
+    if (m_actualValveState == ValveState::Open) {
+        if (m_measuring && m_runFromClosed > 0) {
+            m_measuredTravelTime = m_runFromClosed;
+            if (m_travelTimeSetting == 0) {
+                m_travelTime = m_measuredTravelTime;
+            }
+        }
+        m_measuring = false;
+        m_travelled = m_travelTime;
+        m_positionKnown = true;
+    } else if (m_actualValveState == ValveState::Closed) {
+        m_measuring = true;
+        m_runFromClosed = 0;
+        m_travelled = 0;
+        m_positionKnown = true;
+    } else if (m_actualValveState != ValveState::Opening) {
+        m_measuring = false;
+    }
+}
+
+ticks_millis_t
+MotorValve::update(const ticks_millis_t& now)
+{
+    // The motor has been driven in the direction of the last update.
+    // The end switches are read at most once per update, so a measured travel time can be up to a second too long.
+    auto elapsed = m_updated ? now - m_lastUpdate : 0;
+    m_lastUpdate = now;
+    m_updated = true;
+    if (m_actualValveState == ValveState::Opening) {
+        m_travelled = std::min(m_travelled + elapsed, m_travelTime);
+        m_runFromClosed += elapsed;
+    } else if (m_actualValveState == ValveState::Closing) {
+        m_travelled = m_travelled > elapsed ? m_travelled - elapsed : 0;
+    }
+
+    update();
+
+    auto devPtr = m_target();
+    if (!devPtr || !channelReady()) {
+        return now + 1000;
+    }
+    holdOffSense(devPtr, now);
+
+    if (m_desiredValveState == ValveState::HalfOpenIdle && m_positionKnown) {
+        // update when the target is reached
+        auto target = uint32_t(m_travelTime) * m_targetPosition / 100;
+        duration_millis_t remaining = 1000;
+        if (m_actualValveState == ValveState::Opening && target > m_travelled) {
+            remaining = target - m_travelled;
+        } else if (m_actualValveState == ValveState::Closing && m_travelled > target) {
+            remaining = m_travelled - target;
+        }
+        return now + std::min(remaining, duration_millis_t(1000));
+    }
+    return now + 1000;
+}
+
+void
+MotorValve::holdOffSense(std::shared_ptr<DS2408>& devPtr, const ticks_millis_t& now)
+{
+    // While travelling, the end switch cannot be reached before the predicted arrival.
+    // The margin allows for a valve that is faster than its travel time.
+    // Without a travel time, the switches are read every update, to measure it.
+    auto until = now;
+    if (m_positionKnown && m_travelTime > 0) {
+        duration_millis_t toEnd = 0;
+        if (m_actualValveState == ValveState::Opening) {
+            toEnd = m_travelTime - m_travelled;
+        } else if (m_actualValveState == ValveState::Closing) {
+            toEnd = m_travelled;
+        }
+        auto margin = m_travelTime / 4;
+        if (toEnd > margin) {
+            until = now + (toEnd - margin);
+        }
+    }
+    devPtr->holdOffSense(m_startChannel + chanIsClosed, until);
+    devPtr->holdOffSense(m_startChannel + chanIsOpen, until);
+}
+
 void
 MotorValve::claimChannel()
 {
@@ -148,6 +276,7 @@ MotorValve::claimChannel()
             }
             m_startChannel = 0;
         }
+        IoArray::Batch batch;
         if (m_desiredChannel == 1 || m_desiredChannel == 5) { // only 2 valid options
             bool success = devPtr->claimChannel(m_desiredChannel + chanIsClosed, IoArray::ChannelConfig::INPUT);
             success = devPtr->claimChannel(m_desiredChannel + chanIsOpen, IoArray::ChannelConfig::INPUT) && success;
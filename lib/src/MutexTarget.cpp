@@ -0,0 +1,194 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MutexTarget.h"
+#include <algorithm>
+
+// tokens handed out and not released yet, a few per actuator at most
+static std::vector<MutexTarget::Token>&
+liveTokens()
+{
+    static std::vector<MutexTarget::Token> tokens;
+    return tokens;
+}
+
+MutexTarget::Token
+MutexTarget::newToken()
+{
+    static Token next = 0;
+    auto& live = liveTokens();
+    do {
+        if (++next == 0) {
+            ++next;
+        }
+    } while (std::find(live.cbegin(), live.cend(), next) != live.cend());
+    live.push_back(next);
+    return next;
+}
+
+void
+MutexTarget::releaseToken(Token token)
+{
+    auto& live = liveTokens();
+    auto it = std::find(live.begin(), live.end(), token);
+    if (it != live.end()) {
+        *it = live.back();
+        live.pop_back();
+    }
+}
+
+duration_millis_t
+MutexTarget::tryAcquire(Token token, duration_millis_t hold, const ticks_millis_t& now)
+{
+    dropStaleWaiters(now);
+
+    auto owner = m_owner.load();
+    if (Token(owner) == token) {
+        // the owner can turn on again during its own hold time
+        m_owner.store(token | heldFlag);
+        m_ownerHold = hold;
+        m_timeRemaining = hold;
+        return 0;
+    }
+
+    if (owner & heldFlag) {
+        enqueue(token, now);
+        m_timeRemaining = m_ownerHold;
+        return m_ownerHold + 1;
+    }
+
+    auto remaining = reservationRemaining(now);
+    m_timeRemaining = remaining;
+    if (remaining > 0) {
+        enqueue(token, now);
+        return remaining;
+    }
+
+    if (m_waitingCount > 0 && m_waiting[0].token != token) {
+        // an actuator that asked earlier goes first
+        enqueue(token, now);
+        return 1;
+    }
+
+    if (!m_owner.compare_exchange_strong(owner, token | heldFlag)) {
+        return 1;
+    }
+    dequeue(token);
+    m_ownerHold = hold;
+    m_timeRemaining = hold;
+    return 0;
+}
+
+void
+MutexTarget::release(Token token, const ticks_millis_t& releasedAt, const ticks_millis_t& now)
+{
+    dequeue(token);
+    auto owner = m_owner.load();
+    if (owner != (token | heldFlag)) {
+        return;
+    }
+    m_releasedAt = releasedAt;
+    m_owner.store(token); // reserved until the hold time has passed
+    m_timeRemaining = reservationRemaining(now);
+}
+
+void
+MutexTarget::abandon(Token token)
+{
+    dequeue(token);
+    auto owner = m_owner.load();
+    if (Token(owner) == token) {
+        m_owner.compare_exchange_strong(owner, 0);
+        m_timeRemaining = 0;
+    }
+}
+
+bool
+MutexTarget::holdFromIsr(Token token)
+{
+    auto owner = m_owner.load();
+    if (Token(owner) != token) {
+        return false;
+    }
+    // Marking it held stops another actuator from taking the mutex after the reservation has expired.
+    // The hold time of the reservation is kept, the main loop releases the mutex again when the actuator turns off.
+    return (owner & heldFlag) || m_owner.compare_exchange_strong(owner, token | heldFlag);
+}
+
+void
+MutexTarget::update(const ticks_millis_t& now)
+{
+    dropStaleWaiters(now);
+    if (!held()) {
+        m_timeRemaining = reservationRemaining(now);
+    }
+    m_longestWait = m_waitingCount > 0 ? now - m_waiting[0].since : 0;
+}
+
+duration_millis_t
+MutexTarget::waitedBy(Token token, const ticks_millis_t& now) const
+{
+    auto end = m_waiting.begin() + m_waitingCount;
+    auto it = std::find_if(m_waiting.begin(), end, [token](const Waiter& w) { return w.token == token; });
+    return it != end ? now - it->since : 0;
+}
+
+duration_millis_t
+MutexTarget::reservationRemaining(const ticks_millis_t& now) const
+{
+    auto owner = m_owner.load();
+    if (owner == 0 || (owner & heldFlag)) {
+        return 0;
+    }
+    auto elapsed = now - m_releasedAt;
+    return elapsed < m_ownerHold ? m_ownerHold - elapsed : 0;
+}
+
+void
+MutexTarget::enqueue(Token token, const ticks_millis_t& now)
+{
+    auto end = m_waiting.begin() + m_waitingCount;
+    auto it = std::find_if(m_waiting.begin(), end, [token](const Waiter& w) { return w.token == token; });
+    if (it != end) {
+        it->lastSeen = now;
+    } else if (m_waitingCount < m_waiting.size()) {
+        *it = Waiter{token, now, now};
+        ++m_waitingCount;
+    }
+}
+
+void
+MutexTarget::dequeue(Token token)
+{
+    auto end = m_waiting.begin() + m_waitingCount;
+    auto it = std::remove_if(m_waiting.begin(), end, [token](const Waiter& w) { return w.token == token; });
+    m_waitingCount = it - m_waiting.begin();
+}
+
+void
+MutexTarget::dropStaleWaiters(const ticks_millis_t& now)
+{
+    // Blocked actuators ask again at least once per second.
+    // An actuator that stopped asking without giving up its place should not block the others.
+    const duration_millis_t staleAfter = 2000;
+
+    auto end = m_waiting.begin() + m_waitingCount;
+    auto it = std::remove_if(m_waiting.begin(), end, [&now, &staleAfter](const Waiter& w) { return now - w.lastSeen > staleAfter; });
+    m_waitingCount = it - m_waiting.begin();
+}
@@ -123,6 +123,7 @@ sample code bearing this copyright.
 #include "../inc/OneWire.h"
 #include "../inc/OneWireAddress.h"
 #include "../inc/OneWireCrc.h"
+#include <algorithm>
 
 bool
 OneWire::write_bytes(const uint8_t* buf, uint16_t count)
@@ -138,12 +139,15 @@ OneWire::write_bytes(const uint8_t* buf, uint16_t count)
 bool
 OneWire::read_bytes(uint8_t* buf, uint16_t count)
 {
-    for (uint16_t i = 0; i < count; i++) {
-        if (!driver.read(buf[i])) {
-            return false;
-        };
-    }
-    return true;
+    uint8_t crc = 0;
+    return driver.read_bytes(buf, count, crc);
+}
+
+bool
+OneWire::read_bytes(uint8_t* buf, uint16_t count, uint8_t& crc)
+{
+    crc = 0;
+    return driver.read_bytes(buf, count, crc);
 }
 
 //
@@ -169,6 +173,24 @@ OneWire::skip()
     return driver.write(0xCC); // Skip ROM
 }
 
+bool
+OneWire::startRequestedConversions()
+{
+    if (!conversionRequested) {
+        return false;
+    }
+    conversionRequested = false;
+    OneWireTransaction broadcast;
+    broadcast.reset().skip().write(0x44).reset(); // Convert T, for all temperature sensors on the bus
+    queue.submit(this, std::move(broadcast), [this](const OneWireTransactionQueue::Result& result) {
+        if (!result.success) {
+            ++stats().presenceErrors; // no device on the bus responded
+        }
+    });
+    queue.process();
+    return true;
+}
+
 void
 OneWire::reset_search()
 {
@@ -189,8 +211,96 @@ OneWire::target_search(uint8_t family_code)
     lastDeviceFlag = false;
 }
 
+bool
+OneWire::startRequestedAlarmSearch()
+{
+    if (!alarmSearchRequested || alarmSearchActive) {
+        return false;
+    }
+    alarmSearchRequested = false;
+    alarmSearchActive = true;
+    alarmRom = 0;
+    alarmLastDiscrepancy = 64;
+    alarmFound.clear();
+    submitAlarmSearchPass();
+    return true;
+}
+
+void
+OneWire::submitAlarmSearchPass()
+{
+    // The search directions only depend on the previous pass, so a whole pass is a single transaction.
+    // Below the last discrepancy, follow the previous address. At the discrepancy, take the 1 branch this time.
+    // Beyond it, prefer the 0 branch. The triplet follows the only branch that exists when there is no discrepancy.
+    OneWireTransaction transaction;
+    transaction.reset().write(0xEC); // CONDITIONAL SEARCH, only devices with an alarm condition respond
+    for (uint8_t i = 0; i < 64; i++) {
+        transaction.searchTriplet(i < alarmLastDiscrepancy ? alarmRom.getBit(i) : i == alarmLastDiscrepancy);
+    }
+    queue.submit(this, std::move(transaction), [this](const OneWireTransactionQueue::Result& result) {
+        alarmSearchPassDone(result);
+    });
+}
+
+void
+OneWire::alarmSearchPassDone(const OneWireTransactionQueue::Result& result)
+{
+    const auto& data = result.data;
+    if (!result.success) {
+        ++stats().presenceErrors; // the conditional search always gets a presence pulse from the devices on the bus
+    }
+    if (!result.success || data.size() != 64) {
+        // the result is unknown, devices keep the previous result and are read when they have skipped too many reads
+        alarmSearchActive = false;
+        return;
+    }
+
+    uint8_t bitNr = 0;
+    uint8_t lastZero = 64;
+    for (; bitNr < 64; bitNr++) {
+        // check bit results in status byte
+        bool idBit = (data[bitNr] & 0b00100000) > 0;
+        bool cmpIdBit = (data[bitNr] & 0b01000000) > 0;
+        bool direction = (data[bitNr] & 0b10000000) > 0;
+        if (idBit && cmpIdBit) {
+            break; // no devices with an alarm condition (left)
+        }
+        if (!idBit && !cmpIdBit && !direction) {
+            lastZero = bitNr;
+        }
+        alarmRom.setBit(bitNr, direction);
+    }
+
+    if (bitNr == 64 && alarmRom.valid()) {
+        alarmFound.push_back(alarmRom);
+        if (lastZero != 64) {
+            // another device took the other branch, find it with the next pass
+            alarmLastDiscrepancy = lastZero;
+            submitAlarmSearchPass();
+            return;
+        }
+    }
+
+    alarmedDevices = std::move(alarmFound);
+    alarmFound.clear();
+    alarmSearchActive = false;
+    ++alarmSearches;
+}
+
+bool
+OneWire::alarmed(const OneWireAddress& address) const
+{
+    return std::find(alarmedDevices.cbegin(), alarmedDevices.cend(), address) != alarmedDevices.cend();
+}
+
 bool
 OneWire::search(OneWireAddress& newAddr)
+{
+    return search(newAddr, 0xF0); // NORMAL SEARCH
+}
+
+bool
+OneWire::search(OneWireAddress& newAddr, uint8_t command)
 {
     uint8_t id_bit_nr = 0;
     bool search_result = false;
@@ -201,12 +311,12 @@ OneWire::search(OneWireAddress& newAddr)
     // if the last call was not the last one
     if (!lastDeviceFlag) {
         if (!reset()) {
+            ++stats().presenceErrors; // no device on the bus responded
             return false;
         }
 
         // issue the search command
-        // Conditional search/alarm search would send 0xEC here, but we don't use it
-        write(0xF0); // NORMAL SEARCH.
+        write(command);
 
         // loop to do the search
         do {
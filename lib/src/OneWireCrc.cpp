@@ -21,13 +21,19 @@ OneWireCrc8(const uint8_t* addr, uint8_t len)
     uint8_t crc = 0;
 
     while (len--) {
-        crc = *addr++ ^ crc; // just re-using crc as intermediate
-        crc = dscrc2x16_table[crc & 0x0f] ^ dscrc2x16_table[16 + ((crc >> 4) & 0x0f)];
+        crc = OneWireCrc8Update(*addr++, crc);
     }
 
     return crc;
 }
 
+uint8_t
+OneWireCrc8Update(uint8_t input, uint8_t crc)
+{
+    crc = input ^ crc; // just re-using crc as intermediate
+    return dscrc2x16_table[crc & 0x0f] ^ dscrc2x16_table[16 + ((crc >> 4) & 0x0f)];
+}
+
 uint16_t
 OneWireCrc16Update(uint8_t input, uint16_t crc)
 {
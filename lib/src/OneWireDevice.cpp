@@ -28,7 +28,7 @@
  * /param address_ The oneWire address of the device to use.
  */
 OneWireDevice::OneWireDevice(OneWire& oneWire_, const OneWireAddress& address_)
-    : oneWire(oneWire_)
+    : oneWire(&oneWire_)
     , m_address(address_)
 {
 }
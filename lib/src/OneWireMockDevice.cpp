@@ -28,7 +28,7 @@ OneWireMockDevice::read()
     while (!masterToSlave.empty()) {
         process();
     }
-    uint8_t b = 0xFF;
+    uint8_t b = (dropped || !connected) ? 0xFF : idleRead();
     if (!slaveToMaster.empty()) {
         b = slaveToMaster.front();
         if (!flippedReadBits.empty()) {
@@ -146,6 +146,10 @@ OneWireMockDevice::process()
     case 0xF0: // Search ROM
         search_bitnr = 0;
         return;
+    case 0xEC: // Alarm Search, only devices with an alarm condition take part
+        search_bitnr = 0;
+        dropped = !alarm();
+        return;
     case 0xCC: // Skip ROM
     case 0x3C: // Overdrive skip
     case 0xA5: // Resume
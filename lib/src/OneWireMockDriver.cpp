@@ -22,6 +22,7 @@
 uint8_t
 OneWireMockDriver::search_triplet(bool search_direction)
 {
+    elapse(3 * timing.bit);
     bool id_bit = true;
     bool cmp_id_bit = true;
     for (auto& device : devices) {
@@ -49,4 +50,93 @@ OneWireMockDriver::search_triplet(bool search_direction)
         status |= 0b10000000;
     }
     return status;
-}
\ No newline at end of file
+}
+
+bool
+OneWireMockDriver::start(AsyncOp op, uint8_t value)
+{
+    if (asyncPending) {
+        return false; // previous operation not polled yet
+    }
+    bool bit = false;
+    asyncResult = 0;
+    asyncDuration = 0;
+    asyncStart = clock ? clock() : 0;
+    asyncOp = true;
+    switch (op) {
+    case AsyncOp::RESET:
+        asyncResult = reset() ? 1 : 0;
+        break;
+    case AsyncOp::WRITE:
+        write(value);
+        break;
+    case AsyncOp::READ:
+        read(asyncResult);
+        break;
+    case AsyncOp::WRITE_BIT:
+        write_bit(value != 0);
+        break;
+    case AsyncOp::READ_BIT:
+        read_bit(bit);
+        asyncResult = bit ? 1 : 0;
+        break;
+    case AsyncOp::SEARCH_TRIPLET:
+        asyncResult = search_triplet(value != 0);
+        break;
+    }
+    asyncOp = false;
+    asyncRemaining = asyncLatency;
+    asyncPending = true;
+    return true;
+}
+
+OneWireMockDriver::AsyncStatus
+OneWireMockDriver::poll(uint8_t& result)
+{
+    if (asyncRemaining > 0) {
+        --asyncRemaining;
+        ++busyPollCount;
+        return AsyncStatus::BUSY;
+    }
+    if (clock && clock() - asyncStart < asyncDuration) {
+        ++busyPollCount;
+        return AsyncStatus::BUSY;
+    }
+    asyncPending = false;
+    result = asyncResult;
+    return AsyncStatus::DONE;
+}
+
+void
+OneWireMockDriver::elapse(const duration_micros_t& duration)
+{
+    busyTime += duration;
+    if (clock) {
+        if (asyncOp) {
+            asyncDuration += duration; // waited for in poll()
+        } else {
+            auto start = clock();
+            while (clock() - start < duration) {
+            }
+        }
+    }
+    auto now = clock ? clock() : busyTime;
+    for (auto& device : devices) {
+        device->setTime(now);
+    }
+}
+
+uint8_t
+OneWireMockDriver::injectedError()
+{
+    if (readErrorRate == 0) {
+        return 0;
+    }
+    // linear congruential generator, deterministic for a given seed
+    randomState = randomState * 1103515245 + 12345;
+    if ((randomState >> 8) % 1000000 >= readErrorRate) {
+        return 0;
+    }
+    ++injectedErrorCount;
+    return uint8_t{1} << ((randomState >> 4) & 0x7);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the Brewblox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireMockPopulation.h"
+#include "DS18B20Mock.h"
+#include "DS2408Mock.h"
+#include "DS2413Mock.h"
+#include "OneWireCrc.h"
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+static bool
+parseAddress(const std::string& hex, OneWireAddress& address)
+{
+    if (hex.size() != 14 && hex.size() != 16) {
+        return false;
+    }
+    for (uint8_t i = 0; i < hex.size() / 2; i++) {
+        char* end;
+        auto byteStr = hex.substr(2 * i, 2);
+        address[i] = uint8_t(strtoul(byteStr.c_str(), &end, 16));
+        if (*end != 0) {
+            return false;
+        }
+    }
+    if (hex.size() == 14) {
+        address[7] = OneWireCrc8(&address[0], 7);
+    }
+    return true;
+}
+
+static std::shared_ptr<OneWireMockDevice>
+makeDevice(const std::string& type, const OneWireAddress& address, std::istringstream& options)
+{
+    if (type == "DS18B20") {
+        auto sensor = std::make_shared<DS18B20Mock>(address);
+        std::string option;
+        while (options >> option) {
+            if (option.compare(0, 5, "temp=") == 0) {
+                sensor->setTemperature(temp_t(strtod(option.c_str() + 5, nullptr)));
+            } else if (option.compare(0, 11, "conversion=") == 0) {
+                sensor->setConversionTime(strtoul(option.c_str() + 11, nullptr, 10));
+            } else if (option == "disconnected") {
+                sensor->setConnected(false);
+            }
+        }
+        return sensor;
+    }
+
+    std::shared_ptr<OneWireMockDevice> device;
+    if (type == "DS2408") {
+        device = std::make_shared<DS2408Mock>(address);
+    } else if (type == "DS2413") {
+        device = std::make_shared<DS2413Mock>(address);
+    } else {
+        return nullptr;
+    }
+    std::string option;
+    while (options >> option) {
+        if (option == "disconnected") {
+            device->setConnected(false);
+        }
+    }
+    return device;
+}
+
+uint16_t
+loadMockPopulation(OneWireMockDriver& driver, std::istream& in)
+{
+    uint16_t count = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string type;
+        std::string hex;
+        if (!(fields >> type) || type[0] == '#' || !(fields >> hex)) {
+            continue;
+        }
+        OneWireAddress address;
+        if (!parseAddress(hex, address)) {
+            continue;
+        }
+        if (auto device = makeDevice(type, address, fields)) {
+            driver.attach(std::move(device));
+            ++count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the Brewblox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireScheduler.h"
+
+uint8_t
+OneWireScheduler::add(OneWire& bus)
+{
+    auto index = indexOf(bus);
+    if (index == noBus) {
+        index = buses.size();
+        buses.push_back(&bus);
+    }
+    return index;
+}
+
+uint8_t
+OneWireScheduler::indexOf(const OneWire& bus) const
+{
+    for (uint8_t i = 0; i < buses.size(); i++) {
+        if (buses[i] == &bus) {
+            return i;
+        }
+    }
+    return noBus;
+}
+
+bool
+OneWireScheduler::process()
+{
+    if (buses.empty()) {
+        return false;
+    }
+    first = (first + 1) % buses.size();
+
+    // keep giving turns until no bus can make progress without waiting for its bus master
+    bool pending = true;
+    bool progress = true;
+    while (pending && progress) {
+        pending = false;
+        progress = false;
+        for (uint8_t i = 0; i < buses.size(); i++) {
+            auto& queue = buses[(first + i) % buses.size()]->transactions();
+            auto before = queue.completedSteps();
+            pending |= queue.process(stepsPerTurn);
+            progress |= queue.completedSteps() != before;
+        }
+    }
+    return pending;
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the Brewblox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Brewblox.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "OneWireTransactionQueue.h"
+#include <algorithm>
+
+void
+OneWireTransactionQueue::submit(const void* owner, OneWireTransaction&& transaction, Callback&& callback)
+{
+    queue.push_back(Entry{owner, std::move(transaction), std::move(callback)});
+}
+
+void
+OneWireTransactionQueue::cancel(const void* owner)
+{
+    auto first = queue.begin();
+    if (active()) {
+        // the active transaction is finished on the bus to leave it in a known state
+        if (first->owner == owner) {
+            first->owner = nullptr;
+            first->callback = nullptr;
+        }
+        ++first;
+    }
+    queue.erase(std::remove_if(first, queue.end(), [owner](const Entry& e) {
+                    return e.owner == owner;
+                }),
+                queue.end());
+}
+
+bool
+OneWireTransactionQueue::process(uint16_t maxSteps)
+{
+    if (processing) {
+        return busy();
+    }
+    processing = true;
+
+    while (!queue.empty() && maxSteps > 0) {
+        const auto& steps = queue.front().transaction.getSteps();
+        if (step >= steps.size()) {
+            finish(true); // empty transaction
+            continue;
+        }
+        const auto& current = steps[step];
+        if (!started) {
+            if (!driver.start(current.op, current.value)) {
+                break; // driver not ready, try again on the next call
+            }
+            started = true;
+            if (step == 0 && clock) {
+                activeSince = clock();
+            }
+        }
+
+        uint8_t result = 0;
+        auto status = driver.poll(result);
+        if (status == OneWireLowLevelInterface::AsyncStatus::BUSY) {
+            break;
+        }
+        started = false;
+        ++completed;
+        if (current.op == OneWireTransaction::Op::RESET) {
+            ++m_stats.resets; // a missing presence pulse is counted by the owner, which knows which device didn't respond
+        }
+        if (status == OneWireLowLevelInterface::AsyncStatus::FAILED
+            || (current.op == OneWireTransaction::Op::RESET && !result)) {
+            --maxSteps;
+            finish(false);
+            continue;
+        }
+        if (current.op == OneWireTransaction::Op::READ) {
+            data.push_back(result);
+            crc = OneWireCrc8Update(result, crc);
+        } else if (current.op == OneWireTransaction::Op::READ_BIT || current.op == OneWireTransaction::Op::SEARCH_TRIPLET) {
+            data.push_back(result);
+        }
+        ++step;
+        --maxSteps;
+        if (step >= steps.size()) {
+            finish(true);
+        }
+    }
+
+    processing = false;
+    return busy();
+}
+
+bool
+OneWireTransactionQueue::flush()
+{
+    return processUntil(false);
+}
+
+bool
+OneWireTransactionQueue::finishActive()
+{
+    if (!active()) {
+        return true;
+    }
+    return processUntil(true);
+}
+
+bool
+OneWireTransactionQueue::processUntil(bool activeOnly)
+{
+    if (processing) {
+        return true; // called from a callback, the active transaction has finished
+    }
+    auto lastCompleted = completed;
+    auto lastFinished = finished;
+    uint16_t retries = 0;
+    ticks_micros_t waitingSince = 0;
+    // one operation at a time when only the active transaction should finish, to not start the next one
+    while (process(activeOnly ? 1 : UINT16_MAX)) {
+        if (activeOnly && finished != lastFinished) {
+            break;
+        }
+        if (completed != lastCompleted) {
+            lastCompleted = completed;
+            retries = 0;
+            continue;
+        }
+        // no operation completed, the bus master is busy
+        if (clock) {
+            auto now = clock();
+            if (retries == 0) {
+                waitingSince = now;
+                retries = 1;
+            } else if (now - waitingSince > flushTimeout) {
+                return false; // the bus master is stuck, the transactions stay queued
+            }
+        } else if (++retries > flushRetries) {
+            return false;
+        }
+    }
+    return true;
+}
+
+duration_micros_t
+OneWireTransactionQueue::expectedCompletion(const void* owner) const
+{
+    duration_micros_t total = 0;
+    duration_micros_t untilOwner = 0;
+    bool first = true;
+    for (const auto& entry : queue) {
+        const auto& steps = entry.transaction.getSteps();
+        // the active transaction has completed the steps before the current one
+        for (auto s = steps.cbegin() + (first ? std::min<size_t>(step, steps.size()) : 0); s != steps.cend(); ++s) {
+            total += OneWireTransaction::expectedDuration(s->op);
+        }
+        first = false;
+        if (entry.owner == owner) {
+            untilOwner = total;
+        }
+    }
+    return untilOwner;
+}
+
+void
+OneWireTransactionQueue::finish(bool success)
+{
+    // the callback can submit a new transaction, so the entry is removed before calling it
+    auto callback = std::move(queue.front().callback);
+    queue.pop_front();
+    duration_micros_t latency = 0;
+    if (clock) {
+        latency = clock() - activeSince;
+        if (success) {
+            m_stats.latency.add(latency);
+        }
+    }
+    step = 0;
+    started = false;
+    ++finished;
+    if (callback) {
+        callback(Result{success, data, crc, latency});
+    }
+    data.clear();
+    crc = 0;
+}
@@ -21,7 +21,7 @@
 #include "../inc/future_std.h"
 
 void
-Pid::update()
+Pid::update(const duration_millis_t& elapsed)
 {
     auto input = m_inputPtr();
     auto setpoint = in_t{0};
@@ -61,6 +61,10 @@ Pid::update()
     decltype(m_integral) integral_increase = 0;
     if (m_ti != 0 && m_kp != 0 && !m_boilModeActive) {
         integral_increase = cnl::quotient(m_p + m_d, m_kp);
+        if (elapsed != 1000) {
+            // the integral is in degree-seconds, scale the increase to the time since the last update
+            integral_increase = cnl::wrap<integral_t>((int64_t(cnl::unwrap(integral_increase)) * elapsed) / 1000);
+        }
         m_integral += integral_increase;
         m_i = m_integral * safe_elastic_fixed_point<4, 27>(cnl::quotient(m_kp, m_ti));
     } else {
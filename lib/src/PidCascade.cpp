@@ -0,0 +1,54 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../inc/PidCascade.h"
+
+PidCascade::PidCascade(
+    std::function<std::shared_ptr<SetpointSensorPair>()>&& outerInput,
+    std::function<std::shared_ptr<SetpointSensorPair>()>&& innerInput,
+    std::function<std::shared_ptr<ProcessValue<out_t>>()>&& output,
+    std::function<std::shared_ptr<ProcessValue<temp_t>>()>&& feedForwardInput)
+    : m_outerInput(outerInput)
+    , m_feedForwardInput(feedForwardInput)
+    , m_innerSetpoint(std::function<std::shared_ptr<SetpointSensorPair>()>(innerInput),
+                      std::function<std::shared_ptr<SetpointSensorPair>()>(outerInput))
+    , m_outer(std::move(outerInput), [this]() {
+        // the inner setpoint is owned by the cascade, the shared pointer doesn't manage its lifetime
+        return std::shared_ptr<ProcessValue<out_t>>(std::shared_ptr<ProcessValue<out_t>>(), &m_innerSetpoint);
+    })
+    , m_inner(std::move(innerInput), std::move(output))
+{
+}
+
+void
+PidCascade::update(const duration_millis_t& elapsed)
+{
+    out_t feedForward = 0;
+    if (m_feedForwardGain != 0 && m_feedForwardInput) {
+        auto ffPtr = m_feedForwardInput();
+        auto outerPtr = m_outerInput();
+        if (ffPtr && ffPtr->valueValid() && outerPtr && outerPtr->settingValid()) {
+            feedForward = m_feedForwardGain * (ffPtr->value() - outerPtr->setting());
+        }
+    }
+    m_innerSetpoint.feedForward(feedForward);
+
+    m_outer.update(elapsed);
+    m_inner.update(elapsed);
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PwmScheduler.h"
+#include <algorithm>
+
+constexpr uint8_t PwmScheduler::maxChannels;
+constexpr uint8_t PwmScheduler::noChannel;
+
+namespace {
+// true if a is before b, also when the tick count wrapped in between
+bool
+before(PwmScheduler::ticks_t a, PwmScheduler::ticks_t b)
+{
+    return int32_t(a - b) < 0;
+}
+}
+
+uint8_t
+PwmScheduler::add(Output&& output, ticks_t period, ticks_t activeTime, ticks_t now)
+{
+    auto free = std::find_if(channels.begin(), channels.end(), [](const Channel& c) { return c.id == noChannel; });
+    if (free == channels.end()) {
+        return noChannel;
+    }
+
+    // ids are not reused right away, so a removed channel cannot be changed by accident
+    do {
+        ++lastId;
+    } while (lastId == noChannel || find(lastId));
+
+    *free = Channel{};
+    free->id = lastId;
+    free->output = std::move(output);
+    free->nextPeriod = period;
+    free->nextActiveTime = activeTime;
+    free->nextEdge = now; // the first edge starts a period
+
+    // insert sorted, after channels with an edge at the same time
+    uint8_t pos = count++;
+    order[pos] = free - channels.begin();
+    for (; pos > 0 && before(now, channels[order[pos - 1]].nextEdge); --pos) {
+        std::swap(order[pos], order[pos - 1]);
+    }
+    return free->id;
+}
+
+void
+PwmScheduler::remove(uint8_t id)
+{
+    auto c = find(id);
+    if (!c) {
+        return;
+    }
+    uint8_t index = c - channels.begin();
+    auto end = order.begin() + count;
+    std::remove(order.begin(), end, index);
+    --count;
+    *c = Channel{};
+}
+
+void
+PwmScheduler::set(uint8_t id, ticks_t period, ticks_t activeTime)
+{
+    if (auto c = find(id)) {
+        c->nextPeriod = period;
+        c->nextActiveTime = activeTime;
+    }
+}
+
+PwmScheduler::ticks_t
+PwmScheduler::process(ticks_t now)
+{
+    while (count > 0 && !before(now, nextEdge())) {
+        edge(channels[order[0]], now);
+        ++edges;
+        sortFirst();
+    }
+    return count > 0 ? nextEdge() : now;
+}
+
+PwmScheduler::Channel*
+PwmScheduler::find(uint8_t id)
+{
+    if (id == noChannel) {
+        return nullptr;
+    }
+    auto it = std::find_if(channels.begin(), channels.end(), [id](const Channel& c) { return c.id == id; });
+    return it != channels.end() ? &*it : nullptr;
+}
+
+void
+PwmScheduler::edge(Channel& c, ticks_t now)
+{
+    auto t = c.nextEdge;
+    if (c.active && t != c.periodStart + c.period) {
+        // end of the active part of the period
+        c.active = false;
+        c.output(false);
+        c.nextEdge = c.periodStart + c.period;
+        return;
+    }
+
+    // start of a new period
+    c.period = c.nextPeriod;
+    c.activeTime = std::min(c.nextActiveTime, c.period);
+    if (c.period == 0 || !before(now, t + c.period)) {
+        t = now; // the edge was handled more than a period late, skip the missed periods
+    }
+    c.periodStart = t;
+    c.active = c.activeTime > 0;
+    c.output(c.active); // also at 0% and 100%, to correct an output that was changed by something else
+    c.nextEdge = (c.active && c.activeTime < c.period) ? t + c.activeTime : t + std::max(c.period, ticks_t(1));
+}
+
+void
+PwmScheduler::sortFirst()
+{
+    // only the first channel changed its next edge, move it back to its place
+    for (uint8_t pos = 0; pos + 1 < count && !before(channels[order[pos]].nextEdge, channels[order[pos + 1]].nextEdge); ++pos) {
+        std::swap(order[pos], order[pos + 1]);
+    }
+}
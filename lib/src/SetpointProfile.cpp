@@ -19,42 +19,157 @@
 
 #include "../inc/SetpointProfile.h"
 
+namespace {
+
 void
-SetpointProfile::update(const utc_seconds_t& time)
+appendVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(uint8_t(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(uint8_t(v));
+}
+
+uint64_t
+readVarint(const std::vector<uint8_t>& in, size_t& pos)
+{
+    uint64_t v = 0;
+    uint8_t shift = 0;
+    while (pos < in.size() && shift < 64) {
+        uint8_t b = in[pos++];
+        v |= uint64_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            break;
+        }
+        shift += 7;
+    }
+    return v;
+}
+
+uint64_t
+zigzag(int64_t v)
+{
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+int64_t
+unzigzag(uint64_t v)
+{
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+} // end anonymous namespace
+
+void
+SetpointProfile::Points::push_back(const Point& p)
+{
+    appendVarint(m_encoded, zigzag(int64_t(p.time) - int64_t(m_last.time)));
+    appendVarint(m_encoded, zigzag(int64_t(cnl::unwrap(p.temp)) - int64_t(cnl::unwrap(m_last.temp))));
+    m_last = p;
+    ++m_count;
+}
+
+void
+SetpointProfile::Points::truncate(size_t count)
 {
-    struct TimeStampLessEqual {
-        bool operator()(const Point& p, const utc_seconds_t& time) const { return p.time <= time; }
-        bool operator()(const utc_seconds_t& time, const Point& p) const { return time <= p.time; }
-    };
+    if (count >= m_count) {
+        return;
+    }
+    Point last{0, temp_t(0)};
+    auto it = begin();
+    for (size_t i = 0; i < count; ++i, ++it) {
+        last = *it;
+    }
+    m_encoded.resize(it.m_pos);
+    m_last = last;
+    m_count = count;
+}
 
+void
+SetpointProfile::PointIterator::decode()
+{
+    if (m_pos >= m_encoded->size()) {
+        return;
+    }
+    size_t pos = m_pos;
+    auto time = int64_t(m_point.time) + unzigzag(readVarint(*m_encoded, pos));
+    auto temp = int64_t(cnl::unwrap(m_point.temp)) + unzigzag(readVarint(*m_encoded, pos));
+    m_point = Point{utc_seconds_t(time), cnl::wrap<temp_t>(int32_t(temp))};
+    m_next = pos;
+}
+
+bool
+SetpointProfile::replacePoints(size_t start, const Points& newPoints)
+{
+    if (start > m_points.size()) {
+        return false; // would leave a gap
+    }
+    // the point after the replaced range is stored relative to the previous point, so the points are encoded again
+    Points result;
+    auto it = m_points.begin();
+    auto end = m_points.end();
+    for (size_t i = 0; i < start; ++i, ++it) {
+        result.push_back(*it);
+    }
+    for (const auto& p : newPoints) {
+        result.push_back(p);
+        if (it != end) {
+            ++it;
+        }
+    }
+    for (; it != end; ++it) {
+        result.push_back(*it);
+    }
+    points(std::move(result));
+    return true;
+}
+
+void
+SetpointProfile::update(const utc_seconds_t& time)
+{
     if (!isDriving()) {
         return;
     }
 
-    auto newTemp = temp_t(0);
+    if (time == 0 || m_profileStartTime > time) {
+        return;
+    }
 
-    if (!m_points.empty() && time != 0) {
+    auto elapsed = time - m_profileStartTime;
+    if (m_started && elapsed < m_lower.time) {
+        resetCursor(); // time went back, start searching from the first point again
+    }
 
-        if (m_profileStartTime > time) {
-            return;
-        }
-        auto elapsed = time - m_profileStartTime;
-        auto upper = std::lower_bound(m_points.cbegin(), m_points.cend(), elapsed, TimeStampLessEqual{});
-        if (upper == m_points.cend()) { // every point is in the past, use the last point
-            newTemp = m_points.back().temp;
-        } else if (upper != m_points.cbegin()) { // first point is not in the future
-            auto lower = upper - 1;
-            auto segmentElapsed = elapsed - lower->time;
-            auto segmentDuration = upper->time - lower->time;
-            auto fraction = safe_elastic_fixed_point<1, 30>(cnl::quotient(segmentElapsed, segmentDuration));
-            auto interpolated = lower->temp + temp_t((upper->temp - lower->temp) * fraction);
-            newTemp = interpolated;
-        } else {
-            return;
-        }
-        if (auto targetPtr = m_target()) {
-            targetPtr->setting(newTemp);
-            targetPtr->settingValid(true);
+    // advance cursor to the segment that contains the current time
+    auto end = m_points.end();
+    while (m_upper != end && m_upper->time <= elapsed) {
+        m_lower = *m_upper;
+        m_started = true;
+        m_slopeValid = false;
+        ++m_upper;
+    }
+
+    if (!m_started) {
+        return; // first point is in the future
+    }
+
+    auto newTemp = m_lower.temp;
+    if (m_upper != end) { // interpolate between lower and upper point
+        if (!m_slopeValid) {
+            auto segmentDuration = int64_t(m_upper->time - m_lower.time);
+            auto segmentDelta = int64_t(cnl::unwrap(m_upper->temp)) - int64_t(cnl::unwrap(m_lower.temp));
+            m_slope = (segmentDelta * (int64_t(1) << slopeShift)) / segmentDuration;
+            m_slopeValid = true;
         }
+        auto segmentElapsed = int64_t(elapsed - m_lower.time);
+        auto rounder = int64_t(1) << (slopeShift - 1);
+        auto interpolated = int64_t(cnl::unwrap(m_lower.temp)) + ((m_slope * segmentElapsed + rounder) >> slopeShift);
+        newTemp = cnl::wrap<temp_t>(int32_t(interpolated));
+    }
+
+    if (auto targetPtr = m_target()) {
+        targetPtr->setting(newTemp);
+        targetPtr->settingValid(true);
     }
-}
\ No newline at end of file
+}
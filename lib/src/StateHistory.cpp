@@ -0,0 +1,193 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StateHistory.h"
+#include <algorithm>
+
+using State = StateHistory::State;
+
+void
+StateHistory::add(const State& state, const ticks_millis_t& time)
+{
+    if (m_count == 0 && m_lastState == State::Unknown) {
+        m_baseTime = time; // first change ever
+        m_lastTime = time;
+    }
+    ticks_millis_t delta = time - m_lastTime;
+
+    if (m_lastState == State::Active) {
+        m_totalActiveMillis += delta;
+    }
+    if (state == State::Active && m_lastState != State::Active) {
+        ++m_totalActivations;
+    }
+
+    uint8_t encoded[5];
+    uint8_t length = 0;
+    uint64_t v = (uint64_t(delta) << 2) | uint8_t(state);
+    do {
+        encoded[length] = v & 0x7F;
+        v >>= 7;
+        if (v) {
+            encoded[length] |= 0x80;
+        }
+        ++length;
+    } while (v);
+
+    m_lastTime = time;
+    m_lastState = state;
+
+    if (length > m_buffer.size()) {
+        clear(); // the change doesn't fit, the older changes are no longer followed by a valid delta
+        m_baseTime = time;
+        return;
+    }
+    while (m_buffer.size() - m_used < length) {
+        dropOldest();
+    }
+    uint16_t pos = (m_head + m_used) % m_buffer.size();
+    for (uint8_t i = 0; i < length; ++i) {
+        m_buffer[pos] = encoded[i];
+        pos = (pos + 1) % m_buffer.size();
+    }
+    m_used += length;
+    ++m_count;
+}
+
+void
+StateHistory::clear()
+{
+    m_head = 0;
+    m_used = 0;
+    m_count = 0;
+    m_baseTime = m_lastTime;
+}
+
+uint8_t
+StateHistory::decode(uint16_t pos, ticks_millis_t& delta, State& state) const
+{
+    uint64_t v = 0;
+    uint8_t length = 0;
+    uint8_t b;
+    do {
+        b = m_buffer[(pos + length) % m_buffer.size()];
+        v |= uint64_t(b & 0x7F) << (7 * length);
+        ++length;
+    } while ((b & 0x80) && length < 5);
+    delta = ticks_millis_t(v >> 2);
+    state = State(v & 0x03);
+    return length;
+}
+
+void
+StateHistory::dropOldest()
+{
+    ticks_millis_t delta;
+    State state;
+    auto length = decode(m_head, delta, state);
+    m_baseTime += delta;
+    m_head = (m_head + length) % m_buffer.size();
+    m_used -= length;
+    --m_count;
+}
+
+void
+StateHistory::forEach(const std::function<void(const State& state, const ticks_millis_t& time)>& visit) const
+{
+    auto time = m_baseTime;
+    uint16_t offset = 0;
+    while (offset < m_used) {
+        ticks_millis_t delta;
+        State state;
+        offset += decode(m_head + offset, delta, state);
+        time += delta;
+        visit(state, time);
+    }
+}
+
+StateHistory::Aggregates
+StateHistory::aggregate(const ticks_millis_t& since, const ticks_millis_t& now) const
+{
+    Aggregates result;
+    auto prevState = State::Unknown;
+    auto prevTime = since;
+    bool first = true;
+
+    // the active time of each period is clipped to the time since 'since'
+    auto addPeriod = [&](const ticks_millis_t& end) {
+        if (prevState == State::Active && int32_t(end - since) > 0) {
+            auto start = int32_t(prevTime - since) > 0 ? prevTime : since;
+            result.activeMillis += end - start;
+        }
+    };
+
+    forEach([&](const State& state, const ticks_millis_t& time) {
+        if (first) {
+            result.complete = int32_t(since - time) >= 0;
+            first = false;
+        }
+        addPeriod(time);
+        if (int32_t(time - since) >= 0) {
+            ++result.changes;
+            if (state == State::Active && prevState != State::Active) {
+                ++result.activations;
+            }
+        }
+        prevState = state;
+        prevTime = time;
+    });
+    addPeriod(now);
+    return result;
+}
+
+StateHistory::Aggregates
+StateHistory::totals(const ticks_millis_t& now) const
+{
+    Aggregates result;
+    result.activations = m_totalActivations;
+    result.activeMillis = m_totalActiveMillis;
+    if (m_lastState == State::Active) {
+        result.activeMillis += now - m_lastTime;
+    }
+    result.complete = true;
+    return result;
+}
+
+bool
+StateHistory::streamTo(const std::function<bool(uint8_t)>& write, const ticks_millis_t& now) const
+{
+    auto writeLittleEndian = [&write](uint32_t v, uint8_t bytes) {
+        for (uint8_t i = 0; i < bytes; ++i) {
+            if (!write(uint8_t(v >> (8 * i)))) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!writeLittleEndian(now - m_baseTime, 4) || !writeLittleEndian(m_count, 2) || !writeLittleEndian(m_used, 2)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < m_used; ++i) {
+        if (!write(m_buffer[(m_head + i) % m_buffer.size()])) {
+            return false;
+        }
+    }
+    return true;
+}
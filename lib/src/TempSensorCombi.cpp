@@ -18,67 +18,95 @@
  */
 
 #include "TempSensorCombi.h"
+#include <algorithm>
+#include <limits>
 
 void
-TempSensorCombi::update()
+TempSensorCombi::sortSamples()
 {
+    std::sort(m_samples.begin(), m_samples.end(), [](const Sample& a, const Sample& b) {
+        return a.value < b.value;
+    });
+}
+
+// assumes the samples are sorted and not empty
+temp_t
+TempSensorCombi::median() const
+{
+    auto mid = m_samples.size() / 2;
+    if (m_samples.size() % 2 == 0) {
+        auto sum = int32_t(cnl::unwrap(m_samples[mid - 1].value)) + int32_t(cnl::unwrap(m_samples[mid].value));
+        return cnl::wrap<temp_t>(sum / 2);
+    }
+    return m_samples[mid].value;
+}
+
+void
+TempSensorCombi::update(const ticks_millis_t& now)
+{
+    auto elapsed = m_updated ? duration_millis_t(now - m_lastUpdate) : duration_millis_t(0);
+    m_lastUpdate = now;
+    m_updated = true;
+
+    m_samples.clear();
+    for (auto& input : inputs) {
+        auto sens = input.lookup ? input.lookup() : nullptr;
+        if (sens && sens->valid()) {
+            m_samples.push_back(Sample{sens->value(), input.weight});
+            input.stale = 0;
+        } else {
+            input.stale = std::min<uint64_t>(uint64_t(input.stale) + elapsed, std::numeric_limits<duration_millis_t>::max());
+        }
+    }
+
     m_value = 0;
     m_valid = false;
+    if (m_samples.empty()) {
+        return;
+    }
+
+    if (func == CombineFunc::MEDIAN || outlierThreshold > temp_t{0}) {
+        sortSamples();
+    }
+
+    if (outlierThreshold > temp_t{0} && m_samples.size() >= 3) {
+        auto center = median();
+        auto isOutlier = [this, &center](const Sample& s) {
+            auto diff = s.value - center;
+            return diff > outlierThreshold || -diff > outlierThreshold;
+        };
+        m_samples.erase(std::remove_if(m_samples.begin(), m_samples.end(), isOutlier), m_samples.end());
+    }
+
     switch (func) {
     case CombineFunc::AVG: {
-        auto sum = safe_elastic_fixed_point<18, 12>{0};
-        uint16_t count = 0;
-        for (auto sensorLookup : inputs) {
-            if (auto sens = sensorLookup()) {
-                if (sens->valid()) {
-                    ++count;
-                    sum += sens->value();
-                }
-            }
+        int64_t sum = 0;
+        uint32_t totalWeight = 0;
+        for (const auto& s : m_samples) {
+            sum += int64_t(cnl::unwrap(s.value)) * s.weight;
+            totalWeight += s.weight;
         }
-        if (count > 0) {
+        if (totalWeight > 0) {
             m_valid = true;
-            m_value = sum / count;
-        } else {
-            m_valid = false;
+            m_value = cnl::wrap<temp_t>(int32_t(sum / totalWeight));
         }
         return;
     }
-    case CombineFunc::MIN: {
-        for (auto sensorLookup : inputs) {
-            if (auto sens = sensorLookup()) {
-                if (sens->valid()) {
-                    if (m_valid) {
-                        auto v = sens->value();
-                        if (v < m_value) {
-                            m_value = v;
-                        }
-                    } else {
-                        m_value = sens->value();
-                    }
-                    m_valid = true;
-                }
-            }
-        }
+    case CombineFunc::MIN:
+        m_valid = true;
+        m_value = std::min_element(m_samples.cbegin(), m_samples.cend(), [](const Sample& a, const Sample& b) {
+                      return a.value < b.value;
+                  })->value;
         return;
-    }
-    case CombineFunc::MAX: {
-        for (auto sensorLookup : inputs) {
-            if (auto sens = sensorLookup()) {
-                if (sens->valid()) {
-                    if (m_valid) {
-                        auto v = sens->value();
-                        if (v > m_value) {
-                            m_value = v;
-                        }
-                    } else {
-                        m_value = sens->value();
-                    }
-                    m_valid = true;
-                }
-            }
-        }
+    case CombineFunc::MAX:
+        m_valid = true;
+        m_value = std::max_element(m_samples.cbegin(), m_samples.cend(), [](const Sample& a, const Sample& b) {
+                      return a.value < b.value;
+                  })->value;
+        return;
+    case CombineFunc::MEDIAN:
+        m_valid = true;
+        m_value = median();
         return;
-    }
     }
 }
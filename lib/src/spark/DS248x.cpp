@@ -27,6 +27,7 @@ Updates:
  */
 
 #include "../inc/DS248x.h"
+#include "../inc/OneWireCrc.h"
 #include "spark_wiring.h"
 #include "spark_wiring_i2c.h"
 
@@ -36,7 +37,7 @@ Updates:
 #define PTR_PORTCONFIG 0xb4 //DS2484 only
 
 bool
-DS248x::busyWait()
+DS248x::readStatus()
 {
     Wire.beginTransmission(mAddress);
     Wire.write(DS248X_SRP);
@@ -44,10 +45,18 @@ DS248x::busyWait()
     if (Wire.endTransmission() != 0) {
         return false;
     }
+    if (Wire.requestFrom(mAddress, size_t{1})) {
+        mStatus = Wire.read();
+        return true;
+    }
+    return false;
+}
 
+bool
+DS248x::busyWait()
+{
     for (uint8_t retries = 0; retries < 5; retries++) {
-        if (Wire.requestFrom(mAddress, size_t{1})) {
-            mStatus = Wire.read();
+        if (readStatus()) {
             if ((mStatus & DS248X_STATUS_BUSY) == 0) {
                 return true;
             }
@@ -202,6 +211,56 @@ DS248x::read(uint8_t& b)
     return false;
 }
 
+bool
+DS248x::readCommandStatus()
+{
+    if (Wire.requestFrom(mAddress, size_t{1})) {
+        mStatus = Wire.read();
+        return true;
+    }
+    return false;
+}
+
+bool
+DS248x::commandWait()
+{
+    for (uint8_t retries = 0; retries < 5; retries++) {
+        if (readCommandStatus()) {
+            if ((mStatus & DS248X_STATUS_BUSY) == 0) {
+                return true;
+            }
+            delayMicroseconds(50);
+        }
+    }
+    init();
+    return false;
+}
+
+bool
+DS248x::read_bytes(uint8_t* buf, uint16_t count, uint8_t& crc)
+{
+    if (!busyWait()) {
+        return false;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        Wire.beginTransmission(mAddress);
+        Wire.write(DS248X_1WRB);
+        if (Wire.endTransmission() != 0 || !commandWait()) {
+            return false;
+        }
+        // the bridge is idle after reading the byte, the next command can follow without checking the status again
+        Wire.beginTransmission(mAddress);
+        Wire.write(DS248X_SRP);
+        Wire.write(PTR_READ);
+        if (Wire.endTransmission() != 0 || !Wire.requestFrom(mAddress, size_t{1})) {
+            return false;
+        }
+        buf[i] = Wire.read();
+        crc = OneWireCrc8Update(buf[i], crc);
+    }
+    return true;
+}
+
 bool
 DS248x::write_bit(bool bit)
 {
@@ -243,3 +302,77 @@ DS248x::search_triplet(bool search_direction)
     busyWait();
     return mStatus;
 }
+
+bool
+DS248x::start(AsyncOp op, uint8_t value)
+{
+    if (readStatus() && (mStatus & DS248X_STATUS_BUSY)) {
+        return false; // previous operation still in progress, try again later
+    }
+
+    Wire.beginTransmission(mAddress);
+    switch (op) {
+    case AsyncOp::RESET:
+        Wire.write(DS248X_1WRS);
+        break;
+    case AsyncOp::WRITE:
+        Wire.write(DS248X_1WWB);
+        Wire.write(value);
+        break;
+    case AsyncOp::READ:
+        Wire.write(DS248X_1WRB);
+        break;
+    case AsyncOp::WRITE_BIT:
+        Wire.write(DS248X_1WSB);
+        Wire.write(value ? 0x80 : 0);
+        break;
+    case AsyncOp::READ_BIT:
+        Wire.write(DS248X_1WSB);
+        Wire.write(0x80);
+        break;
+    case AsyncOp::SEARCH_TRIPLET:
+        Wire.write(DS248X_1WT);
+        Wire.write(value ? 0x80 : 0x00);
+        break;
+    }
+    // a failed command is reported by the next poll, so the queue always makes progress
+    mPendingFailed = Wire.endTransmission() != 0;
+    mPendingOp = op;
+    return true;
+}
+
+DS248x::AsyncStatus
+DS248x::poll(uint8_t& result)
+{
+    // start() has sent a 1-Wire command, so the status is read without setting the read pointer
+    if (mPendingFailed || !readCommandStatus()) {
+        return AsyncStatus::FAILED;
+    }
+    if (mStatus & DS248X_STATUS_BUSY) {
+        return AsyncStatus::BUSY;
+    }
+
+    switch (mPendingOp) {
+    case AsyncOp::RESET:
+        result = (mStatus & DS248X_STATUS_PPD) ? 1 : 0;
+        break;
+    case AsyncOp::READ:
+        Wire.beginTransmission(mAddress);
+        Wire.write(DS248X_SRP);
+        Wire.write(PTR_READ);
+        if (Wire.endTransmission() != 0 || !Wire.requestFrom(mAddress, size_t{1})) {
+            return AsyncStatus::FAILED;
+        }
+        result = Wire.read();
+        break;
+    case AsyncOp::READ_BIT:
+        result = (mStatus & DS248X_STATUS_SBR) ? 1 : 0;
+        break;
+    case AsyncOp::SEARCH_TRIPLET:
+        result = mStatus; // the search bits and the chosen direction
+        break;
+    default:
+        break;
+    }
+    return AsyncStatus::DONE;
+}
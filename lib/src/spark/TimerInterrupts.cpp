@@ -1,25 +1,53 @@
 #include "TimerInterrupts.h"
 #include "spark_wiring_interrupts.h"
-#include <algorithm>
-#include <functional>
-#include <vector>
 
-struct FuncEntry {
-    uint8_t id;
-    std::function<void()> func;
-};
+static PwmScheduler scheduler;
+static volatile uint16_t timerWraps = 0;
 
-static std::vector<FuncEntry> funcs;
+// The 16 bit timer counter, extended with the number of times it wrapped
+static PwmScheduler::ticks_t
+timerNow()
+{
+    uint16_t wraps = timerWraps;
+    uint16_t counter = TIM_GetCounter(TIM4);
+    if (TIM_GetITStatus(TIM4, TIM_IT_Update) != RESET && counter < 0x8000) {
+        ++wraps; // wrapped, but the update interrupt is not handled yet
+    }
+    return (PwmScheduler::ticks_t(wraps) << 16) | counter;
+}
+
+// Program the compare for the next edge. Edges more than a counter wrap ahead trigger an early compare, which is harmless.
+static void
+scheduleNext(PwmScheduler::ticks_t next)
+{
+    if (scheduler.empty()) {
+        TIM_ITConfig(TIM4, TIM_IT_CC1, DISABLE);
+        return;
+    }
+    TIM_SetCompare1(TIM4, uint16_t(next));
+    TIM_ClearITPendingBit(TIM4, TIM_IT_CC1);
+    TIM_ITConfig(TIM4, TIM_IT_CC1, ENABLE);
+    if (int32_t(next - timerNow()) <= 0) {
+        // the counter already passed the compare value, handle the edge right away
+        TIM_GenerateEvent(TIM4, TIM_EventSource_CC1);
+    }
+}
 
 void
-timerIsrHandler()
+timerWrapHandler()
 {
     if (TIM_GetITStatus(TIM4, TIM_IT_Update) != RESET) {
         TIM_ClearITPendingBit(TIM4, TIM_IT_Update);
+        ++timerWraps;
+    }
+}
 
-        for (auto& fe : funcs) {
-            fe.func();
-        }
+void
+timerCompareHandler()
+{
+    if (TIM_GetITStatus(TIM4, TIM_IT_CC1) != RESET) {
+        TIM_ClearITPendingBit(TIM4, TIM_IT_CC1);
+        scheduleNext(scheduler.process(timerNow()));
     }
 }
 
@@ -37,45 +65,57 @@ TimerInterrupts::init()
     nvicStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&nvicStructure);
 
-    // Timebase configuration (10 kHz), so we can get 100 steps resolution for 100Hz PWM
+    // Free running timebase of 10 kHz, so we can get 100 steps resolution for 100Hz PWM
     // SysCoreClock = 120 Mhz, timer clock is 60MHz, 60Mhz / 6000 = 10kHz
     TIM_TimeBaseInitTypeDef timerInitStructure;
-    timerInitStructure.TIM_Prescaler = 5; // divides by 6
+    timerInitStructure.TIM_Prescaler = 5999;
     timerInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
-    timerInitStructure.TIM_Period = 1000;
+    timerInitStructure.TIM_Period = 0xFFFF;
     timerInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
     timerInitStructure.TIM_RepetitionCounter = 0;
-
     TIM_TimeBaseInit(TIM4, &timerInitStructure);
+
+    // Compare channel 1 only generates an interrupt, it is not connected to a pin
+    TIM_OCInitTypeDef compareInitStructure;
+    TIM_OCStructInit(&compareInitStructure);
+    compareInitStructure.TIM_OCMode = TIM_OCMode_Timing;
+    TIM_OC1Init(TIM4, &compareInitStructure);
+    TIM_OC1PreloadConfig(TIM4, TIM_OCPreload_Disable);
+
+    attachSystemInterrupt(SysInterrupt_TIM4_Update, timerWrapHandler);
+    attachSystemInterrupt(SysInterrupt_TIM4_Compare1, timerCompareHandler);
+
     TIM_ITConfig(TIM4, TIM_IT_Update, ENABLE);
     TIM_Cmd(TIM4, ENABLE);
-
-    attachSystemInterrupt(SysInterrupt_TIM4_Update, timerIsrHandler);
 }
 
-int16_t
-TimerInterrupts::add(std::function<void()>&& func)
+uint8_t
+TimerInterrupts::addPwm(PwmScheduler::Output&& output, PwmScheduler::ticks_t period, PwmScheduler::ticks_t activeTime)
 {
-    for (uint8_t id = 1; id < 255; id++) {
-        // find free id
-        auto match = find_if(funcs.begin(), funcs.end(), [&id](const FuncEntry& fe) {
-            return fe.id == id;
-        });
+    uint8_t id = PwmScheduler::noChannel;
+    ATOMIC_BLOCK()
+    {
+        id = scheduler.add(std::move(output), period, activeTime, timerNow());
+        scheduleNext(scheduler.nextEdge());
+    }
+    return id;
+}
 
-        if (match == funcs.end()) {
-            funcs.push_back(FuncEntry{id, std::move(func)});
-            TIM_Cmd(TIM4, ENABLE);
-            return id;
-        }
-    };
-    return 0;
+void
+TimerInterrupts::setPwm(uint8_t id, PwmScheduler::ticks_t period, PwmScheduler::ticks_t activeTime)
+{
+    ATOMIC_BLOCK()
+    {
+        scheduler.set(id, period, activeTime);
+    }
 }
 
 void
-TimerInterrupts::remove(uint8_t id)
+TimerInterrupts::removePwm(uint8_t id)
 {
-    funcs.erase(std::remove_if(funcs.begin(), funcs.end(), [&id](const FuncEntry& fe) { return fe.id == id; }), funcs.end());
-    if (funcs.empty()) {
-        TIM_Cmd(TIM4, DISABLE);
+    ATOMIC_BLOCK()
+    {
+        scheduler.remove(id);
+        scheduleNext(scheduler.empty() ? 0 : scheduler.nextEdge());
     }
 }
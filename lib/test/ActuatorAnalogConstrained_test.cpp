@@ -211,3 +211,140 @@ SCENARIO("When two analog actuators are constrained by a balancer", "[constraint
         }
     }
 }
+
+SCENARIO("A balancer with a weighted or priority policy", "[constraints]")
+{
+    using value_t = ActuatorAnalog::value_t;
+    auto balancer = std::make_shared<Balancer<2>>();
+    ActuatorAnalogMock act1(0, 0, 100);
+    ActuatorAnalogMock act2(0, 0, 100);
+    ActuatorAnalogMock act3(0, 0, 100);
+    ActuatorAnalogConstrained cAct1(act1);
+    ActuatorAnalogConstrained cAct2(act2);
+    ActuatorAnalogConstrained cAct3(act3);
+
+    // the balancer sets the actuators again when it has calculated the grants
+    cAct1.addConstraint(std::make_unique<AAConstraints::Balanced<2>>([balancer]() { return balancer; }, 1, 0, [&cAct1]() { cAct1.update(); }));
+    cAct2.addConstraint(std::make_unique<AAConstraints::Balanced<2>>([balancer]() { return balancer; }, 3, 1, [&cAct2]() { cAct2.update(); }));
+    cAct3.addConstraint(std::make_unique<AAConstraints::Balanced<2>>([balancer]() { return balancer; }, 1, 1, [&cAct3]() { cAct3.update(); }));
+
+    // request and let the balancer update, which applies the grants
+    auto request = [&](value_t v1, value_t v2, value_t v3) {
+        cAct1.setting(v1);
+        cAct2.setting(v2);
+        cAct3.setting(v3);
+        balancer->update();
+    };
+
+    auto totalGranted = [&balancer]() {
+        auto total = value_t(0);
+        for (auto& client : balancer->clients()) {
+            total += client.granted;
+        }
+        return total;
+    };
+
+    WHEN("All actuators have made their request, the grants don't change until the balancer updates")
+    {
+        cAct1.setting(60);
+        cAct2.setting(60);
+        cAct3.setting(60);
+        for (auto& client : balancer->clients()) {
+            CHECK(client.granted == value_t(0));
+        }
+        balancer->update();
+        for (auto& client : balancer->clients()) {
+            CHECK(client.granted == Approx(33.333).margin(0.01));
+        }
+
+        THEN("The new grants are applied to all actuators in the same update")
+        {
+            CHECK(cAct1.setting() == Approx(33.333).margin(0.01));
+            CHECK(cAct2.setting() == Approx(33.333).margin(0.01));
+            CHECK(cAct3.setting() == Approx(33.333).margin(0.01));
+        }
+
+        THEN("A higher request is limited to the grant until the next update")
+        {
+            cAct1.setting(80);
+            CHECK(cAct1.setting() == Approx(33.333).margin(0.01));
+        }
+    }
+
+    WHEN("Any combination of requests is made, the total granted never exceeds the available total")
+    {
+        const value_t requests[] = {0, 1, 10, 33.3, 50, 60, 99.9, 100};
+        for (auto policy : {BalancerImpl::Policy::PROPORTIONAL, BalancerImpl::Policy::WEIGHTED, BalancerImpl::Policy::PRIORITY}) {
+            balancer->policy(policy);
+            for (auto v1 : requests) {
+                for (auto v2 : requests) {
+                    for (auto v3 : requests) {
+                        request(v1, v2, v3);
+                        CHECK(totalGranted() <= balancer->available);
+                        CHECK(cAct1.setting() + cAct2.setting() + cAct3.setting() <= balancer->available);
+                    }
+                }
+            }
+        }
+    }
+
+    WHEN("The policy is weighted")
+    {
+        balancer->policy(BalancerImpl::Policy::WEIGHTED);
+
+        THEN("The total is divided in proportion to the weights")
+        {
+            request(100, 100, 100);
+            CHECK(cAct1.setting() == Approx(20).margin(0.01));
+            CHECK(cAct2.setting() == Approx(60).margin(0.01));
+            CHECK(cAct3.setting() == Approx(20).margin(0.01));
+        }
+
+        THEN("A request that is smaller than its share is granted fully and the rest is divided by weight")
+        {
+            request(100, 10, 100);
+            CHECK(cAct1.setting() == Approx(45).margin(0.01));
+            CHECK(cAct2.setting() == Approx(10).margin(0.01));
+            CHECK(cAct3.setting() == Approx(45).margin(0.01));
+        }
+
+        THEN("When the total is not used, the excess is divided by weight")
+        {
+            request(10, 10, 10);
+            CHECK(balancer->clients()[0].granted == Approx(24).margin(0.01));
+            CHECK(balancer->clients()[1].granted == Approx(52).margin(0.01));
+            CHECK(balancer->clients()[2].granted == Approx(24).margin(0.01));
+        }
+    }
+
+    WHEN("The policy is priority")
+    {
+        balancer->policy(BalancerImpl::Policy::PRIORITY);
+
+        THEN("Requests are granted in order of priority, with equal priority in order of registration")
+        {
+            request(50, 70, 70);
+            CHECK(cAct1.setting() == value_t(0));
+            CHECK(cAct2.setting() == Approx(70).margin(0.01));
+            CHECK(cAct3.setting() == Approx(30).margin(0.01));
+        }
+
+        THEN("What is not requested goes to the requester with the highest priority")
+        {
+            request(10, 20, 30);
+            CHECK(balancer->clients()[0].granted == Approx(10).margin(0.01));
+            CHECK(balancer->clients()[1].granted == Approx(60).margin(0.01));
+            CHECK(balancer->clients()[2].granted == Approx(30).margin(0.01));
+        }
+    }
+
+    WHEN("An actuator is removed, its id is reused by the next actuator")
+    {
+        auto id = balancer->clients()[1].id;
+        cAct2.removeAllConstraints();
+        CHECK(balancer->clients().size() == 2);
+        cAct2.addConstraint(std::make_unique<AAConstraints::Balanced<2>>([balancer]() { return balancer; }));
+        CHECK(balancer->clients().size() == 3);
+        CHECK(balancer->clients()[1].id == id);
+    }
+}
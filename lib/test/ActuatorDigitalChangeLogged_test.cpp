@@ -173,3 +173,108 @@ SCENARIO("ActuatorDigitalChangeLogged test", "[ActuatorChangeLog]")
         }
     }
 }
+
+SCENARIO("ActuatorDigitalChangeLogged can keep a longer state history", "[ActuatorChangeLog]")
+{
+    using State = ActuatorDigitalBase::State;
+
+    auto mockIo = std::make_shared<MockIoArray>();
+    ActuatorDigital mock([mockIo]() { return mockIo; }, 1);
+    ActuatorDigitalChangeLogged logged(mock);
+
+    CHECK(logged.stateHistory() == nullptr);
+    CHECK(logged.stateHistorySize() == 0);
+    CHECK(logged.stateHistorySize(100));
+    CHECK(logged.stateHistorySize() == 100);
+    REQUIRE(logged.stateHistory() != nullptr);
+    const auto& history = *logged.stateHistory();
+
+    WHEN("A size above the maximum is requested")
+    {
+        THEN("It is rejected and the history is kept")
+        {
+            CHECK_FALSE(logged.stateHistorySize(ActuatorDigitalChangeLogged::maxStateHistorySize + 1));
+            CHECK(logged.stateHistorySize() == 100);
+            CHECK(logged.stateHistory() == &history);
+        }
+    }
+
+    WHEN("A compressor switches on for 10 minutes every 30 minutes")
+    {
+        ticks_millis_t now = 0;
+        for (uint8_t i = 0; i < 6; ++i) {
+            logged.state(State::Active, now);
+            now += 600000;
+            logged.state(State::Inactive, now);
+            now += 1200000;
+        }
+
+        THEN("All changes are logged with their time")
+        {
+            std::vector<ticks_millis_t> times;
+            history.forEach([&times](const State&, const ticks_millis_t& time) {
+                times.push_back(time);
+            });
+            REQUIRE(times.size() == 13); // the initial state and 12 changes
+            CHECK(times[0] == 0);
+            CHECK(times[1] == 0);
+            CHECK(times[2] == 600000);
+            CHECK(times[12] == 5 * 1800000 + 600000);
+        }
+
+        THEN("The number of activations and the active time per hour can be queried")
+        {
+            auto lastHour = history.aggregate(now - 3600000, now);
+            CHECK(lastHour.activations == 2);
+            CHECK(lastHour.activeMillis == 1200000);
+            CHECK(lastHour.complete);
+
+            auto totals = history.totals(now);
+            CHECK(totals.activations == 6);
+            CHECK(totals.activeMillis == 3600000);
+        }
+
+        THEN("Changes that are minutes apart take 4 bytes or less")
+        {
+            CHECK(history.bytesUsed() <= 4 * history.size());
+        }
+
+        AND_WHEN("The history is full, the oldest changes are dropped and the totals are kept")
+        {
+            for (uint16_t i = 0; i < 100; ++i) {
+                logged.state(State::Active, now);
+                now += 1000;
+                logged.state(State::Inactive, now);
+                now += 1000;
+            }
+            CHECK(history.bytesUsed() <= history.capacity());
+            CHECK(history.size() >= 50);
+
+            ticks_millis_t last = 0;
+            history.forEach([&last](const State&, const ticks_millis_t& time) {
+                last = time;
+            });
+            CHECK(last == now - 1000);
+
+            auto all = history.aggregate(0, now);
+            CHECK(!all.complete);
+            CHECK(history.totals(now).activations == 106);
+            CHECK(history.totals(now).activeMillis == 3600000 + 100000);
+        }
+
+        AND_WHEN("The history is exported")
+        {
+            std::vector<uint8_t> exported;
+            CHECK(history.streamTo([&exported](uint8_t b) { exported.push_back(b); return true; }, now));
+
+            THEN("It contains a header and the encoded changes")
+            {
+                REQUIRE(exported.size() == size_t(8 + history.bytesUsed()));
+                uint32_t age = exported[0] | (exported[1] << 8) | (exported[2] << 16) | (uint32_t(exported[3]) << 24);
+                CHECK(age == now);
+                CHECK((exported[4] | (exported[5] << 8)) == history.size());
+                CHECK((exported[6] | (exported[7] << 8)) == history.bytesUsed());
+            }
+        }
+    }
+}
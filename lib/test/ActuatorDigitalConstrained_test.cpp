@@ -35,7 +35,7 @@ SCENARIO("ActuatorDigitalConstrained", "[constraints]")
 
     WHEN("A minimum ON time constrained is added, the actuator cannot turn off before it has passed")
     {
-        constrained.addConstraint(std::make_unique<ADConstraints::MinOnTime<2>>(1500));
+        constrained.addConstraint(ADConstraints::MinOnTime(1500));
         constrained.desiredState(State::Active, now);
         CHECK(constrained.state() == State::Active);
         CHECK(mock.state() == State::Active);
@@ -53,7 +53,7 @@ SCENARIO("ActuatorDigitalConstrained", "[constraints]")
 
     WHEN("A minimum OFF time constrained is added, the actuator cannot turn on before it has passed")
     {
-        constrained.addConstraint(std::make_unique<ADConstraints::MinOffTime<1>>(1500));
+        constrained.addConstraint(ADConstraints::MinOffTime(1500));
         constrained.desiredState(State::Inactive, now);
         CHECK(constrained.state() == State::Inactive);
         CHECK(mock.state() == State::Inactive);
@@ -72,8 +72,8 @@ SCENARIO("ActuatorDigitalConstrained", "[constraints]")
     WHEN("A minimum ON and a minimum OFF time are added, both are honored")
     {
         constrained.desiredState(State::Inactive, now);
-        constrained.addConstraint(std::make_unique<ADConstraints::MinOffTime<1>>(1000));
-        constrained.addConstraint(std::make_unique<ADConstraints::MinOnTime<2>>(2000));
+        constrained.addConstraint(ADConstraints::MinOffTime(1000));
+        constrained.addConstraint(ADConstraints::MinOnTime(2000));
 
         while (constrained.state() == State::Inactive) {
             constrained.desiredState(State::Active, ++now);
@@ -93,7 +93,7 @@ SCENARIO("ActuatorDigitalConstrained", "[constraints]")
     {
         now = 1;
         constrained.desiredState(State::Inactive, now);
-        constrained.addConstraint(std::make_unique<ADConstraints::DelayedOn<5>>(1500));
+        constrained.addConstraint(ADConstraints::DelayedOn(1500));
         constrained.desiredState(State::Active, now);
         CHECK(constrained.state() == State::Inactive);
         CHECK(mock.state() == State::Inactive);
@@ -113,7 +113,7 @@ SCENARIO("ActuatorDigitalConstrained", "[constraints]")
     {
         now = 1;
         constrained.desiredState(State::Active, now);
-        constrained.addConstraint(std::make_unique<ADConstraints::DelayedOff<5>>(1500));
+        constrained.addConstraint(ADConstraints::DelayedOff(1500));
         constrained.desiredState(State::Inactive, now);
         CHECK(constrained.state() == State::Active);
         CHECK(mock.state() == State::Active);
@@ -140,13 +140,13 @@ SCENARIO("Mutex contraint", "[constraints]")
     ActuatorDigitalConstrained constrained2(mock2);
     auto mut = std::make_shared<MutexTarget>();
 
-    constrained1.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+    constrained1.addConstraint(ADConstraints::Mutex(
         [&mut]() {
             return mut;
         },
         0,
         true));
-    constrained2.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+    constrained2.addConstraint(ADConstraints::Mutex(
         [&mut]() {
             return mut;
         },
@@ -170,13 +170,37 @@ SCENARIO("Mutex contraint", "[constraints]")
 
     WHEN("A minimum OFF time constraint holds an actuator low, it doesn't lock the mutex")
     {
-        constrained1.addConstraint(std::make_unique<ADConstraints::MinOffTime<1>>(1000));
+        constrained1.addConstraint(ADConstraints::MinOffTime(1000));
         constrained1.desiredState(State::Active, ++now);
         CHECK(constrained1.state() == State::Inactive);
         constrained2.desiredState(State::Active, ++now);
         CHECK(constrained2.state() == State::Active);
     }
 
+    WHEN("An actuator is switched from interrupt context, it only turns on while it owns the mutex")
+    {
+        constrained1.desiredState(State::Active, ++now);
+        CHECK(constrained1.state() == State::Active);
+
+        constrained2.setStateUnlogged(State::Active);
+        CHECK(constrained2.state() == State::Inactive);
+        CHECK(constrained2.desiredState() == State::Active);
+
+        constrained1.setStateUnlogged(State::Inactive);
+        constrained1.setStateUnlogged(State::Active);
+        CHECK(constrained1.state() == State::Active);
+
+        THEN("The other actuator gets the mutex in its next update, when the owner releases it")
+        {
+            constrained1.desiredState(State::Inactive, ++now);
+            constrained2.update(++now);
+            CHECK(constrained2.state() == State::Active);
+
+            constrained1.setStateUnlogged(State::Active);
+            CHECK(constrained1.state() == State::Inactive);
+        }
+    }
+
     WHEN("An actuator doesn't have the mutex, it won't unlock it when set to Inactive")
     {
         constrained1.desiredState(State::Active, ++now);
@@ -186,16 +210,42 @@ SCENARIO("Mutex contraint", "[constraints]")
         CHECK(constrained2.state() == State::Inactive);
     }
 
+    WHEN("Many mutex constraints are created and destroyed while actuator 1 owns the mutex")
+    {
+        constrained1.desiredState(State::Active, ++now);
+        CHECK(constrained1.state() == State::Active);
+        ActuatorDigital mock3([mockIo]() { return mockIo; }, 3);
+
+        THEN("None of them gets the token of actuator 1 when the token counter wraps, so none can turn on")
+        {
+            uint32_t activated = 0;
+            for (uint32_t i = 0; i <= 0xFFFF; i++) {
+                ActuatorDigitalConstrained constrained3(mock3);
+                constrained3.addConstraint(ADConstraints::Mutex(
+                    [&mut]() {
+                        return mut;
+                    },
+                    0, true));
+                constrained3.desiredState(State::Active, now);
+                if (constrained3.state() == State::Active) {
+                    ++activated;
+                    constrained3.desiredState(State::Inactive, now);
+                }
+            }
+            CHECK(activated == 0);
+        }
+    }
+
     WHEN("An extra hold time of 1000 is set on actuator 1, and it was active earlier")
     {
         constrained1.removeAllConstraints();
         constrained2.removeAllConstraints();
-        constrained1.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+        constrained1.addConstraint(ADConstraints::Mutex(
             [&mut]() {
                 return mut;
             },
             1000, true));
-        constrained2.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+        constrained2.addConstraint(ADConstraints::Mutex(
             [&mut]() {
                 return mut;
             },
@@ -213,11 +263,23 @@ SCENARIO("Mutex contraint", "[constraints]")
             CHECK(constrained1.state() == State::Active);
         }
 
+        THEN("Actuator 1 has the lock until its hold time has passed")
+        {
+            auto mutex1 = constrained1.constraintsList().begin()->mutex();
+            CHECK(mutex1->hasLock());
+            now += 999;
+            mut->update(now);
+            CHECK(mutex1->hasLock());
+            now += 1;
+            mut->update(now);
+            CHECK(!mutex1->hasLock());
+        }
+
         THEN("Actuator 2 has to wait until no actuator has been active for 1000ms")
         {
             constrained2.desiredState(State::Active, ++now);
             CHECK(constrained2.state() == State::Inactive);
-            CHECK(mut->timeRemaining() == 1000);
+            CHECK(mut->timeRemaining() == 999); // released 1ms ago
 
             while (constrained2.state() != State::Active && now < 2000) {
                 ++now;
@@ -239,7 +301,7 @@ SCENARIO("Mutex contraint", "[constraints]")
         {
             constrained2.desiredState(State::Active, ++now);
             CHECK(constrained2.state() == State::Inactive);
-            CHECK(mut->timeRemaining() == 1000);
+            CHECK(mut->timeRemaining() == 999); // released 1ms ago
 
             while (constrained2.state() != State::Active && now < 500) {
                 ++now;
@@ -287,12 +349,12 @@ SCENARIO("Mutex contraint", "[constraints]")
 
         constrained1.removeAllConstraints();
         constrained2.removeAllConstraints();
-        constrained1.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+        constrained1.addConstraint(ADConstraints::Mutex(
             [&mut]() {
                 return mut;
             },
             0, false));
-        constrained2.addConstraint(std::make_unique<ADConstraints::Mutex<3>>(
+        constrained2.addConstraint(ADConstraints::Mutex(
             [&mut]() {
                 return mut;
             },
@@ -330,7 +392,7 @@ SCENARIO("Mutex contraint", "[constraints]")
                     constrained1.update(now);
                     constrained2.update(now);
                 }
-                CHECK(now == 1104);
+                CHECK(now == 1103); // handed over at the deadline, without waiting for an update of actuator 2
             }
         }
     }
@@ -397,3 +459,165 @@ SCENARIO("Mutex contraint", "[constraints]")
         }
     }
 }
+
+SCENARIO("Constraints are stored inline and sorted by the order in which they are checked", "[constraints]")
+{
+    auto mockIo = std::make_shared<MockIoArray>();
+    ActuatorDigital mock([mockIo]() { return mockIo; }, 1);
+    ActuatorDigitalConstrained constrained(mock);
+    auto mut = std::make_shared<MutexTarget>();
+
+    constrained.addConstraint(ADConstraints::Mutex(
+        [&mut]() {
+            return mut;
+        },
+        300, true));
+    constrained.addConstraint(ADConstraints::DelayedOn(100));
+    constrained.addConstraint(ADConstraints::MinOnTime(2000));
+    constrained.addConstraint(ADConstraints::MinOffTime(1000));
+
+    using Kind = ADConstraints::Constraint::Kind;
+    std::vector<Kind> kinds;
+    for (auto& c : constrained.constraintsList()) {
+        kinds.push_back(c.kind());
+    }
+    CHECK(kinds == std::vector<Kind>{Kind::MIN_OFF, Kind::MIN_ON, Kind::DELAYED_ON, Kind::MUTEX});
+
+    WHEN("The set is full, more constraints are ignored")
+    {
+        for (uint8_t i = 0; i < 10; i++) {
+            constrained.addConstraint(ADConstraints::DelayedOff(100));
+        }
+        CHECK(constrained.constraintsList().size() == 8);
+    }
+
+    WHEN("The removed constraints are returned, they keep their settings")
+    {
+        auto removed = constrained.removeAllConstraints();
+        CHECK(constrained.constraintsList().empty());
+        REQUIRE(removed.size() == 4);
+        CHECK(removed.begin()->minOff()->limit() == 1000);
+    }
+
+    WHEN("The actuator is updated, the next update is when a constraint can change something")
+    {
+        ticks_millis_t now = 1000;
+        CHECK(constrained.update(now) == now + 1000); // stable, update once per second
+
+        constrained.desiredState(State::Active, now);
+        CHECK(constrained.update(now) == now + 100); // delayed on
+
+        now += 100;
+        CHECK(constrained.update(now) == now + 1000);
+        CHECK(constrained.state() == State::Active);
+
+        now += 2000;
+        constrained.desiredState(State::Inactive, now);
+        CHECK(constrained.state() == State::Inactive);
+        CHECK(constrained.update(now) == now + 1000); // the mutex releases itself when the hold time has passed
+        CHECK(mut->timeRemaining() == 300);
+
+        now += 300;
+        mut->update(now);
+        CHECK(mut->timeRemaining() == 0);
+    }
+}
+
+SCENARIO("Actuators waiting for a mutex get it in the order in which they asked", "[constraints]")
+{
+    auto now = ticks_millis_t(0);
+    auto mockIo = std::make_shared<MockIoArray>();
+    auto mut = std::make_shared<MutexTarget>();
+    ActuatorDigital mock1([mockIo]() { return mockIo; }, 1);
+    ActuatorDigital mock2([mockIo]() { return mockIo; }, 2);
+    ActuatorDigital mock3([mockIo]() { return mockIo; }, 3);
+    ActuatorDigitalConstrained constrained1(mock1);
+    ActuatorDigitalConstrained constrained2(mock2);
+    ActuatorDigitalConstrained constrained3(mock3);
+
+    for (auto act : {&constrained1, &constrained2, &constrained3}) {
+        act->addConstraint(ADConstraints::Mutex(
+            [&mut]() {
+                return mut;
+            },
+            100, true));
+    }
+
+    auto waitTime = [](const ActuatorDigitalConstrained& act) {
+        return act.constraintsList().begin()->timeRemaining();
+    };
+
+    auto waited = [](const ActuatorDigitalConstrained& act) {
+        return act.constraintsList().begin()->mutex()->waited();
+    };
+
+    constrained1.desiredState(State::Active, ++now);
+    constrained2.desiredState(State::Active, ++now);
+    constrained3.desiredState(State::Active, ++now);
+    CHECK(constrained1.state() == State::Active);
+    CHECK(constrained2.state() == State::Inactive);
+    CHECK(constrained3.state() == State::Inactive);
+    CHECK(mut->waitingCount() == 2);
+    CHECK(waitTime(constrained1) == 0);
+    CHECK(waitTime(constrained3) == 101);
+
+    THEN("The time that each actuator has been waiting is reported")
+    {
+        now += 10;
+        constrained2.update(now);
+        constrained3.update(now);
+        mut->update(now);
+        CHECK(waited(constrained1) == 0);
+        CHECK(waited(constrained2) == 11);
+        CHECK(waited(constrained3) == 10);
+        CHECK(mut->longestWait() == 11);
+    }
+
+    THEN("The actuator that asked first gets the mutex, even when the other one is updated first")
+    {
+        constrained1.desiredState(State::Inactive, ++now);
+        auto releasedAt = now;
+
+        while (constrained2.state() != State::Active && now < 1000) {
+            ++now;
+            constrained3.update(now);
+            constrained2.update(now);
+            constrained1.update(now);
+        }
+        CHECK(now == releasedAt + 100);
+        CHECK(constrained3.state() == State::Inactive);
+        CHECK(waitTime(constrained3) > 0);
+        CHECK(mut->waitingCount() == 1);
+
+        AND_THEN("The last actuator gets it next")
+        {
+            constrained2.desiredState(State::Inactive, ++now);
+            releasedAt = now;
+            constrained1.desiredState(State::Active, ++now);
+
+            while (constrained3.state() != State::Active && now < 1000) {
+                ++now;
+                constrained1.update(now);
+                constrained2.update(now);
+                constrained3.update(now);
+            }
+            CHECK(now == releasedAt + 100);
+            CHECK(constrained1.state() == State::Inactive);
+            CHECK(constrained2.state() == State::Inactive);
+        }
+    }
+
+    THEN("An actuator that no longer wants to turn on gives up its place in the queue")
+    {
+        constrained2.desiredState(State::Inactive, ++now);
+        CHECK(mut->waitingCount() == 1);
+
+        constrained1.desiredState(State::Inactive, ++now);
+        auto releasedAt = now;
+        while (constrained3.state() != State::Active && now < 1000) {
+            ++now;
+            constrained3.update(now);
+        }
+        CHECK(now == releasedAt + 100);
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+
+#include "../inc/AdaptiveInterval.h"
+
+SCENARIO("AdaptiveInterval test")
+{
+    AdaptiveInterval interval(1000, 8000);
+    bool doUpdate = false;
+
+    WHEN("The value is stable, the interval grows to the maximum")
+    {
+        interval.sample(temp_t{20.0}, true);
+        CHECK(interval.interval() == 1000); // first valid sample
+        interval.sample(temp_t{20.0}, true);
+        CHECK(interval.interval() == 1500);
+        for (uint8_t i = 0; i < 10; i++) {
+            interval.sample(temp_t{20.0625}, true);
+        }
+        CHECK(interval.interval() == 8000);
+
+        AND_WHEN("The value changes more than the tolerance, the interval is halved")
+        {
+            interval.sample(temp_t{20.3125}, true);
+            CHECK(interval.interval() == 4000);
+        }
+
+        AND_WHEN("A step is detected, the minimum interval is used immediately")
+        {
+            interval.sample(temp_t{19.0}, true);
+            CHECK(interval.interval() == 1000);
+        }
+
+        AND_WHEN("The value is invalid, the minimum interval is used")
+        {
+            interval.sample(temp_t{0}, false);
+            CHECK(interval.interval() == 1000);
+        }
+
+        AND_WHEN("The limits are changed, the interval stays within them")
+        {
+            interval.limits(500, 2000);
+            CHECK(interval.interval() == 2000);
+            interval.limits(3000, 0);
+            CHECK(interval.maxInterval() == 3000);
+            CHECK(interval.interval() == 3000);
+        }
+    }
+
+    WHEN("It is triggered every second, it updates at the first trigger after the interval")
+    {
+        for (uint8_t i = 0; i < 10; i++) {
+            interval.sample(temp_t{20.0}, true);
+        }
+        REQUIRE(interval.interval() == 8000);
+
+        int numUpdates = 0;
+        for (ticks_millis_t now = 0; now < 100000; now += 10) {
+            if (now % 1000 == 0) {
+                interval.trigger();
+            }
+            doUpdate = false;
+            interval.update(now, doUpdate);
+            if (doUpdate) {
+                numUpdates++;
+                CHECK(now % 1000 == 0);
+            }
+        }
+        CHECK(numUpdates == 13); // the first update is at time 0
+    }
+
+    WHEN("It is not triggered, it updates after the interval and a delay")
+    {
+        CHECK(interval.update(0, doUpdate) == 1500);
+        CHECK(doUpdate);
+        doUpdate = false;
+        CHECK(interval.update(1499, doUpdate) == 1500);
+        CHECK(!doUpdate);
+        CHECK(interval.update(1500, doUpdate) == 3000);
+        CHECK(doUpdate);
+    }
+
+    WHEN("The minimum and maximum are equal, it behaves like a TriggeredInterval")
+    {
+        AdaptiveInterval fixed;
+        for (uint8_t i = 0; i < 10; i++) {
+            fixed.sample(temp_t{20.0}, true);
+        }
+        CHECK(fixed.interval() == 500);
+        CHECK(fixed.update(0, doUpdate) == 1000);
+    }
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "../inc/OneWireMockDriver.h"
+#include "DS2408.h"
+#include "DS2408Mock.h"
+#include "MotorValve.h"
+
+namespace {
+// A valve on channels 1-4 of a mock DS2408, that moves while its motor is driven and pulls down its end switches
+struct SimulatedValve {
+    DS2408Mock& mock;
+    duration_millis_t travelTime;
+    duration_millis_t position;
+
+    void step(duration_millis_t elapsed)
+    {
+        // the opening and closing signals to the H-bridge are inverted by the latches
+        uint8_t latches = mock.latchWrites().empty() ? 0xFF : mock.latchWrites().back();
+        bool opening = (latches & 0x04) && !(latches & 0x08);
+        bool closing = !(latches & 0x04) && (latches & 0x08);
+        if (opening) {
+            position = std::min(position + elapsed, travelTime);
+        } else if (closing) {
+            position = position > elapsed ? position - elapsed : 0;
+        }
+        mock.setExternalPullDown(0, position == 0);
+        mock.setExternalPullDown(1, position == travelTime);
+    }
+
+    uint32_t percent() const
+    {
+        return position * 100 / travelTime;
+    }
+};
+}
+
+SCENARIO("A motor valve estimates its position from the motor run time", "[motorvalve]")
+{
+    auto now = ticks_millis_t(0);
+    OneWireMockDriver mockOw;
+    OneWire ow(mockOw);
+    auto addr = OneWireAddress(0xDA55'5555'5555'5529);
+    auto ds2408mock = std::make_shared<DS2408Mock>(addr);
+    mockOw.attach(ds2408mock);
+    auto ds = std::make_shared<DS2408>(ow, addr);
+    MotorValve valve([ds]() { return ds; }, 1);
+    valve.travelTime(10000);
+    SimulatedValve sim{*ds2408mock, 10000, 4000};
+
+    // the DS2408 and the valve are updated like their blocks, the valve sooner when it asks for it
+    auto run = [&](duration_millis_t duration) {
+        auto end = now + duration;
+        auto nextDevice = now;
+        auto nextValve = now;
+        while (now < end) {
+            sim.step(100);
+            now += 100;
+            if (now >= nextDevice) {
+                ds->poll(now);
+                nextDevice = now + 1000;
+            }
+            if (now >= nextValve) {
+                nextValve = valve.update(now);
+            }
+        }
+    };
+
+    run(2000);
+    CHECK(!valve.positionKnown());
+
+    WHEN("The valve is opened, the estimate is calibrated by the open end switch")
+    {
+        valve.state(ActuatorDigitalBase::State::Active);
+        run(8000);
+        CHECK(valve.valveState() == MotorValve::ValveState::Open);
+        CHECK(valve.positionKnown());
+        CHECK(valve.position() == 100);
+
+        AND_WHEN("The valve is closed, the estimated position follows the valve")
+        {
+            valve.state(ActuatorDigitalBase::State::Inactive);
+            run(4000);
+            CHECK(valve.valveState() == MotorValve::ValveState::Closing);
+            CHECK(valve.position() == Approx(sim.percent()).margin(10));
+            run(8000);
+            CHECK(valve.valveState() == MotorValve::ValveState::Closed);
+            CHECK(valve.position() == 0);
+        }
+    }
+
+    WHEN("An intermediate position is requested while the position is unknown")
+    {
+        valve.position(30);
+        run(6000);
+
+        THEN("The valve is closed first to find the position")
+        {
+            CHECK(valve.positionKnown());
+            CHECK(sim.position < 10000);
+        }
+
+        run(6000);
+
+        THEN("It stops at the requested position")
+        {
+            CHECK(valve.valveState() == MotorValve::ValveState::HalfOpenIdle);
+            CHECK(sim.percent() == Approx(30).margin(3));
+            CHECK(valve.position() == Approx(30).margin(3));
+        }
+
+        AND_WHEN("Another intermediate position is requested, it moves there without closing first")
+        {
+            valve.position(70);
+            run(5000);
+            CHECK(valve.valveState() == MotorValve::ValveState::HalfOpenIdle);
+            CHECK(sim.percent() == Approx(70).margin(3));
+
+            valve.position(60);
+            run(2000);
+            CHECK(valve.valveState() == MotorValve::ValveState::HalfOpenIdle);
+            CHECK(sim.percent() == Approx(60).margin(3));
+        }
+
+        AND_WHEN("A position within the tolerance is requested, the motor is not driven")
+        {
+            ds2408mock->clearLatchWrites();
+            valve.position(31);
+            run(2000);
+            CHECK(ds2408mock->latchWrites().empty());
+        }
+    }
+
+    WHEN("The valve is travelling, the end switches are not read until shortly before the predicted arrival")
+    {
+        valve.state(ActuatorDigitalBase::State::Inactive);
+        run(6000); // closed, position known
+        REQUIRE(valve.valveState() == MotorValve::ValveState::Closed);
+
+        auto busTimeBefore = mockOw.busTime();
+        ds->update();
+        auto readTime = mockOw.busTime() - busTimeBefore;
+
+        valve.state(ActuatorDigitalBase::State::Active);
+        run(1000);
+        CHECK(!ds->pollDue(now));
+
+        busTimeBefore = mockOw.busTime();
+        run(11000);
+        auto travelBusTime = mockOw.busTime() - busTimeBefore;
+
+        CHECK(valve.valveState() == MotorValve::ValveState::Open);
+        CHECK(travelBusTime < 8 * readTime); // instead of a read every second
+        CHECK(ds->pollDue(now));
+    }
+}
+
+SCENARIO("A motor valve measures its travel time when it is not configured", "[motorvalve]")
+{
+    auto now = ticks_millis_t(0);
+    OneWireMockDriver mockOw;
+    OneWire ow(mockOw);
+    auto addr = OneWireAddress(0xDA55'5555'5555'5529);
+    auto ds2408mock = std::make_shared<DS2408Mock>(addr);
+    mockOw.attach(ds2408mock);
+    auto ds = std::make_shared<DS2408>(ow, addr);
+    MotorValve valve([ds]() { return ds; }, 1);
+    SimulatedValve sim{*ds2408mock, 8000, 4000};
+
+    auto run = [&](duration_millis_t duration) {
+        auto end = now + duration;
+        auto nextDevice = now;
+        auto nextValve = now;
+        while (now < end) {
+            sim.step(100);
+            now += 100;
+            if (now >= nextDevice) {
+                ds->poll(now);
+                nextDevice = now + 1000;
+            }
+            if (now >= nextValve) {
+                nextValve = valve.update(now);
+            }
+        }
+    };
+
+    CHECK(valve.travelTime() == 0);
+
+    WHEN("The valve opens from closed to open, the travel time is measured")
+    {
+        valve.state(ActuatorDigitalBase::State::Inactive);
+        run(6000);
+        REQUIRE(valve.valveState() == MotorValve::ValveState::Closed);
+        valve.state(ActuatorDigitalBase::State::Active);
+        run(12000);
+        CHECK(valve.valveState() == MotorValve::ValveState::Open);
+        CHECK(valve.measuredTravelTime() == Approx(8000).margin(2000));
+        CHECK(valve.travelTime() == valve.measuredTravelTime());
+    }
+
+    WHEN("The valve is opened from an unknown position, nothing is measured")
+    {
+        valve.state(ActuatorDigitalBase::State::Active);
+        run(6000);
+        REQUIRE(valve.valveState() == MotorValve::ValveState::Open);
+        CHECK(valve.travelTime() == 0);
+        CHECK(valve.position() == 100);
+    }
+
+    WHEN("An intermediate position is requested, the valve first closes and opens to measure the travel time")
+    {
+        valve.position(50);
+        run(30000);
+        CHECK(valve.travelTime() > 0);
+        CHECK(valve.valveState() == MotorValve::ValveState::HalfOpenIdle);
+        CHECK(sim.percent() == Approx(50).margin(15));
+    }
+
+    WHEN("A travel time is configured, it is used instead of the measured time")
+    {
+        valve.travelTime(10000);
+        valve.state(ActuatorDigitalBase::State::Inactive);
+        run(6000);
+        valve.state(ActuatorDigitalBase::State::Active);
+        run(12000);
+        CHECK(valve.measuredTravelTime() > 0);
+        CHECK(valve.travelTime() == 10000);
+    }
+}
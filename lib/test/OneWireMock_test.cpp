@@ -28,6 +28,9 @@
 #include "DS2413.h"
 #include "DS2413Mock.h"
 #include "MotorValve.h"
+#include "OneWireMockPopulation.h"
+#include "OneWireScheduler.h"
+#include <sstream>
 
 namespace Catch {
 template <>
@@ -46,6 +49,14 @@ makeValidAddress(OneWireAddress addr)
     return addr;
 }
 
+// every call advances the clock by 100us
+static ticks_micros_t fakeMicros = 0;
+ticks_micros_t
+fakeClock()
+{
+    return fakeMicros += 100;
+}
+
 SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
 {
     OneWireMockDriver owMock;
@@ -108,6 +119,23 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
             CHECK(addr == addr1);
         }
 
+        THEN("A block read computes the CRC while the bytes arrive")
+        {
+            OneWireAddress addr(0);
+            uint8_t crc = 0xFF;
+            ow.reset();
+            ow.write(0x33);
+            CHECK(ow.read_bytes(&addr[0], 8, crc));
+            CHECK(addr == addr1);
+            CHECK(crc == 0); // the CRC over the address including its CRC byte is 0
+
+            uint8_t partialCrc = 0;
+            for (uint8_t i = 0; i < 7; i++) {
+                partialCrc = OneWireCrc8Update(addr[i], partialCrc);
+            }
+            CHECK(partialCrc == OneWireCrc8(&addr[0], 7));
+        }
+
         THEN("With a single device on the bus, a skip ROM command can select it without knowing the address")
         {
             OneWireAddress addr(0);
@@ -124,9 +152,12 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
             DS18B20 sensor(ow, addr1);
             sensor.update();
             CHECK(sensor.valid() == false); // a reset will be detected, triggering a re-init
+            CHECK(sensor.stats().resetDetections == 1);
+            CHECK(ow.stats().resetDetections == 1);
             sensor.update();
             CHECK(sensor.valid() == true);
             CHECK(sensor.value() == 20.0);
+            CHECK(sensor.stats().errors() == 1);
 
             mockSensor->setTemperature(temp_t{21.0});
             CHECK(mockSensor->getTemperature() == 21.0);
@@ -139,6 +170,142 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
             CHECK(sensor.value() == -10.0);
         }
 
+        THEN("A OneWire sensor can be read without blocking with the transaction queue")
+        {
+            DS18B20 sensor(ow, addr1);
+            owMock.setAsyncLatency(2); // each bus operation is busy for 2 polls
+
+            CHECK(sensor.updateAsync() == true);
+            CHECK(sensor.readPending() == true);
+            CHECK(sensor.updateAsync() == false); // already pending
+
+            // each call to process polls the driver once and returns when it is busy
+            // 21 operations: reset, match ROM + 8 address bytes, read scratchpad command, 9 bytes, reset
+            uint16_t calls = 0;
+            while (ow.transactions().process()) {
+                ++calls;
+            }
+            CHECK(calls == 2 * 21);
+            CHECK(owMock.busyPolls() == 2 * 21);
+            CHECK(sensor.readPending() == false);
+            CHECK(sensor.valid() == false); // a reset will be detected, re-init on next update
+
+            CHECK(sensor.updateAsync() == true);
+            ow.transactions().flush();
+            CHECK(sensor.valid() == true);
+            CHECK(sensor.value() == 20.0);
+
+            mockSensor->setTemperature(temp_t{21.0});
+            sensor.updateAsync();
+            ow.transactions().flush();
+            CHECK(sensor.value() == 21.0);
+
+            AND_WHEN("The bus master stays busy longer than a flush is allowed to wait")
+            {
+                owMock.setAsyncLatency(255);
+                sensor.updateAsync();
+                THEN("The flush and blocking operations give up instead of waiting forever")
+                {
+                    CHECK(ow.transactions().flush() == false);
+                    CHECK(ow.transactions().busy());
+                    CHECK(ow.reset() == false);
+
+                    owMock.setAsyncLatency(0);
+                    CHECK(ow.transactions().flush() == true);
+                    CHECK(ow.reset() == true);
+                }
+            }
+
+            AND_WHEN("A blocking operation is used while transactions are queued")
+            {
+                DS18B20 sensor2(ow, addr1);
+                sensor.updateAsync();
+                sensor2.updateAsync();
+                CHECK(ow.transactions().expectedCompletion(&sensor) == 2 * 960 + 19 * 560);
+                CHECK(ow.transactions().expectedCompletion(&sensor2) == 2 * (2 * 960 + 19 * 560));
+                CHECK(sensor.readExpected() == 2 * 960 + 19 * 560);
+
+                for (uint8_t i = 0; i < 6; i++) {
+                    ow.transactions().process(1); // the read of the first sensor is in progress
+                }
+                CHECK(ow.transactions().expectedCompletion(&sensor) < 2 * 960 + 19 * 560);
+
+                THEN("Only the transaction in progress is finished first, the rest of the queue waits")
+                {
+                    CHECK(ow.reset() == true);
+                    CHECK(sensor.readPending() == false);
+                    CHECK(sensor2.readPending() == true);
+                    CHECK(ow.transactions().busy());
+                    CHECK(ow.transactions().expectedCompletion(&sensor) == 0);
+
+                    ow.transactions().flush();
+                    CHECK(sensor2.readPending() == false);
+                }
+            }
+
+            AND_WHEN("The sensor is destroyed while a read is pending")
+            {
+                {
+                    DS18B20 sensor2(ow, addr1);
+                    sensor2.updateAsync();
+                    ow.transactions().process();
+                    CHECK(ow.transactions().busy());
+                }
+                THEN("The transaction is finished without calling back into the destroyed sensor")
+                {
+                    ow.transactions().flush();
+                    CHECK(ow.transactions().busy() == false);
+                }
+            }
+
+            AND_WHEN("The sensor is disconnected during an asynchronous read")
+            {
+                auto busErrors = ow.stats().presenceErrors;
+                sensor.updateAsync();
+                mockSensor->setConnected(false);
+                ow.transactions().flush();
+                THEN("It reads as invalid")
+                {
+                    CHECK(sensor.valid() == false);
+                    CHECK(sensor.value() == 0.0);
+                }
+                THEN("The missing presence pulses of the read and its retry are counted for the sensor and the bus")
+                {
+                    CHECK(sensor.stats().presenceErrors == 2);
+                    CHECK(ow.stats().presenceErrors - busErrors == 2);
+                }
+            }
+
+            AND_WHEN("A bitflip occurs during an asynchronous read")
+            {
+                mockSensor->flipReadBits({13});
+                sensor.updateAsync();
+                ow.transactions().flush();
+                THEN("The read is retried")
+                {
+                    CHECK(sensor.valid() == true);
+                    CHECK(sensor.value() == 21.0);
+                    CHECK(sensor.stats().crcErrors == 1);
+                    CHECK(sensor.stats().retries == 1);
+                }
+            }
+        }
+
+        THEN("A blocking bus operation doesn't wait for queued transactions that have not started")
+        {
+            DS18B20 sensor(ow, addr1);
+            owMock.setAsyncLatency(1);
+            sensor.update();
+            sensor.updateAsync();
+            CHECK(ow.transactions().busy());
+            sensor.update();
+            CHECK(ow.transactions().busy());
+            CHECK(sensor.valid() == true);
+            ow.transactions().flush();
+            CHECK(ow.transactions().busy() == false);
+            CHECK(sensor.valid() == true);
+        }
+
         WHEN("The sensor is disconnected")
         {
             DS18B20 sensor(ow, addr1);
@@ -151,6 +318,13 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
                 CHECK(sensor.valid() == false);
             }
 
+            THEN("The missing presence pulses are counted for the sensor and the bus")
+            {
+                CHECK(sensor.stats().presenceErrors == 4); // 2 reads with a retry
+                CHECK(ow.stats().presenceErrors == 4); // counted once, by the device that did not respond
+                CHECK(sensor.stats().crcErrors == 0);
+            }
+
             THEN("When it comes back, the first value is invalid and the second is valid (reset detection)")
             {
                 mockSensor->setConnected(true);
@@ -175,6 +349,9 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
                 sensor.update();
                 CHECK(sensor.valid() == true);
                 CHECK(sensor.value() == 21.0);
+                CHECK(sensor.stats().crcErrors == 1);
+                CHECK(sensor.stats().retries == 1);
+                CHECK(ow.stats().crcErrors == 1);
             }
 
             THEN("A bitflip in 2 scratchpads will give an error")
@@ -230,6 +407,29 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
             sensor2.update();
             CHECK(sensor1.value() == 21.0);
             CHECK(sensor2.value() == 22.0);
+
+            THEN("The conversions requested by both sensors are started with a single skip ROM command")
+            {
+                auto before1 = mockSensor->conversionCount();
+                auto before2 = mockSensor2->conversionCount();
+
+                CHECK(ow.startRequestedConversions() == true);
+                CHECK(mockSensor->conversionCount() == before1 + 1);
+                CHECK(mockSensor2->conversionCount() == before2 + 1);
+
+                // no new requests, no new conversion
+                CHECK(ow.startRequestedConversions() == false);
+                CHECK(mockSensor->conversionCount() == before1 + 1);
+
+                // reading the sensors doesn't start a conversion per sensor
+                sensor1.update();
+                sensor2.update();
+                CHECK(mockSensor->conversionCount() == before1 + 1);
+                CHECK(mockSensor2->conversionCount() == before2 + 1);
+                CHECK(ow.startRequestedConversions() == true);
+                CHECK(mockSensor->conversionCount() == before1 + 2);
+                CHECK(mockSensor2->conversionCount() == before2 + 2);
+            }
         }
     }
 
@@ -368,6 +568,45 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
             }
         }
 
+        THEN("Channel writes in a batch are merged into one write per device")
+        {
+            DS2408 ds1(ow, addr4);
+            ds1.update();
+            ds2408mock->clearLatchWrites();
+            {
+                IoArray::Batch batch;
+                CHECK(ds1.writeChannelConfig(1, IoArray::ChannelConfig::ACTIVE_HIGH));
+                CHECK(ds1.writeChannelConfig(2, IoArray::ChannelConfig::ACTIVE_HIGH));
+                CHECK(ds1.writeChannelConfig(3, IoArray::ChannelConfig::ACTIVE_HIGH));
+                CHECK(ds2408mock->latchWrites().empty());
+            }
+            CHECK(ds2408mock->latchWrites() == std::vector<uint8_t>{0xF8});
+
+            ActuatorDigitalBase::State result;
+            CHECK(ds1.senseChannel(3, result));
+            CHECK(result == ActuatorDigitalBase::State::Active);
+
+            AND_WHEN("Latches are enabled and released in the same batch")
+            {
+                ds2408mock->clearLatchWrites();
+                {
+                    IoArray::Batch batch;
+                    CHECK(ds1.writeChannelConfig(4, IoArray::ChannelConfig::ACTIVE_HIGH));
+                    CHECK(ds1.writeChannelConfig(1, IoArray::ChannelConfig::ACTIVE_LOW));
+                    {
+                        IoArray::Batch nested;
+                        CHECK(ds1.writeChannelConfig(2, IoArray::ChannelConfig::ACTIVE_LOW));
+                    }
+                    CHECK(ds2408mock->latchWrites().empty()); // the outermost batch commits
+                }
+
+                THEN("The latches are released before the new latches are enabled")
+                {
+                    CHECK(ds2408mock->latchWrites() == std::vector<uint8_t>{0xFB, 0xF3});
+                }
+            }
+        }
+
         THEN("A DS2408 class can use it as input on some pins and output on others")
         {
             DS2408 ds1(ow, addr4);
@@ -513,3 +752,470 @@ SCENARIO("A mocked OneWire bus and mocked slaves", "[onewire]")
         }
     }
 }
+
+SCENARIO("OneWire statistics record the latency of reads", "[onewire]")
+{
+    OneWireMockDriver owMock;
+    OneWire ow(owMock, fakeClock);
+    auto addr = makeValidAddress(0x0011223344556628);
+    owMock.attach(std::make_shared<DS18B20Mock>(addr));
+    DS18B20 sensor(ow, addr);
+    sensor.update(); // handles reset detection
+    auto samples = sensor.stats().latency.size();
+
+    WHEN("The sensor is read with blocking operations")
+    {
+        sensor.update();
+        THEN("The latency is recorded for the sensor and the bus")
+        {
+            CHECK(sensor.stats().latency.size() == samples + 1);
+            CHECK(sensor.stats().latency.max() == 100);
+            CHECK(ow.stats().latency.max() == 100);
+        }
+    }
+
+    WHEN("The sensor is read with the transaction queue")
+    {
+        sensor.updateAsync();
+        ow.transactions().flush();
+        THEN("The latency of the transaction is recorded for the sensor and the bus")
+        {
+            CHECK(sensor.valid() == true);
+            CHECK(sensor.stats().latency.size() == samples + 1);
+            CHECK(sensor.stats().latency.percentile(50) == 100);
+            CHECK(ow.stats().latency.size() == samples + 1);
+        }
+    }
+}
+
+SCENARIO("A latency window keeps the most recent samples", "[onewire]")
+{
+    LatencyWindow<4> window;
+    CHECK(window.percentile(50) == 0);
+    CHECK(window.max() == 0);
+
+    for (duration_micros_t sample : {500, 100, 400, 200, 300}) {
+        window.add(sample);
+    }
+
+    CHECK(window.size() == 4); // 500 is replaced by 300
+    CHECK(window.max() == 400);
+    CHECK(window.percentile(0) == 100);
+    CHECK(window.percentile(50) == 300);
+    CHECK(window.percentile(100) == 400);
+}
+
+SCENARIO("The mock OneWire bus models timing and faults", "[onewire]")
+{
+    OneWireMockDriver owMock;
+    OneWire ow(owMock);
+
+    WHEN("A device population is loaded from a description")
+    {
+        std::istringstream description(
+            "# type address options\n"
+            "DS18B20 28111111111111 temp=21.5 conversion=750000\n"
+            "\n"
+            "DS18B20 28222222222222 disconnected\n"
+            "DS2408 29333333333333\n"
+            "DS2413 3A444444444444\n"
+            "DS9999 01555555555555\n"
+            "DS18B20 2866\n");
+
+        CHECK(loadMockPopulation(owMock, description) == 4);
+        REQUIRE(owMock.attached().size() == 4);
+
+        THEN("The CRC of the addresses is added")
+        {
+            for (auto& device : owMock.attached()) {
+                CHECK(device->getAddress().valid());
+            }
+            CHECK(owMock.attached()[0]->getAddress().toString().substr(0, 14) == "28111111111111");
+        }
+
+        THEN("The options are applied")
+        {
+            auto sensor = std::static_pointer_cast<DS18B20Mock>(owMock.attached()[0]);
+            CHECK(sensor->isConnected() == true);
+            CHECK(owMock.attached()[1]->isConnected() == false);
+
+            // the temperature is measured by the next conversion
+            sensor->setTime(0);
+            sensor->reset();
+            sensor->write(0xCC);
+            sensor->write(0x44);
+            sensor->read();
+            CHECK(sensor->isConverting());
+            sensor->setTime(750000);
+            CHECK(sensor->getTemperature() == temp_t(21.5));
+        }
+    }
+
+    WHEN("Bus operations are executed")
+    {
+        auto addr = makeValidAddress(0x0011223344556628);
+        owMock.attach(std::make_shared<DS18B20Mock>(addr));
+        DS18B20 sensor(ow, addr);
+
+        ow.reset();
+        CHECK(owMock.busTime() == 960);
+        uint8_t b;
+        ow.write(0xCC);
+        ow.read(b);
+        CHECK(owMock.busTime() == 960 + 2 * 8 * 70);
+
+        THEN("The timing can be configured")
+        {
+            owMock.setTiming({1000, 100});
+            ow.reset();
+            CHECK(owMock.busTime() == 960 + 2 * 8 * 70 + 1000);
+        }
+    }
+
+    WHEN("The mock uses a clock")
+    {
+        auto addr = makeValidAddress(0x0011223344556628);
+        auto mockSensor = std::make_shared<DS18B20Mock>(addr);
+        owMock.attach(mockSensor);
+        DS18B20 sensor(ow, addr);
+        sensor.update(); // handles reset detection
+        sensor.update();
+        mockSensor->setConversionTime(750000);
+        mockSensor->setTemperature(temp_t{25.0});
+
+        fakeMicros = 0;
+        owMock.setClock(fakeClock);
+
+        THEN("Blocking operations take their duration on the clock")
+        {
+            ow.reset();
+            CHECK(fakeMicros >= 960);
+        }
+
+        THEN("Asynchronous operations are busy until their duration has passed")
+        {
+            CHECK(owMock.start(OneWireLowLevelInterface::AsyncOp::RESET, 0));
+            uint8_t result = 0;
+            uint16_t polls = 0;
+            while (owMock.poll(result) == OneWireLowLevelInterface::AsyncStatus::BUSY) {
+                ++polls;
+            }
+            CHECK(polls >= 8);
+            CHECK(result == 1);
+        }
+
+        THEN("A sensor only reads the new temperature when the conversion has completed")
+        {
+            ow.requestConversion();
+            ow.startRequestedConversions();
+            ow.transactions().flush();
+            CHECK(mockSensor->isConverting());
+            sensor.update();
+            CHECK(sensor.value() == temp_t{20.0});
+
+            while (fakeMicros < 800000) {
+                fakeClock();
+            }
+            sensor.update();
+            CHECK(sensor.value() == temp_t{25.0});
+        }
+    }
+
+    WHEN("Read errors are injected")
+    {
+        auto addr = makeValidAddress(0x0011223344556628);
+        owMock.attach(std::make_shared<DS18B20Mock>(addr));
+        DS18B20 sensor(ow, addr);
+        sensor.update();
+        owMock.setReadErrorRate(20000, 42); // 2% of the bytes
+
+        for (uint8_t i = 0; i < 100; i++) {
+            sensor.update();
+        }
+
+        THEN("The sensor detects them with the CRC and retries")
+        {
+            CHECK(owMock.injectedErrors() > 0);
+            CHECK(sensor.stats().crcErrors > 0);
+            CHECK(sensor.stats().retries > 0);
+        }
+    }
+
+    WHEN("A device is reset by a power loss")
+    {
+        auto addr = makeValidAddress(0x0011223344556628);
+        auto mockSensor = std::make_shared<DS18B20Mock>(addr);
+        owMock.attach(mockSensor);
+        DS18B20 sensor(ow, addr);
+        sensor.update();
+        sensor.update();
+        CHECK(sensor.valid());
+
+        mockSensor->powerOnReset();
+        sensor.update();
+
+        THEN("The sensor detects the reset and reconfigures the device")
+        {
+            CHECK(sensor.stats().resetDetections == 2);
+            CHECK(sensor.valid() == false);
+            sensor.update();
+            CHECK(sensor.valid() == true);
+        }
+    }
+}
+
+SCENARIO("Multiple OneWire buses are scheduled independently", "[onewire]")
+{
+    OneWireMockDriver driver1;
+    OneWireMockDriver driver2;
+    OneWire ow1(driver1);
+    OneWire ow2(driver2);
+    auto addr1 = makeValidAddress(0x1111'1111'1111'1128);
+    auto addr2 = makeValidAddress(0x2222'2222'2222'2228);
+    auto mock1 = std::make_shared<DS18B20Mock>(addr1);
+    auto mock2 = std::make_shared<DS18B20Mock>(addr2);
+    driver1.attach(mock1);
+    driver2.attach(mock2);
+    mock1->setTemperature(temp_t{21.0});
+    mock2->setTemperature(temp_t{22.0});
+
+    OneWireScheduler buses;
+    CHECK(buses.add(ow1) == 0);
+    CHECK(buses.add(ow2) == 1);
+    CHECK(buses.add(ow1) == 0); // adding a bus again returns its index
+    CHECK(buses.size() == 2);
+    CHECK(buses.bus(1) == &ow2);
+    CHECK(buses.bus(2) == nullptr);
+
+    DS18B20 sensor1(ow1, addr1);
+    DS18B20 sensor2(ow2, addr2);
+
+    WHEN("Both buses have pending reads and their masters are slow")
+    {
+        driver1.setAsyncLatency(2);
+        driver2.setAsyncLatency(2);
+        sensor1.updateAsync();
+        sensor2.updateAsync();
+
+        THEN("The buses advance together")
+        {
+            for (uint8_t i = 0; i < 10; i++) {
+                buses.process();
+            }
+            CHECK(ow1.transactions().completedSteps() > 0);
+            CHECK(ow1.transactions().completedSteps() == ow2.transactions().completedSteps());
+
+            while (buses.process()) {
+            }
+            CHECK(sensor1.readPending() == false);
+            CHECK(sensor2.readPending() == false);
+
+            // the first read detects the power-on reset and initializes the sensors
+            sensor1.updateAsync();
+            sensor2.updateAsync();
+            while (buses.process()) {
+            }
+            CHECK(sensor1.value() == 21.0);
+            CHECK(sensor2.value() == 22.0);
+        }
+    }
+
+    WHEN("A bus is stuck, the other bus still makes progress")
+    {
+        driver1.setAsyncLatency(250);
+        sensor1.updateAsync();
+        sensor2.updateAsync();
+        for (uint8_t i = 0; i < 10; i++) {
+            buses.process();
+        }
+        CHECK(sensor1.readPending() == true);
+        CHECK(sensor2.readPending() == false);
+    }
+
+    WHEN("A device is moved to another bus")
+    {
+        sensor1.update();
+        sensor1.update();
+        CHECK(sensor1.valid() == true);
+
+        // the sensor is connected to the other bus
+        mock1->setConnected(false);
+        auto moved = std::make_shared<DS18B20Mock>(addr1);
+        moved->setTemperature(temp_t{21.0});
+        driver2.attach(moved);
+        sensor1.updateAsync(); // pending on the old bus
+        sensor1.bus(ow2);
+
+        THEN("The pending read on the old bus is canceled and the sensor reads from the new bus")
+        {
+            CHECK(&sensor1.bus() == &ow2);
+            CHECK(sensor1.readPending() == false);
+            CHECK(ow1.transactions().busy() == false);
+
+            sensor1.update();
+            sensor1.update();
+            CHECK(sensor1.valid() == true);
+            CHECK(sensor1.value() == 21.0);
+        }
+    }
+}
+
+SCENARIO("DS18B20 sensors in alarm mode are only read when their temperature changes", "[onewire]")
+{
+    OneWireMockDriver driver;
+    OneWire ow(driver);
+    auto addr1 = makeValidAddress(0x1111'1111'1111'1128);
+    auto addr2 = makeValidAddress(0x2222'2222'2222'2228);
+    auto mock1 = std::make_shared<DS18B20Mock>(addr1);
+    auto mock2 = std::make_shared<DS18B20Mock>(addr2);
+    driver.attach(mock1);
+    driver.attach(mock2);
+
+    DS18B20 sensor1(ow, addr1);
+    DS18B20 sensor2(ow, addr2);
+    sensor1.alarmMode(true);
+    sensor2.alarmMode(true);
+
+    // a conversion, followed by the alarm search and an update of both sensors
+    auto cycle = [&]() {
+        ow.startRequestedConversions();
+        ow.transactions().flush();
+        ow.startRequestedAlarmSearch();
+        ow.transactions().flush();
+        sensor1.update();
+        sensor2.update();
+        ow.transactions().flush();
+    };
+
+    sensor1.update(); // the first read detects the reset and initializes the sensors
+    sensor2.update();
+    cycle();
+    CHECK(sensor1.valid());
+    CHECK(sensor2.valid());
+    CHECK(sensor1.value() == 20.0);
+
+    WHEN("The temperatures are stable")
+    {
+        auto reads1 = mock1->scratchpadReads();
+        auto reads2 = mock2->scratchpadReads();
+        cycle();
+        cycle();
+
+        THEN("The sensors are not read")
+        {
+            CHECK(ow.alarmSearchCount() == 3);
+            CHECK(mock1->scratchpadReads() == reads1);
+            CHECK(mock2->scratchpadReads() == reads2);
+            CHECK(sensor1.valid());
+            CHECK(sensor1.value() == 20.0);
+        }
+
+        THEN("A sensor is still read after a number of skipped conversions")
+        {
+            for (uint8_t i = 2; i < DS18B20::maxSkippedReads; i++) {
+                cycle();
+            }
+            CHECK(mock2->scratchpadReads() == reads2);
+            cycle();
+            CHECK(mock2->scratchpadReads() == reads2 + 1);
+        }
+    }
+
+    WHEN("The temperature of a sensor changes by a whole degree")
+    {
+        auto reads2 = mock2->scratchpadReads();
+        mock1->setTemperature(temp_t{21.5});
+        cycle();
+
+        THEN("Only that sensor is read")
+        {
+            CHECK(sensor1.value() == 21.5);
+            CHECK(mock2->scratchpadReads() == reads2);
+        }
+
+        THEN("The band follows the new value")
+        {
+            auto reads1 = mock1->scratchpadReads();
+            cycle();
+            CHECK(mock1->scratchpadReads() == reads1);
+        }
+    }
+
+    WHEN("The temperatures of both sensors change")
+    {
+        auto reads1 = mock1->scratchpadReads();
+        auto reads2 = mock2->scratchpadReads();
+        mock1->setTemperature(temp_t{23.0});
+        mock2->setTemperature(temp_t{18.0});
+        cycle();
+
+        THEN("The alarm search finds both and both are read")
+        {
+            CHECK(ow.alarmed(addr1));
+            CHECK(ow.alarmed(addr2));
+            CHECK(mock1->scratchpadReads() == reads1 + 1);
+            CHECK(mock2->scratchpadReads() == reads2 + 1);
+            CHECK(sensor1.value() == 23.0);
+            CHECK(sensor2.value() == 18.0);
+        }
+    }
+
+    WHEN("A sensor updates before the alarm search has completed")
+    {
+        auto reads1 = mock1->scratchpadReads();
+        mock1->setTemperature(temp_t{23.0});
+        ow.startRequestedConversions();
+        ow.transactions().flush();
+        CHECK(ow.startRequestedAlarmSearch());
+        CHECK(ow.alarmSearchPending());
+        sensor1.updateAsync();
+
+        THEN("It is not read until the search result exists")
+        {
+            CHECK(sensor1.readPending() == false);
+            ow.transactions().flush();
+            CHECK(ow.alarmSearchPending() == false);
+            CHECK(mock1->scratchpadReads() == reads1);
+            CHECK(sensor1.value() == 20.0);
+
+            CHECK(sensor1.updateAsync());
+            ow.transactions().flush();
+            CHECK(mock1->scratchpadReads() == reads1 + 1);
+            CHECK(sensor1.value() == 23.0);
+        }
+    }
+
+    WHEN("A sensor loses power")
+    {
+        mock2->powerOnReset();
+        cycle();
+
+        THEN("It raises an alarm, the reset is detected and the sensor is initialized again")
+        {
+            CHECK(sensor2.valid() == false);
+            cycle();
+            CHECK(sensor2.valid());
+            CHECK(sensor2.value() == 20.0);
+        }
+    }
+
+    WHEN("An alarm search runs during a discovery search")
+    {
+        OneWireAddress first;
+        OneWireAddress second;
+        ow.reset_search();
+        CHECK(ow.search(first));
+        mock1->setTemperature(temp_t{25.0});
+        ow.requestAlarmSearch();
+        CHECK(ow.startRequestedAlarmSearch());
+        ow.transactions().flush();
+        CHECK(ow.alarmed(addr1));
+        CHECK(!ow.alarmed(addr2));
+
+        THEN("The discovery continues where it was")
+        {
+            CHECK(ow.search(second));
+            CHECK(!(second == first));
+        }
+    }
+}
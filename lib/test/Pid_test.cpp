@@ -27,6 +27,7 @@
 #include "ActuatorPwm.h"
 #include "MockIoArray.h"
 #include "Pid.h"
+#include "PidCascade.h"
 #include "SetpointSensorPair.h"
 #include "TempSensorMock.h"
 #include <iostream>
@@ -122,6 +123,30 @@ SCENARIO("PID Test with mock actuator", "[pid]")
         CHECK(actuator->setting() == Approx(10.0 * (1.0 + 2000 * 1.0 / 2000)).epsilon(0.001));
     }
 
+    WHEN("The PID updates at a varying interval, the integral increase is scaled by the elapsed time")
+    {
+        pid.kp(10);
+        pid.ti(2000);
+        pid.td(0);
+
+        input->setting(21);
+        sensor->setting(20);
+        input->resetFilter();
+
+        for (int32_t i = 0; i < 500; ++i) {
+            input->update();
+            pid.update(1500);
+            input->update();
+            pid.update(500);
+        }
+
+        CHECK(pid.integral() == Approx(1000).epsilon(0.001));
+        CHECK(pid.i() == Approx(5).epsilon(0.001));
+
+        pid.update(0);
+        CHECK(pid.integral() == Approx(1000).epsilon(0.001));
+    }
+
     WHEN("Proportional, Integral and Derivative are enabled, the output value is correct with positive Kp")
     {
         pid.kp(10);
@@ -1095,4 +1120,101 @@ SCENARIO("PID Test with PWM actuator", "[pid]")
             CHECK(pid.i() < 1.0);
         }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("PID cascade with feed-forward", "[pid]")
+{
+    auto beerSensor = std::make_shared<TempSensorMock>(20.0);
+    auto beer = std::make_shared<SetpointSensorPair>([beerSensor]() { return beerSensor; });
+    beer->setting(20);
+    beer->settingValid(true);
+
+    auto fridgeSensor = std::make_shared<TempSensorMock>(20.0);
+    auto fridge = std::make_shared<SetpointSensorPair>([fridgeSensor]() { return fridgeSensor; });
+    fridge->setting(20);
+    fridge->settingValid(true);
+
+    auto ambientSensor = std::make_shared<TempSensorMock>(25.0);
+    auto ambient = std::make_shared<SetpointSensorPair>([ambientSensor]() { return ambientSensor; });
+
+    auto actuator = std::make_shared<ActuatorAnalogMock>();
+
+    PidCascade cascade(
+        [beer]() { return beer; },
+        [fridge]() { return fridge; },
+        [actuator]() { return actuator; },
+        [ambient]() { return ambient; });
+
+    cascade.enabled(true);
+    cascade.outer().kp(2);
+    cascade.outer().ti(0);
+    cascade.outer().td(0);
+    cascade.inner().kp(10);
+    cascade.inner().ti(0);
+    cascade.inner().td(0);
+
+    auto update = [&]() {
+        beer->update();
+        fridge->update();
+        ambient->update();
+        cascade.update();
+    };
+
+    for (int32_t i = 0; i < 100; ++i) {
+        update(); // settle input filters
+    }
+
+    WHEN("The outer setting changes, the inner setpoint and the actuator follow in the same update")
+    {
+        beer->setting(21);
+        cascade.update();
+
+        CHECK(cascade.outer().p() == Approx(2.0).margin(0.01));
+        CHECK(fridge->setting() == Approx(23.0).margin(0.01));
+        CHECK(cascade.inner().p() == Approx(30.0).margin(0.01));
+        CHECK(actuator->setting() == Approx(30.0).margin(0.01));
+        CHECK(cascade.active());
+    }
+
+    WHEN("Feed-forward is enabled, the inner setpoint is corrected for the ambient temperature")
+    {
+        cascade.feedForwardGain(0.5);
+        cascade.outer().ti(1000);
+        for (int32_t i = 0; i < 10; ++i) {
+            update();
+        }
+
+        CHECK(cascade.feedForward() == Approx(2.5).margin(0.01));
+        CHECK(cascade.innerOffset() == Approx(2.5).margin(0.01));
+        CHECK(fridge->setting() == Approx(22.5).margin(0.01));
+        CHECK(actuator->setting() == Approx(25.0).margin(0.01));
+
+        THEN("The outer PID doesn't see the feed-forward term, so its integrator doesn't wind up")
+        {
+            CHECK(cascade.outer().p() == Approx(0.0).margin(0.01));
+            CHECK(cascade.outer().integral() == Approx(0.0).margin(0.01));
+        }
+
+        AND_WHEN("The feed-forward input becomes invalid, the feed-forward term is zero")
+        {
+            ambientSensor->connected(false);
+            for (int32_t i = 0; i < 20; ++i) {
+                update();
+            }
+            CHECK(cascade.feedForward() == Approx(0.0).margin(0.01));
+            CHECK(fridge->setting() == Approx(20.0).margin(0.01));
+        }
+    }
+
+    WHEN("The outer input becomes invalid, the inner setpoint becomes invalid and both PIDs are inactive")
+    {
+        beerSensor->connected(false);
+        for (int32_t i = 0; i < 20; ++i) {
+            update();
+        }
+        CHECK(!cascade.outer().active());
+        CHECK(fridge->settingValid() == false);
+        CHECK(!cascade.inner().active());
+        CHECK(!cascade.active());
+    }
+}
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+
+#include "../inc/PwmScheduler.h"
+
+using ticks_t = PwmScheduler::ticks_t;
+
+namespace {
+// records the time an output was active, using the time of the simulated timer
+struct OutputLog {
+    const ticks_t& now;
+    bool active = false;
+    ticks_t since = 0;
+    ticks_t activeTicks = 0;
+    uint32_t toggles = 0;
+
+    explicit OutputLog(const ticks_t& now_)
+        : now(now_)
+    {
+    }
+
+    PwmScheduler::Output output()
+    {
+        return [this](bool v) {
+            if (active) {
+                activeTicks += now - since;
+            }
+            if (v != active) {
+                ++toggles;
+            }
+            active = v;
+            since = now;
+        };
+    }
+
+    void reset()
+    {
+        since = now;
+        activeTicks = 0;
+        toggles = 0;
+    }
+};
+
+// Simulates the timer compare interrupt: process() is only called at the edge times it returns.
+// Returns the number of interrupts.
+uint32_t
+runUntil(PwmScheduler& scheduler, ticks_t& now, ticks_t end)
+{
+    uint32_t interrupts = 0;
+    while (!scheduler.empty() && int32_t(end - scheduler.nextEdge()) > 0) {
+        now = scheduler.nextEdge();
+        scheduler.process(now);
+        ++interrupts;
+    }
+    now = end;
+    return interrupts;
+}
+}
+
+SCENARIO("PwmScheduler generates the edges of multiple channels from a single timer")
+{
+    ticks_t now = 0;
+    PwmScheduler scheduler;
+    OutputLog log1(now);
+    OutputLog log2(now);
+    OutputLog log3(now);
+
+    auto id1 = scheduler.add(log1.output(), 100, 25, now);
+    auto id2 = scheduler.add(log2.output(), 100, 50, now);
+    auto id3 = scheduler.add(log3.output(), 100, 0, now);
+    CHECK(scheduler.size() == 3);
+    CHECK(id1 != PwmScheduler::noChannel);
+    CHECK(id2 != id1);
+    CHECK(id3 != id2);
+
+    WHEN("The timer runs for 100 periods")
+    {
+        auto interrupts = runUntil(scheduler, now, 10000);
+
+        THEN("Each output is active for its active time in each period")
+        {
+            CHECK(log1.activeTicks == 2500);
+            CHECK(log2.activeTicks == 5000);
+            CHECK(log3.activeTicks == 0);
+            CHECK(log1.toggles == 200);
+            CHECK(log2.toggles == 200);
+            CHECK(log3.toggles == 0);
+        }
+
+        THEN("The timer only interrupts at the edges, not at every tick of every channel")
+        {
+            // period starts of the channels coincide, so they share an interrupt
+            CHECK(scheduler.edgeCount() == 500);
+            CHECK(interrupts == 300);
+        }
+    }
+
+    WHEN("The active time is changed, it takes effect at the start of the next period")
+    {
+        runUntil(scheduler, now, 10);
+        scheduler.set(id1, 100, 75);
+        runUntil(scheduler, now, 100);
+        CHECK(log1.activeTicks == 25);
+        CHECK(!log1.active);
+
+        log1.reset();
+        runUntil(scheduler, now, 1000);
+        CHECK(log1.activeTicks == 9 * 75);
+    }
+
+    WHEN("A channel is set to 100%, it stays active without toggling")
+    {
+        scheduler.set(id2, 100, 100);
+        runUntil(scheduler, now, 1000);
+        log2.reset();
+        runUntil(scheduler, now, 2000);
+        CHECK(log2.active);
+        CHECK(log2.toggles == 0);
+    }
+
+    WHEN("A channel is removed, its output is no longer changed")
+    {
+        runUntil(scheduler, now, 10);
+        scheduler.remove(id2);
+        CHECK(scheduler.size() == 2);
+        log2.reset();
+        runUntil(scheduler, now, 1000);
+        CHECK(log2.toggles == 0);
+        CHECK(log1.toggles == 20);
+
+        AND_WHEN("A new channel is added, it gets a new id")
+        {
+            OutputLog log4(now);
+            auto id4 = scheduler.add(log4.output(), 100, 10, now);
+            CHECK(id4 != id2);
+            runUntil(scheduler, now, 2000);
+            CHECK(log4.activeTicks == 100);
+
+            scheduler.set(id2, 100, 90); // removed id is ignored
+            runUntil(scheduler, now, 3000);
+            CHECK(log4.activeTicks == 200);
+        }
+    }
+
+    WHEN("All channels are used, no more channels can be added")
+    {
+        OutputLog extra(now);
+        while (scheduler.size() < PwmScheduler::maxChannels) {
+            CHECK(scheduler.add(extra.output(), 100, 10, now) != PwmScheduler::noChannel);
+        }
+        CHECK(scheduler.add(extra.output(), 100, 10, now) == PwmScheduler::noChannel);
+    }
+
+    WHEN("The interrupt is handled late, the edges are generated late but the periods don't drift")
+    {
+        runUntil(scheduler, now, 20);
+        now = 30; // turn off edge of channel 1 at 25 was missed
+        scheduler.process(now);
+        CHECK(!log1.active);
+        log1.reset();
+
+        runUntil(scheduler, now, 1030);
+        CHECK(log1.activeTicks == 250);
+    }
+
+    WHEN("The interrupt is handled more than a period late, the missed periods are skipped instead of generated in a burst")
+    {
+        runUntil(scheduler, now, 20);
+        auto edgesBefore = scheduler.edgeCount();
+        now = 520;
+        scheduler.process(now);
+        CHECK(scheduler.edgeCount() - edgesBefore < 10);
+        CHECK(scheduler.nextEdge() > now);
+    }
+}
+
+SCENARIO("PwmScheduler handles wrapping of the tick count")
+{
+    ticks_t now = 0xFFFFFF00;
+    PwmScheduler scheduler;
+    OutputLog log1(now);
+    OutputLog log2(now);
+
+    scheduler.add(log1.output(), 100, 30, now);
+    scheduler.add(log2.output(), 70, 7, now + 5);
+
+    runUntil(scheduler, now, 0xFFFFFF00 + 7000);
+    CHECK(now < 0x10000);
+    CHECK(log1.activeTicks == 70 * 30);
+    CHECK(log2.activeTicks == 100 * 7);
+}
@@ -213,6 +213,114 @@ SCENARIO("SetpointProfile test", "[SetpointProfile]")
         }
     }
 
+    WHEN("the time goes back after the profile has advanced, the profile is interpolated from the start again")
+    {
+        profile.startTime(10);
+        profile.addPoint(SetpointProfile::Point{utc_seconds_t(1), temp_t(10)});
+        profile.addPoint(SetpointProfile::Point{utc_seconds_t(11), temp_t(20)});
+        profile.addPoint(SetpointProfile::Point{utc_seconds_t(21), temp_t(0)});
+
+        profile.update(30);
+        CHECK(sspair->setting() == Approx(2).margin(0.001));
+
+        profile.update(16);
+        CHECK(sspair->setting() == Approx(15).margin(0.001));
+
+        AND_WHEN("the start time is moved back, the profile skips ahead")
+        {
+            profile.startTime(0);
+            profile.update(20);
+            CHECK(sspair->setting() == Approx(2).margin(0.001));
+        }
+    }
+
+    WHEN("a large profile is set, it is stored compactly and can be read back")
+    {
+        SetpointProfile::Points points;
+        for (uint16_t i = 0; i < 1000; i++) {
+            points.push_back(SetpointProfile::Point{utc_seconds_t(i * 3600), temp_t(20 + (i % 7) - 3.5)});
+        }
+        profile.points(std::move(points));
+
+        CHECK(profile.points().size() == 1000);
+        CHECK(profile.points().encodedSize() < 1000 * sizeof(SetpointProfile::Point));
+
+        uint16_t i = 0;
+        for (const auto& p : profile.points()) {
+            CHECK(p.time == utc_seconds_t(i * 3600));
+            CHECK(p.temp == temp_t(20 + (i % 7) - 3.5));
+            i++;
+        }
+        CHECK(i == 1000);
+
+        THEN("The setpoint is interpolated between points, going up and down")
+        {
+            profile.startTime(1000);
+            profile.update(1000 + 5 * 3600 + 1800);
+            CHECK(sspair->setting() == Approx(22).margin(0.001));
+            profile.update(1000 + 6 * 3600 + 1800);
+            CHECK(sspair->setting() == Approx(19.5).margin(0.001));
+            profile.update(1000 + 999 * 3600 + 1800);
+            CHECK(sspair->setting() == Approx(20 + (999 % 7) - 3.5).margin(0.001));
+        }
+    }
+
+    WHEN("a profile is uploaded in chunks")
+    {
+        auto makePoints = [](uint16_t first, uint16_t count) {
+            SetpointProfile::Points points;
+            for (uint16_t i = first; i < first + count; i++) {
+                points.push_back(SetpointProfile::Point{utc_seconds_t(i * 10), temp_t(i)});
+            }
+            return points;
+        };
+
+        auto times = [&profile]() {
+            std::vector<utc_seconds_t> result;
+            for (const auto& p : profile.points()) {
+                result.push_back(p.time);
+            }
+            return result;
+        };
+
+        profile.points(makePoints(0, 5));
+        profile.appendPoints(makePoints(5, 3));
+        CHECK(times() == std::vector<utc_seconds_t>{0, 10, 20, 30, 40, 50, 60, 70});
+
+        THEN("a range of points can be replaced")
+        {
+            SetpointProfile::Points replacement;
+            replacement.push_back(SetpointProfile::Point{utc_seconds_t(25), temp_t(-1)});
+            replacement.push_back(SetpointProfile::Point{utc_seconds_t(35), temp_t(-2)});
+            CHECK(profile.replacePoints(2, replacement));
+            CHECK(times() == std::vector<utc_seconds_t>{0, 10, 25, 35, 40, 50, 60, 70});
+
+            profile.startTime(1000);
+            profile.update(1030);
+            CHECK(sspair->setting() == Approx(-1.5).margin(0.001));
+        }
+
+        THEN("replacing points at the end extends the profile")
+        {
+            CHECK(profile.replacePoints(7, makePoints(8, 2)));
+            CHECK(times() == std::vector<utc_seconds_t>{0, 10, 20, 30, 40, 50, 60, 80, 90});
+        }
+
+        THEN("replacing points that would leave a gap is refused")
+        {
+            CHECK_FALSE(profile.replacePoints(9, makePoints(9, 1)));
+            CHECK(profile.points().size() == 8);
+        }
+
+        THEN("the profile can be truncated and extended again")
+        {
+            profile.truncatePoints(3);
+            CHECK(times() == std::vector<utc_seconds_t>{0, 10, 20});
+            profile.appendPoints(makePoints(4, 1));
+            CHECK(times() == std::vector<utc_seconds_t>{0, 10, 20, 40});
+        }
+    }
+
     WHEN("The utc time is still at 0, the setpoint is unchanged, but the profile still reports to be driving")
     {
         profile.startTime(10);
@@ -30,17 +30,17 @@ SCENARIO("TempSensorCombiTest", "[TempSensorCombi]")
 
         THEN("It reads as invalid and zero")
         {
-            combined.update();
+            combined.update(0);
             combined.func = TempSensorCombi::CombineFunc::AVG;
             CHECK(combined.valid() == false);
             CHECK(combined.value() == temp_t(0));
 
-            combined.update();
+            combined.update(0);
             combined.func = TempSensorCombi::CombineFunc::MIN;
             CHECK(combined.valid() == false);
             CHECK(combined.value() == temp_t(0));
 
-            combined.update();
+            combined.update(0);
             combined.func = TempSensorCombi::CombineFunc::MAX;
             CHECK(combined.valid() == false);
             CHECK(combined.value() == temp_t(0));
@@ -55,17 +55,17 @@ SCENARIO("TempSensorCombiTest", "[TempSensorCombi]")
         auto mock3 = std::make_shared<TempSensorMock>(26);
         auto mock4 = std::make_shared<TempSensorMock>(22);
         combined.inputs = {
-            [mock1]() { return mock1; },
-            [mock2]() { return mock2; },
-            [mock3]() { return mock3; },
-            [mock4]() { return mock4; },
+            {[mock1]() { return mock1; }},
+            {[mock2]() { return mock2; }},
+            {[mock3]() { return mock3; }},
+            {[mock4]() { return mock4; }},
 
         };
 
         THEN("The average is returned when AVG is selected")
         {
             combined.func = TempSensorCombi::CombineFunc::AVG;
-            combined.update();
+            combined.update(0);
             CHECK(combined.valid() == true);
             CHECK(combined.value() == temp_t(21.5));
         }
@@ -73,7 +73,7 @@ SCENARIO("TempSensorCombiTest", "[TempSensorCombi]")
         THEN("The lowest value is returned when MIN selected")
         {
             combined.func = TempSensorCombi::CombineFunc::MIN;
-            combined.update();
+            combined.update(0);
             CHECK(combined.valid() == true);
             CHECK(combined.value() == temp_t(18));
         }
@@ -81,7 +81,7 @@ SCENARIO("TempSensorCombiTest", "[TempSensorCombi]")
         THEN("The highest value is returned when MAX is selected")
         {
             combined.func = TempSensorCombi::CombineFunc::MAX;
-            combined.update();
+            combined.update(0);
             CHECK(combined.valid() == true);
             CHECK(combined.value() == temp_t(26));
         }
@@ -94,7 +94,7 @@ SCENARIO("TempSensorCombiTest", "[TempSensorCombi]")
             THEN("The average is returned when AVG is selected")
             {
                 combined.func = TempSensorCombi::CombineFunc::AVG;
-                combined.update();
+                combined.update(0);
                 CHECK(combined.valid() == true);
                 CHECK(combined.value() == temp_t(21));
             }
@@ -102,7 +102,7 @@ SCENARIO("TempSensorCombiTest", "[TempSensorCombi]")
             THEN("The lowest value is returned when MIN selected")
             {
                 combined.func = TempSensorCombi::CombineFunc::MIN;
-                combined.update();
+                combined.update(0);
                 CHECK(combined.valid() == true);
                 CHECK(combined.value() == temp_t(20));
             }
@@ -110,10 +110,72 @@ SCENARIO("TempSensorCombiTest", "[TempSensorCombi]")
             THEN("The highest value is returned when MAX is selected")
             {
                 combined.func = TempSensorCombi::CombineFunc::MAX;
-                combined.update();
+                combined.update(0);
                 CHECK(combined.valid() == true);
                 CHECK(combined.value() == temp_t(22));
             }
         }
     }
-}
\ No newline at end of file
+    WHEN("5 sensors are added with different weights")
+    {
+        TempSensorCombi combined;
+        auto mock1 = std::make_shared<TempSensorMock>(20);
+        auto mock2 = std::make_shared<TempSensorMock>(21);
+        auto mock3 = std::make_shared<TempSensorMock>(22);
+        auto mock4 = std::make_shared<TempSensorMock>(23);
+        auto mock5 = std::make_shared<TempSensorMock>(60);
+        combined.inputs = {
+            {[mock1]() { return mock1; }, 2},
+            {[mock2]() { return mock2; }, 0},
+            {[mock3]() { return mock3; }, 1},
+            {[mock4]() { return mock4; }, 1},
+            {[mock5]() { return mock5; }, 1},
+        };
+
+        THEN("The weighted average is returned when AVG is selected, inputs with weight 0 are ignored")
+        {
+            combined.func = TempSensorCombi::CombineFunc::AVG;
+            combined.update(0);
+            CHECK(combined.valid() == true);
+            CHECK(combined.value() == temp_t(29)); // (2 * 20 + 22 + 23 + 60) / 5
+        }
+
+        THEN("The median is returned when MEDIAN is selected")
+        {
+            combined.func = TempSensorCombi::CombineFunc::MEDIAN;
+            combined.update(0);
+            CHECK(combined.value() == temp_t(22));
+
+            mock5->connected(false);
+            combined.update(0);
+            CHECK(combined.value() == temp_t(21.5));
+        }
+
+        AND_WHEN("Outlier rejection is enabled, values too far from the median are ignored")
+        {
+            combined.outlierThreshold = temp_t(5);
+
+            combined.func = TempSensorCombi::CombineFunc::AVG;
+            combined.update(0);
+            CHECK(combined.value() == temp_t(21.25)); // (2 * 20 + 22 + 23) / 4
+
+            combined.func = TempSensorCombi::CombineFunc::MAX;
+            combined.update(0);
+            CHECK(combined.value() == temp_t(23));
+        }
+
+        THEN("The time since each input last had a valid value is tracked")
+        {
+            combined.update(1000);
+            mock2->connected(false);
+            combined.update(2000);
+            combined.update(3500);
+            CHECK(combined.inputs[0].stale == 0);
+            CHECK(combined.inputs[1].stale == 2500);
+
+            mock2->connected(true);
+            combined.update(4500);
+            CHECK(combined.inputs[1].stale == 0);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2020 BrewPi B.V.
+ *
+ * This file is part of the BrewBlox Control Library.
+ *
+ * BrewPi is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * BrewPi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with BrewPi.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+
+#include "../inc/TriggeredInterval.h"
+
+SCENARIO("TriggeredInterval test")
+{
+    TriggeredInterval<500, 1500> trig;
+    bool doUpdate = false;
+
+    WHEN("It is not triggered, it updates at the maximum interval")
+    {
+        int numUpdates = 0;
+        for (ticks_millis_t now = 0; now < 15000; now += 10) {
+            doUpdate = false;
+            trig.update(now, doUpdate);
+            if (doUpdate) {
+                numUpdates++;
+            }
+        }
+        CHECK(numUpdates == 10);
+    }
+
+    WHEN("It is triggered, it updates directly")
+    {
+        CHECK(trig.update(0, doUpdate) == 1500);
+        CHECK(doUpdate);
+
+        doUpdate = false;
+        trig.trigger();
+        CHECK(trig.update(700, doUpdate) == 2200);
+        CHECK(doUpdate);
+        CHECK(trig.elapsed() == 700);
+
+        AND_WHEN("It is triggered again within the minimum interval, the update is postponed")
+        {
+            doUpdate = false;
+            trig.trigger();
+            CHECK(trig.update(800, doUpdate) == 1200);
+            CHECK(!doUpdate);
+
+            CHECK(trig.update(1200, doUpdate) == 2700);
+            CHECK(doUpdate);
+            CHECK(trig.elapsed() == 500);
+        }
+    }
+
+    WHEN("It is triggered every second, it updates every second")
+    {
+        int numUpdates = 0;
+        for (ticks_millis_t now = 0; now < 100000; now += 10) {
+            if (now % 1000 == 0) {
+                trig.trigger();
+            }
+            doUpdate = false;
+            trig.update(now, doUpdate);
+            if (doUpdate) {
+                numUpdates++;
+                CHECK(now % 1000 == 0);
+            }
+        }
+        CHECK(numUpdates == 100);
+    }
+}